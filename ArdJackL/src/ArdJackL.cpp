@@ -0,0 +1,478 @@
+/*
+	ArdJackL.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+// ArdJackL.cpp
+
+#include "pch.h"
+#include "stdafx.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "Beacon.h"
+#include "BeaconManager.h"
+#include "Bridge.h"
+#include "BridgeManager.h"
+#include "CmdInterpreter.h"
+#include "CommandSet.h"
+#include "ConnectionManager.h"
+#include "DataLogger.h"
+#include "DataLoggerManager.h"
+#include "DateTime.h"
+#include "DeviceManager.h"
+#include "Displayer.h"
+#include "LinuxDevice.h"
+#include "Route.h"
+#include "Log.h"
+#include "PersistentFileManager.h"
+#include "PollProfiler.h"
+#include "UdpConnection.h"
+#include "Utils.h"
+
+
+// The host runs a single-threaded event loop.
+//
+// ArdJackW polls everything from two 20 ms timer-queue callbacks, so a request arriving on 'udp0' waits for
+// the next Connection poll, then for the next Device buffer check, then for the next output buffer check.
+// Here, each Connection's input handle (e.g. the UDP listener socket) is registered with epoll, and input is
+// dispatched through the command, device and output buffers as soon as it arrives.
+// A 'timerfd' still drives the periodic work (Device scanning, Beacons, DataLoggers, etc.) every 20 ms.
+//
+// Run with '-poll' to disable the input handles, i.e. the ArdJackW behaviour (for comparison).
+// Any other arguments are queued as commands at startup.
+
+#define ARDJACK_LINUX_MAX_EVENTS 16
+#define ARDJACK_LINUX_TICK_MS 20
+
+// 'epoll_event.data.u64' values other than Connection slots.
+const static uint64_t ARDJACK_LINUX_EVENT_STDIN = 1000;
+const static uint64_t ARDJACK_LINUX_EVENT_TIMER = 1001;
+
+
+struct InputHandleInfo
+{
+	Connection* Conn = NULL;
+	int Handle = -1;
+};
+
+
+// Forward declarations.
+bool CheckBuffers();
+void OnInput(int slot);
+void OnSignal(int sig);
+void OnStdin();
+void OnTimer();
+void ShowPrompt();
+void SyncInputHandles();
+
+int _epoll = -1;
+uint32_t _inputGeneration = 0;									// 'ConnectionMgr->Generation' when '_inputHandles' was synced
+int _inputHandleCount = 0;										// used slots in '_inputHandles'
+InputHandleInfo _inputHandles[ARDJACK_MAX_OBJECTS];
+int _inputTimer = -1;											// 'PollProfiler' timer index for input events
+int _pollTimer = -1;											// 'PollProfiler' timer index for 'OnTimer'
+char _stdinLine[122];
+int _stdinLength = 0;
+bool _stdinOpen = true;
+int _timer = -1;
+bool _useInputHandles = true;
+
+
+
+int main(int argc, char* argv[])
+{
+	Globals::InitialisedStatic = true;
+	Globals::Init();
+
+	Log::LogInfo("ArdJackL (ArdJack, Linux)");
+
+#ifdef ARDJACK_NETWORK_AVAILABLE
+	Utils::InitializeWinsock();
+#endif
+
+	Utils::GetComputerInfo(Globals::HostName, Globals::IpAddress);
+
+	if (Globals::ComputerName[0] == NULL)
+		strcpy(Globals::ComputerName, Globals::HostName);
+
+	Displayer::DisplayMemory();
+
+	// Create the predefined objects.
+
+	// Create the Linux Device 'host'.
+	Globals::AddObject(ARDJACK_OBJECT_TYPE_DEVICE, ARDJACK_DEVICE_SUBTYPE_LINUX, "host");
+
+#ifdef ARDJACK_NETWORK_AVAILABLE
+	// Create the UDP Connection 'udp0', listening on all interfaces.
+	Connection* udp0 = (Connection*)Globals::AddObject(ARDJACK_OBJECT_TYPE_CONNECTION, ARDJACK_CONNECTION_SUBTYPE_UDP, "udp0");
+
+	if (NULL != udp0)
+		udp0->Config->SetFromString("InIP", "0.0.0.0");
+#endif
+
+#ifdef ARDJACK_INCLUDE_PERSISTENCE
+	// Load the configuration file (if any).
+	Globals::PersistentFileMgr->Scan(Globals::AppDocsFolder);
+	Globals::LoadIniFile("configuration");
+#endif
+
+	Displayer::DisplayMemory();
+
+#ifdef ARDJACK_INCLUDE_PERSISTENCE
+	// Read the startup file (if any).
+	Globals::ReadExecuteStartupFile();
+#endif
+
+	// Command line arguments.
+	for (int i = 1; i < argc; i++)
+	{
+		if (Utils::StringEquals(argv[i], "-poll", true))
+			_useInputHandles = false;
+		else
+			Globals::QueueCommand(argv[i]);
+	}
+
+	// Setup the event loop.
+	_epoll = epoll_create1(EPOLL_CLOEXEC);
+	_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if ((_epoll < 0) || (_timer < 0))
+	{
+		Log::LogErrorF(PRM("Failed to create the event loop, ERROR CODE: %d"), errno);
+		return 1;
+	}
+
+	struct itimerspec period;
+	period.it_interval.tv_sec = 0;
+	period.it_interval.tv_nsec = ARDJACK_LINUX_TICK_MS * 1000000L;
+	period.it_value = period.it_interval;
+	timerfd_settime(_timer, 0, &period, NULL);
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	_inputTimer = PollProfiler::AddTimer("input", 0);
+	_pollTimer = PollProfiler::AddTimer("tick", ARDJACK_LINUX_TICK_MS);
+#endif
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = ARDJACK_LINUX_EVENT_TIMER;
+	epoll_ctl(_epoll, EPOLL_CTL_ADD, _timer, &ev);
+
+	ev.data.u64 = ARDJACK_LINUX_EVENT_STDIN;
+	if (epoll_ctl(_epoll, EPOLL_CTL_ADD, STDIN_FILENO, &ev) != 0)
+		_stdinOpen = false;
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = OnSignal;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	if (!_useInputHandles)
+		Log::LogInfo(PRM("Input handles disabled - polling every "), Utils::Int2String(ARDJACK_LINUX_TICK_MS), " ms");
+
+	printf("\nREADY\n\n");
+	ShowPrompt();
+
+	struct epoll_event events[ARDJACK_LINUX_MAX_EVENTS];
+
+	while (!Globals::UserExit)
+	{
+		SyncInputHandles();
+
+		int count = epoll_wait(_epoll, events, ARDJACK_LINUX_MAX_EVENTS, -1);
+
+		for (int i = 0; i < count; i++)
+		{
+			uint64_t id = events[i].data.u64;
+
+			if (id == ARDJACK_LINUX_EVENT_TIMER)
+				OnTimer();
+			else if (id == ARDJACK_LINUX_EVENT_STDIN)
+				OnStdin();
+			else
+				OnInput((int)id);
+		}
+	}
+
+	close(_timer);
+	close(_epoll);
+
+	return 0;
+}
+
+
+bool CheckBuffers()
+{
+	// Drain the work queued by input: commands, Device requests and (then) their responses.
+	try
+	{
+		Globals::CheckCommandBuffer();
+		Globals::CheckDeviceBuffer();
+
+		if (NULL != Globals::ConnectionMgr)
+			Globals::ConnectionMgr->CheckOutputBuffer();
+	}
+	catch (...)
+	{
+		Log::LogException(PRM("CheckBuffers"));
+		return false;
+	}
+
+	return true;
+}
+
+
+void OnInput(int slot)
+{
+	// Input is waiting on the Connection in '_inputHandles[slot]'.
+	if ((slot < 0) || (slot >= ARDJACK_MAX_OBJECTS))
+		return;
+
+	Connection* conn = _inputHandles[slot].Conn;
+
+	// The Connection may have been deleted or deactivated by an earlier event - if so, wait for the resync
+	// (the handle stays readable).
+	if ((NULL == conn) || (Globals::ConnectionMgr->Generation != _inputGeneration) || !conn->Active())
+		return;
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	// Input handled here counts as a poll of the Connection (it isn't polled by the ConnectionManager).
+	unsigned long startUs = Utils::NowUs();
+#endif
+
+	try
+	{
+		conn->PollInputs(ARDJACK_MAX_UDP_RX_BATCH);
+	}
+	catch (...)
+	{
+		Log::LogException(PRM("OnInput"));
+	}
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	PollProfiler::Record(&conn->PollProfile, startUs);
+#endif
+
+	CheckBuffers();
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	PollProfiler::TimerTicked(_inputTimer, startUs);
+#endif
+}
+
+
+void OnSignal(int sig)
+{
+	Globals::UserExit = true;
+}
+
+
+void OnStdin()
+{
+	char buffer[122];
+
+	int count = read(STDIN_FILENO, buffer, sizeof(buffer));
+
+	if (count <= 0)
+	{
+		// End of input (e.g. stdin is '/dev/null') - carry on without the keyboard.
+		epoll_ctl(_epoll, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+		_stdinOpen = false;
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		char c = buffer[i];
+
+		if ((c != '\n') && (_stdinLength < (int)sizeof(_stdinLine) - 1))
+		{
+			_stdinLine[_stdinLength++] = c;
+			continue;
+		}
+
+		if (c != '\n')
+			continue;
+
+		_stdinLine[_stdinLength] = NULL;
+		_stdinLength = 0;
+		Utils::Trim(_stdinLine);
+
+		if (strlen(_stdinLine) > 0)
+		{
+			// Execute this command.
+			Globals::QueueCommand(_stdinLine);
+			CheckBuffers();
+		}
+
+		ShowPrompt();
+	}
+}
+
+
+void OnTimer()
+{
+	uint64_t expirations;
+
+	if (read(_timer, &expirations, sizeof(expirations)) != sizeof(expirations))
+		return;
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	// More than one expiration means that ticks were missed while the loop was busy.
+	if (expirations > 1)
+		PollProfiler::TimerSkipped(_pollTimer, (long)(expirations - 1));
+
+	unsigned long startUs = Utils::NowUs();
+#endif
+
+	try
+	{
+		if (NULL != Globals::ConnectionMgr)
+			Globals::ConnectionMgr->Poll();
+
+		if (NULL != Globals::DeviceMgr)
+			Globals::DeviceMgr->Poll();
+
+#ifdef ARDJACK_INCLUDE_BEACONS
+		if (NULL != Globals::BeaconMgr)
+			Globals::BeaconMgr->Poll();
+#endif
+
+#ifdef ARDJACK_INCLUDE_DATALOGGERS
+		if (NULL != Globals::DataLoggerMgr)
+			Globals::DataLoggerMgr->Poll();
+#endif
+
+		Globals::CheckCommandBuffer();
+		Globals::CheckDeviceBuffer();
+
+		Log::Poll();
+	}
+	catch (...)
+	{
+		Log::LogException(PRM("OnTimer"));
+	}
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	PollProfiler::TimerTicked(_pollTimer, startUs);
+#endif
+}
+
+
+void ShowPrompt()
+{
+	if (!_stdinOpen || !isatty(STDIN_FILENO))
+		return;
+
+	// Display a command prompt.
+	char temp[20];
+	Utils::GetTimeString(temp);
+	strcat(temp, " > ");
+
+	printf("%s", temp);
+	fflush(stdout);
+}
+
+
+void SyncInputHandles()
+{
+	// Make the epoll set match the input handles of the active Connections.
+	// Only needed when a Connection has been added, removed, activated or deactivated since the last sync.
+	if (!_useInputHandles || (Globals::ConnectionMgr->Generation == _inputGeneration))
+		return;
+
+	_inputGeneration = Globals::ConnectionMgr->Generation;
+
+	Register* reg = Globals::ObjectRegister;
+	int count = 0;
+
+	// Remove changed handles first, as a closed handle's number may have been reused by another Connection.
+	for (int i = 0; (i < reg->ObjectCount) && (count < ARDJACK_MAX_OBJECTS); i++)
+	{
+		IoTObject* obj = reg->Objects[i];
+
+		if (obj->Type != ARDJACK_OBJECT_TYPE_CONNECTION)
+			continue;
+
+		Connection* conn = (Connection*)obj;
+		InputHandleInfo* info = &_inputHandles[count++];
+		int handle = conn->Active() ? conn->InputHandle() : -1;
+
+		if ((info->Conn == conn) && (info->Handle == handle))
+			continue;
+
+		if (info->Handle >= 0)
+			epoll_ctl(_epoll, EPOLL_CTL_DEL, info->Handle, NULL);
+
+		info->Conn = NULL;
+		info->Handle = -1;
+	}
+
+	for (int slot = count; slot < _inputHandleCount; slot++)
+	{
+		InputHandleInfo* info = &_inputHandles[slot];
+
+		if (info->Handle >= 0)
+			epoll_ctl(_epoll, EPOLL_CTL_DEL, info->Handle, NULL);
+
+		info->Conn = NULL;
+		info->Handle = -1;
+	}
+
+	_inputHandleCount = count;
+	count = 0;
+
+	// Then add the new ones.
+	for (int i = 0; (i < reg->ObjectCount) && (count < ARDJACK_MAX_OBJECTS); i++)
+	{
+		IoTObject* obj = reg->Objects[i];
+
+		if (obj->Type != ARDJACK_OBJECT_TYPE_CONNECTION)
+			continue;
+
+		Connection* conn = (Connection*)obj;
+		int slot = count++;
+		InputHandleInfo* info = &_inputHandles[slot];
+
+		if (info->Conn == conn)
+			continue;
+
+		info->Conn = conn;
+		int handle = conn->Active() ? conn->InputHandle() : -1;
+
+		if (handle >= 0)
+		{
+			struct epoll_event ev;
+			ev.events = EPOLLIN;
+			ev.data.u64 = (uint64_t)slot;
+
+			if (epoll_ctl(_epoll, EPOLL_CTL_ADD, handle, &ev) == 0)
+				info->Handle = handle;
+		}
+	}
+}
@@ -0,0 +1,148 @@
+/*
+	LinuxClock.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#include "pch.h"
+
+
+// Linux only.
+
+#ifdef ARDJACK_LINUX
+
+#include <time.h>
+
+#include "DateTime.h"
+#include "IoTClock.h"
+#include "LinuxClock.h"
+#include "Log.h"
+#include "Utils.h"
+
+
+
+LinuxClock::LinuxClock() : IoTClock()
+{
+}
+
+
+LinuxClock::~LinuxClock()
+{
+}
+
+
+bool LinuxClock::Now(DateTime* dt)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	struct tm tmNow;
+	localtime_r(&ts.tv_sec, &tmNow);
+
+	dt->Day = (uint8_t)tmNow.tm_mday;
+	dt->Month = (uint8_t)(tmNow.tm_mon + 1);
+	dt->Year = (uint16_t)(tmNow.tm_year + 1900);
+	dt->Hours = (uint8_t)tmNow.tm_hour;
+	dt->Minutes = (uint8_t)tmNow.tm_min;
+	dt->Seconds = (uint8_t)tmNow.tm_sec;
+	dt->Milliseconds = (uint16_t)(ts.tv_nsec / 1000000L);
+
+	return true;
+}
+
+
+long LinuxClock::NowMs()
+{
+	// Milliseconds since the Unix epoch, as for 'WinClock'.
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return (long)ts.tv_sec * 1000L + (long)(ts.tv_nsec / 1000000L);
+}
+
+
+unsigned long LinuxClock::NowUs()
+{
+	// Microseconds for measuring intervals, unaffected by changes to the date and time.
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long)ts.tv_sec * 1000000UL + (unsigned long)(ts.tv_nsec / 1000L);
+}
+
+
+bool LinuxClock::NowUtc(DateTime* dt)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	struct tm tmNow;
+	gmtime_r(&ts.tv_sec, &tmNow);
+
+	dt->Day = (uint8_t)tmNow.tm_mday;
+	dt->Month = (uint8_t)(tmNow.tm_mon + 1);
+	dt->Year = (uint16_t)(tmNow.tm_year + 1900);
+	dt->Hours = (uint8_t)tmNow.tm_hour;
+	dt->Minutes = (uint8_t)tmNow.tm_min;
+	dt->Seconds = (uint8_t)tmNow.tm_sec;
+	dt->Milliseconds = (uint16_t)(ts.tv_nsec / 1000000L);
+
+	return true;
+}
+
+
+bool LinuxClock::SetDate(int day, int Month, int year, bool utc)
+{
+	// Ignored for now.
+	return true;
+}
+
+
+bool LinuxClock::SetDateTime(DateTime* dt, bool utc)
+{
+	// Ignored for now.
+	return true;
+}
+
+
+bool LinuxClock::SetTime(int hours, int minutes, int seconds, bool utc)
+{
+	// Ignored for now.
+	return true;
+}
+
+
+bool LinuxClock::Start(int day, int month, int year, int hours, int minutes, int seconds, bool utc)
+{
+	Log::LogInfo("LinuxClock started");
+
+	return true;
+}
+
+
+bool LinuxClock::Stop()
+{
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+	LinuxDevice.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#include "pch.h"
+
+// Linux only.
+
+#ifdef ARDJACK_LINUX
+
+#include "stdafx.h"
+
+#include "DeviceCodec1.h"
+#include "Dynamic.h"
+#include "LinuxDevice.h"
+#include "Log.h"
+#include "Part.h"
+#include "Utils.h"
+
+
+
+LinuxDevice::LinuxDevice(const char* name)
+	: Device(name)
+{
+	strcpy(DeviceClass, "Linux");
+
+	CreateDefaultInventory();
+}
+
+
+LinuxDevice::~LinuxDevice()
+{
+}
+
+
+bool LinuxDevice::CreateDefaultInventory()
+{
+	// Add Parts.
+	AddParts("ai", 4, ARDJACK_PART_TYPE_ANALOG_INPUT, 0, 0, 0);
+	AddParts("di", 4, ARDJACK_PART_TYPE_DIGITAL_INPUT, 0, 0, 0);
+	AddParts("do", 4, ARDJACK_PART_TYPE_DIGITAL_OUTPUT, 0, 0, 0);
+
+	for (int i = 0; i < PartCount; i++)
+	{
+		Part* part = Parts[i];
+
+		if (part->IsDigital())
+			part->Value.SetBool(false);
+		else
+			part->Value.SetInt(0);
+	}
+
+	return true;
+}
+
+
+bool LinuxDevice::Open()
+{
+	Log::LogInfo(PRM("Opening Device '"), Name, "'");
+
+	if (!Device::Open())
+		return false;
+
+	return true;
+}
+
+
+bool LinuxDevice::Read(Part* part, Dynamic* value)
+{
+	return value->Copy(&part->Value);
+}
+
+
+bool LinuxDevice::Write(Part* part, Dynamic* value)
+{
+	return part->Value.Copy(value);
+}
+
+#endif
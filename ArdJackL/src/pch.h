@@ -0,0 +1,90 @@
+/*
+	pch.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#pragma once
+
+
+// Add headers here that you want to pre-compile.
+
+#include "ArrayHelpers.h"
+#include "Beacon.h"
+#include "BeaconManager.h"
+#include "Bridge.h"
+#include "BridgeManager.h"
+#include "CmdInterpreter.h"
+#include "CommandSet.h"
+#include "ConfigProp.h"
+#include "Configuration.h"
+#include "Connection.h"
+#include "ConnectionManager.h"
+#include "DataLogger.h"
+#include "DataLoggerManager.h"
+#include "DateTime.h"
+#include "Device.h"
+#include "DeviceCodec1.h"
+#include "DeviceManager.h"
+#include "Dictionary.h"
+#include "Displayer.h"
+#include "Dynamic.h"
+#include "Enumeration.h"
+#include "FieldReplacer.h"
+#include "FifoBuffer.h"
+#include "Filter.h"
+#include "FilterManager.h"
+#include "Globals.h"
+#include "HttpConnection.h"
+#include "IniFiler.h"
+#include "Int8List.h"
+#include "IoTClock.h"
+#include "IoTManager.h"
+#include "IoTMessage.h"
+#include "IoTObject.h"
+#include "LinuxClock.h"
+#include "LinuxDevice.h"
+#include "Log.h"
+#include "LogConnection.h"
+#include "MessageFilter.h"
+#include "MessageFilterItem.h"
+#include "NetworkInterface.h"
+#include "NetworkManager.h"
+#include "Part.h"
+#include "PartManager.h"
+#include "PersistentFile.h"
+#include "PersistentFileManager.h"
+#include "Register.h"
+#include "Route.h"
+#include "SerialConnection.h"
+#include "Shield.h"
+#include "ShieldManager.h"
+#include "StringList.h"
+#include "Table.h"
+#include "TcpConnection.h"
+#include "Tests.h"
+#include "ThinkerShield.h"
+#include "UdpConnection.h"
+#include "UrlEncoder.h"
+#include "UserPart.h"
+#include "Utils.h"
+
@@ -0,0 +1,739 @@
+/*
+	BenchCore.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+// BenchCore.cpp
+//
+// Benchmarks the core string and message primitives, reporting ns/op and heap allocations/op for each case.
+// Allocations are counted by wrapping 'malloc', 'calloc' and 'realloc' (see the '--wrap' link options in the
+// Makefile) and by replacing the global 'operator new'.
+//
+// '-json' writes the results as JSON lines, e.g.
+//		{"name":"stringlist.add","ns_per_op":21.4,"allocs_per_op":0.000,"iterations":8388608}
+// and '-baseline' compares them with an earlier such file, exiting with status 1 if any case is more than
+// 'tolerance' percent slower, or allocates more.
+//
+// Usage:
+//		BenchCore [-filter text] [-ms target] [-json file] [-baseline file] [-tolerance percent]
+
+#include "pch.h"
+
+#include <new>
+#include <time.h>
+
+#include "Device.h"
+#include "DeviceCodec1.h"
+#include "Dictionary.h"
+#include "Dynamic.h"
+#include "FieldReplacer.h"
+#include "Filter.h"
+#include "Globals.h"
+#include "IoTMessage.h"
+#include "LinuxClock.h"
+#include "MessagePathTable.h"
+#include "StringList.h"
+#include "UdpConnection.h"
+#include "Utils.h"
+
+#define BENCH_MAX_BASELINE 64
+#define BENCH_MAX_NAME_LENGTH 40
+#define BENCH_REPEATS 3
+
+
+struct BenchCase
+{
+	const char* Name;
+	void (*Run)(long iterations);
+};
+
+struct BenchResult
+{
+	double AllocsPerOp = 0.0;
+	long Iterations = 0;
+	char Name[BENCH_MAX_NAME_LENGTH] = "";
+	double NsPerOp = 0.0;
+};
+
+
+// Heap allocations so far.
+static volatile long _Allocs = 0;
+
+// Keeps the compiler from discarding the work being measured.
+static volatile size_t _Sink = 0;
+
+
+extern "C"
+{
+	void* __real_calloc(size_t count, size_t size);
+	void* __real_malloc(size_t size);
+	void* __real_realloc(void* block, size_t size);
+
+	void* __wrap_calloc(size_t count, size_t size)
+	{
+		_Allocs++;
+		return __real_calloc(count, size);
+	}
+
+	void* __wrap_malloc(size_t size)
+	{
+		_Allocs++;
+		return __real_malloc(size);
+	}
+
+	void* __wrap_realloc(void* block, size_t size)
+	{
+		_Allocs++;
+		return __real_realloc(block, size);
+	}
+}
+
+
+void* operator new(size_t size)
+{
+	_Allocs++;
+	void* result = __real_malloc((size > 0) ? size : 1);
+
+	if (NULL == result)
+		throw std::bad_alloc();
+
+	return result;
+}
+
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+
+void operator delete[](void* block) noexcept
+{
+	free(block);
+}
+
+
+void operator delete(void* block, size_t size) noexcept
+{
+	free(block);
+}
+
+
+void operator delete[](void* block, size_t size) noexcept
+{
+	free(block);
+}
+
+
+static double NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+
+// The cases.
+
+static const char* _Format1Line = "[type=request from=\\\\pc1\\rem0 to=\\\\host_A\\host return=\\\\pc1\\rem1] ?ai0 ai1 di0";
+static CmdInterpreter* _Interpreter = NULL;
+static UdpConnection* _Udp = NULL;
+
+
+static CmdInterpreter* GetInterpreter()
+{
+	if (NULL == _Interpreter)
+	{
+		strcpy(Globals::CommandSeparator, ";");
+		strcpy(Globals::CommentPrefix, "#");
+		strcpy(Globals::OneCommandPrefix, "|");
+
+		_Interpreter = new CmdInterpreter();
+		_Interpreter->AddCommandSet(new CommandSet());
+		_Interpreter->AddMacro("m1", "set verbosity 0");
+		_Interpreter->AddMacro("m2", "set verbosity 0; set verbosity 0; set verbosity 0; set verbosity 0");
+	}
+
+	return _Interpreter;
+}
+
+
+static UdpConnection* GetUdp()
+{
+	if (NULL == _Udp)
+	{
+		_Udp = new UdpConnection("udp9");
+		_Udp->AddConfig();
+	}
+
+	return _Udp;
+}
+
+
+static void AcknowledgePaths(MessagePathTable* paths, MessagePathTable* peerPaths)
+{
+	// Send the paths to peer 1 in full, and have it (seeing us as peer 2) reply, acknowledging them.
+	IoTMessage msg;
+	IoTMessage reply;
+
+	IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "", &msg, "\\\\host_A\\host",
+		"\\\\pc1\\rem0", "\\\\host_A\\host", paths, 1);
+	reply.Decode(msg.WireText(), peerPaths, 2);
+	IoTMessage::CreateMessageToSend("request", ARDJACK_MESSAGE_FORMAT_2, "", &reply, "\\\\pc1\\rem0",
+		"\\\\host_A\\host", "", peerPaths, 2);
+	msg.Decode(reply.WireText(), paths, 1);
+}
+
+
+static void BenchCmdInterpreterCommand(long iterations)
+{
+	CmdInterpreter* interp = GetInterpreter();
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += interp->ExecuteCommand("set verbosity 0");
+}
+
+
+static void BenchCmdInterpreterMacro(long iterations)
+{
+	CmdInterpreter* interp = GetInterpreter();
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += interp->ExecuteCommand("m1");
+}
+
+
+static void BenchCmdInterpreterMacro4(long iterations)
+{
+	CmdInterpreter* interp = GetInterpreter();
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += interp->ExecuteCommand("m2");
+}
+
+
+static void BenchCodecDecodeBulk(long iterations)
+{
+	char aName[ARDJACK_MAX_NAME_LENGTH];
+	StringList values;
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += Globals::DeviceCodec->DecodeRequest("?ai0 ai1 ai2 di0 di1", aName, &values);
+}
+
+
+static void BenchCodecDecodeRead(long iterations)
+{
+	char aName[ARDJACK_MAX_NAME_LENGTH];
+	StringList values;
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += Globals::DeviceCodec->DecodeRequest("?ai0", aName, &values);
+}
+
+
+static void BenchCodecDecodeWrite(long iterations)
+{
+	char aName[ARDJACK_MAX_NAME_LENGTH];
+	StringList values;
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += Globals::DeviceCodec->DecodeRequest("write di0 1", aName, &values);
+}
+
+
+static void BenchCodecTokenizeWrite(long iterations)
+{
+	DeviceRequestTokens tokens;
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += Globals::DeviceCodec->Tokenize("write di0 1", &tokens);
+}
+
+
+static void BenchDeviceLookupOperation(long iterations)
+{
+	// 'write' came last in the old chain of comparisons.
+	for (long i = 0; i < iterations; i++)
+		_Sink += Device::LookupOperation("write");
+}
+
+
+static void BenchConfigGetHandle(long iterations)
+{
+	// 'OutPort' comes late in a UDP Connection's properties.
+	static ConfigHandle handle = { "OutPort" };
+	Configuration* config = GetUdp()->Config;
+	int value;
+
+	for (long i = 0; i < iterations; i++)
+	{
+		config->GetAsInteger(&handle, &value);
+		_Sink += value;
+	}
+}
+
+
+static void BenchConfigGetName(long iterations)
+{
+	Configuration* config = GetUdp()->Config;
+	int value;
+
+	for (long i = 0; i < iterations; i++)
+	{
+		config->GetAsInteger("OutPort", &value);
+		_Sink += value;
+	}
+}
+
+
+static void BenchDynamicDifferInt(long iterations)
+{
+	Dynamic value1;
+	Dynamic value2;
+	value1.SetInt(1023);
+	value2.SetInt(1022);
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += value1.ValuesDiffer(&value2);
+}
+
+
+static void BenchDynamicDifferString(long iterations)
+{
+	Dynamic value1;
+	Dynamic value2;
+	value1.SetString("Hello");
+	value2.SetString("hello");
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += value1.ValuesDiffer(&value2, true);
+}
+
+
+static void BenchFieldReplacer(long iterations)
+{
+	FieldReplacer replacer;
+	Dictionary args;
+	args.Add("animal1", "quick brown Fox");
+	args.Add("animal2", "lazy doG");
+
+	char output[102];
+
+	for (long i = 0; i < iterations; i++)
+	{
+		replacer.ReplaceFields("The [animal1] jumped over the [animal2], watched by [watcher].", &args,
+			&FieldReplacer_ReplaceField, output);
+		_Sink += output[4];
+	}
+}
+
+
+static void BenchFilterApplyConfig(long iterations)
+{
+	Filter filter("f9");
+	filter.AddConfig();
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += filter.ApplyConfig();
+}
+
+
+static void BenchMessageDecode0(long iterations)
+{
+	IoTMessage msg;
+
+	for (long i = 0; i < iterations; i++)
+	{
+		msg.Decode("$host: ?ai0");
+		_Sink += strlen(msg.Text());
+	}
+}
+
+
+static void BenchMessageDecode1(long iterations)
+{
+	IoTMessage msg;
+
+	for (long i = 0; i < iterations; i++)
+	{
+		msg.Decode(_Format1Line);
+		_Sink += strlen(msg.Text()) + strlen(msg.FromPath());
+	}
+}
+
+
+static void BenchMessageEncode1(long iterations)
+{
+	IoTMessage msg;
+
+	for (long i = 0; i < iterations; i++)
+	{
+		IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_1, "ai0 1023 di0 1", &msg, "\\\\host_A\\host",
+			"\\\\pc1\\rem0", "\\\\host_A\\host");
+		_Sink += strlen(msg.WireText());
+	}
+}
+
+
+static void BenchMessageEncode2(long iterations)
+{
+	// The peer has acknowledged the paths, so they're sent as IDs (and in full every ARDJACK_MESSAGE_PATH_REFRESH uses).
+	MessagePathTable paths;
+	MessagePathTable peerPaths;
+	IoTMessage msg;
+
+	AcknowledgePaths(&paths, &peerPaths);
+
+	for (long i = 0; i < iterations; i++)
+	{
+		IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "ai0 1023 di0 1", &msg, "\\\\host_A\\host",
+			"\\\\pc1\\rem0", "\\\\host_A\\host", &paths, 1);
+		_Sink += strlen(msg.WireText());
+	}
+}
+
+
+static void BenchStringListAdd(long iterations)
+{
+	// Add 16 items to a cleared list, over and over.
+	StringList list;
+
+	for (long i = 0; i < iterations; i++)
+	{
+		if ((i & 15) == 0)
+			list.Clear();
+
+		list.Add("Item text");
+	}
+
+	_Sink += list.Count;
+}
+
+
+static void BenchStringListGet(long iterations)
+{
+	StringList list;
+	char temp[20];
+
+	for (int i = 0; i < 100; i++)
+	{
+		sprintf(temp, "Item %d", i);
+		list.Add(temp);
+	}
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += (size_t)list.Get((int)(i % 100));
+}
+
+
+static void BenchStringListPut(long iterations)
+{
+	// Alternately grow and shrink the middle item of 100.
+	StringList list;
+	char temp[20];
+
+	for (int i = 0; i < 100; i++)
+	{
+		sprintf(temp, "Item %d", i);
+		list.Add(temp);
+	}
+
+	for (long i = 0; i < iterations; i++)
+		list.Put(50, (i & 1) ? "Short" : "A somewhat longer replacement item");
+
+	_Sink += list.Count;
+}
+
+
+static void BenchUdpAddConfig(long iterations)
+{
+	// Create a UDP Connection and its Configuration, as 'add connection udp ...' does.
+	for (long i = 0; i < iterations; i++)
+	{
+		UdpConnection* conn = new UdpConnection("udp9");
+		_Sink += conn->AddConfig();
+		delete conn;
+	}
+}
+
+
+static void BenchUtilsSplitText(long iterations)
+{
+	StringList fields;
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += Utils::SplitText("configure udp0 InPort=5101 OutIP=127.0.0.1 OutPort=5102", ' ', &fields, 10,
+			ARDJACK_MAX_VALUE_LENGTH);
+}
+
+
+static void BenchUtilsSplitText2Array(long iterations)
+{
+	char fields[10][ARDJACK_MAX_VALUE_LENGTH];
+
+	for (long i = 0; i < iterations; i++)
+		_Sink += Utils::SplitText2Array("configure udp0 InPort=5101 OutIP=127.0.0.1 OutPort=5102", ' ', fields, 10,
+			ARDJACK_MAX_VALUE_LENGTH);
+}
+
+
+static void BenchUtilsStringEquals(long iterations)
+{
+	for (long i = 0; i < iterations; i++)
+		_Sink += Utils::StringEquals("ConnectionManager", (i & 1) ? "connectionmanager" : "ConnectionMonitor");
+}
+
+
+static void BenchUtilsTrim(long iterations)
+{
+	char text[40];
+
+	for (long i = 0; i < iterations; i++)
+	{
+		strcpy(text, "   some text to trim   ");
+		_Sink += strlen(Utils::Trim(text));
+	}
+}
+
+
+static BenchCase _Cases[] =
+{
+	{ "cmdinterpreter.executecommand.command", BenchCmdInterpreterCommand },
+	{ "cmdinterpreter.executecommand.macro", BenchCmdInterpreterMacro },
+	{ "cmdinterpreter.executecommand.macro4", BenchCmdInterpreterMacro4 },
+	{ "configuration.getasinteger.handle", BenchConfigGetHandle },
+	{ "configuration.getasinteger.name", BenchConfigGetName },
+	{ "device.lookupoperation", BenchDeviceLookupOperation },
+	{ "devicecodec1.decoderequest.bulk", BenchCodecDecodeBulk },
+	{ "devicecodec1.decoderequest.read", BenchCodecDecodeRead },
+	{ "devicecodec1.decoderequest.write", BenchCodecDecodeWrite },
+	{ "devicecodec1.tokenize.write", BenchCodecTokenizeWrite },
+	{ "dynamic.valuesdiffer.int", BenchDynamicDifferInt },
+	{ "dynamic.valuesdiffer.string", BenchDynamicDifferString },
+	{ "fieldreplacer.replacefields", BenchFieldReplacer },
+	{ "filter.applyconfig", BenchFilterApplyConfig },
+	{ "iotmessage.decode.format0", BenchMessageDecode0 },
+	{ "iotmessage.decode.format1", BenchMessageDecode1 },
+	{ "iotmessage.encode.format1", BenchMessageEncode1 },
+	{ "iotmessage.encode.format2", BenchMessageEncode2 },
+	{ "stringlist.add", BenchStringListAdd },
+	{ "stringlist.get", BenchStringListGet },
+	{ "stringlist.put", BenchStringListPut },
+	{ "udpconnection.addconfig", BenchUdpAddConfig },
+	{ "utils.splittext", BenchUtilsSplitText },
+	{ "utils.splittext2array", BenchUtilsSplitText2Array },
+	{ "utils.stringequals", BenchUtilsStringEquals },
+	{ "utils.trim", BenchUtilsTrim },
+};
+
+
+
+// The runner.
+
+static int LoadBaseline(const char* filename, BenchResult* results)
+{
+	// Read the results in a '-json' file.
+	FILE* file = fopen(filename, "r");
+
+	if (NULL == file)
+	{
+		fprintf(stderr, "Can't open baseline file '%s'\n", filename);
+		return -1;
+	}
+
+	char line[200];
+	int count = 0;
+
+	while ((count < BENCH_MAX_BASELINE) && (NULL != fgets(line, sizeof(line), file)))
+	{
+		BenchResult* result = &results[count];
+
+		if (sscanf(line, "{\"name\":\"%39[^\"]\",\"ns_per_op\":%lf,\"allocs_per_op\":%lf,\"iterations\":%ld",
+			result->Name, &result->NsPerOp, &result->AllocsPerOp, &result->Iterations) == 4)
+		{
+			count++;
+		}
+	}
+
+	fclose(file);
+
+	return count;
+}
+
+
+static void Measure(BenchCase* item, double targetMs, BenchResult* result)
+{
+	// Find an iteration count which takes about 'targetMs', then keep the best of several runs.
+	long iterations = 1;
+
+	while (true)
+	{
+		double start = NowNs();
+		item->Run(iterations);
+		double elapsedMs = (NowNs() - start) / 1e6;
+
+		if ((elapsedMs >= targetMs / 10) || (iterations >= (1L << 30)))
+		{
+			if (elapsedMs > 0.0)
+				iterations = (long)(iterations * targetMs / elapsedMs) + 1;
+			break;
+		}
+
+		iterations *= 2;
+	}
+
+	strcpy(result->Name, item->Name);
+	result->Iterations = iterations;
+	result->NsPerOp = 0.0;
+
+	for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+	{
+		long allocs = _Allocs;
+		double start = NowNs();
+
+		item->Run(iterations);
+
+		double ns = (NowNs() - start) / iterations;
+
+		if ((repeat == 0) || (ns < result->NsPerOp))
+			result->NsPerOp = ns;
+
+		result->AllocsPerOp = (double)(_Allocs - allocs) / iterations;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* baselineName = NULL;
+	const char* filter = NULL;
+	const char* jsonName = NULL;
+	double targetMs = 100.0;
+	double tolerance = 10.0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = (i + 1 < argc);
+
+		if ((strcmp(argv[i], "-baseline") == 0) && hasValue)
+			baselineName = argv[++i];
+		else if ((strcmp(argv[i], "-filter") == 0) && hasValue)
+			filter = argv[++i];
+		else if ((strcmp(argv[i], "-json") == 0) && hasValue)
+			jsonName = argv[++i];
+		else if ((strcmp(argv[i], "-ms") == 0) && hasValue)
+			targetMs = atof(argv[++i]);
+		else if ((strcmp(argv[i], "-tolerance") == 0) && hasValue)
+			tolerance = atof(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: BenchCore [-filter text] [-ms target] [-json file] [-baseline file] [-tolerance percent]\n");
+			return 2;
+		}
+	}
+
+	Globals::Verbosity = 0;
+	Globals::Clock = new LinuxClock();
+	Globals::DeviceCodec = new DeviceCodec1();
+
+	BenchResult baseline[BENCH_MAX_BASELINE];
+	int baselineCount = 0;
+
+	if (NULL != baselineName)
+	{
+		baselineCount = LoadBaseline(baselineName, baseline);
+		if (baselineCount < 0) return 2;
+	}
+
+	FILE* json = NULL;
+
+	if (NULL != jsonName)
+	{
+		json = fopen(jsonName, "w");
+
+		if (NULL == json)
+		{
+			fprintf(stderr, "Can't create '%s'\n", jsonName);
+			return 2;
+		}
+	}
+
+	int regressions = 0;
+
+	for (size_t i = 0; i < sizeof(_Cases) / sizeof(_Cases[0]); i++)
+	{
+		BenchCase* item = &_Cases[i];
+
+		if ((NULL != filter) && (NULL == strstr(item->Name, filter)))
+			continue;
+
+		BenchResult result;
+		Measure(item, targetMs, &result);
+
+		printf("%-34s %10.1f ns/op %8.3f allocs/op", result.Name, result.NsPerOp, result.AllocsPerOp);
+
+		if (NULL != json)
+		{
+			fprintf(json, "{\"name\":\"%s\",\"ns_per_op\":%.1f,\"allocs_per_op\":%.3f,\"iterations\":%ld}\n",
+				result.Name, result.NsPerOp, result.AllocsPerOp, result.Iterations);
+		}
+
+		// Compare with the baseline.
+		for (int j = 0; j < baselineCount; j++)
+		{
+			BenchResult* base = &baseline[j];
+			if (strcmp(base->Name, result.Name) != 0) continue;
+
+			double change = (base->NsPerOp > 0.0) ? 100.0 * (result.NsPerOp - base->NsPerOp) / base->NsPerOp : 0.0;
+			printf("   %+6.1f%%", change);
+
+			if ((change > tolerance) || (result.AllocsPerOp > base->AllocsPerOp + 0.0005))
+			{
+				printf("  REGRESSION (was %.1f ns/op, %.3f allocs/op)", base->NsPerOp, base->AllocsPerOp);
+				regressions++;
+			}
+
+			break;
+		}
+
+		printf("\n");
+	}
+
+	if (NULL != json)
+		fclose(json);
+
+	if (NULL != baselineName)
+		printf("\n%d regression(s) against '%s' (tolerance %.0f%%)\n", regressions, baselineName, tolerance);
+
+	return (regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/*
+	BenchMessage.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+// BenchMessage.cpp
+//
+// Measures IoTMessage encoding and decoding throughput, and the size of each format on the wire.
+// Each decoded message has its fields read, as routing does.
+//
+// Usage:
+//		BenchMessage [count]
+
+#include "pch.h"
+
+#include <time.h>
+
+#include "Globals.h"
+#include "IoTMessage.h"
+#include "MessagePathTable.h"
+
+
+
+static MessagePathTable _Paths;
+static MessagePathTable _PeerPaths;
+
+
+
+static void AcknowledgePaths(MessagePathTable* paths, MessagePathTable* peerPaths)
+{
+	// Send the paths to peer 1 in full, and have it (seeing us as peer 2) reply, acknowledging them.
+	IoTMessage msg;
+	IoTMessage reply;
+
+	IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "", &msg, "\\\\host_A\\host",
+		"\\\\pc1\\rem0", "\\\\host_A\\host", paths, 1);
+	reply.Decode(msg.WireText(), peerPaths, 2);
+	IoTMessage::CreateMessageToSend("request", ARDJACK_MESSAGE_FORMAT_2, "", &reply, "\\\\pc1\\rem0",
+		"\\\\host_A\\host", "", peerPaths, 2);
+	msg.Decode(reply.WireText(), paths, 1);
+}
+
+
+static double NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static void RunDecode(const char* caption, const char* line, int count, MessagePathTable* paths = NULL)
+{
+	IoTMessage msg;
+
+	// Keep the compiler from discarding the field reads.
+	volatile size_t sink = 0;
+
+	double start = NowNs();
+
+	for (int i = 0; i < count; i++)
+	{
+		msg.Decode(line, paths, 2);
+
+		sink += strlen(msg.Text());
+		sink += strlen(msg.FromPath());
+		sink += strlen(msg.ToPath());
+		sink += strlen(msg.ReturnPath());
+		sink += strlen(msg.Type());
+	}
+
+	double ns = (NowNs() - start) / count;
+
+	printf("decode %-10s %8.1f ns/message  %10.0f messages/s  %4d bytes\n", caption, ns, 1e9 / ns, (int)strlen(line));
+}
+
+
+static void RunEncode(const char* caption, int format, int count, char* wireText, MessagePathTable* paths = NULL)
+{
+	IoTMessage msg;
+	volatile size_t sink = 0;
+
+	double start = NowNs();
+
+	for (int i = 0; i < count; i++)
+	{
+		IoTMessage::CreateMessageToSend("response", format, "ai0 1023 di0 1", &msg, "\\\\host_A\\host",
+			"\\\\pc1\\rem0", "\\\\host_A\\host", paths, 1);
+		sink += strlen(msg.WireText());
+	}
+
+	double ns = (NowNs() - start) / count;
+
+	printf("encode %-10s %8.1f ns/message  %10.0f messages/s  %4d bytes\n", caption, ns, 1e9 / ns, (int)strlen(msg.WireText()));
+
+	strcpy(wireText, msg.WireText());
+}
+
+
+int main(int argc, char* argv[])
+{
+	int count = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+	Globals::Verbosity = 0;
+
+	char wire1[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+	char wire2[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+
+	RunDecode("format 0", "$host: ?ai0", count);
+	RunDecode("format 1", "[type=request from=\\\\pc1\\rem0 to=\\\\host_A\\host return=\\\\pc1\\rem1] ?ai0 ai1 di0", count);
+
+	// Format 2 sends its paths as IDs once the peer has acknowledged them.
+	AcknowledgePaths(&_Paths, &_PeerPaths);
+
+	RunEncode("format 1", ARDJACK_MESSAGE_FORMAT_1, count, wire1);
+	RunEncode("format 2", ARDJACK_MESSAGE_FORMAT_2, count, wire2, &_Paths);
+
+	RunDecode("format 1", wire1, count);
+	RunDecode("format 2", wire2, count, &_PeerPaths);
+
+	return 0;
+}
@@ -0,0 +1,283 @@
+/*
+	BenchQueue.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+// BenchQueue.cpp
+//
+// Multithreaded stress test and benchmark for the buffers' queues: several producer threads push numbered items
+// while one consumer thread pops them and checks that every item arrives once, in order per producer, intact.
+//
+// Queues:
+//	- RingBuf, as ArdJackW's FifoBuffer used it (no locking, so items get lost or corrupted);
+//	- RingBuf guarded by a mutex;
+//	- LockFreeQueue, as hosts' FifoBuffers use it.
+//
+// Usage:
+//		BenchQueue [items per producer] [producers]
+
+#include "pch.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <time.h>
+
+#include "Globals.h"
+#include "LockFreeQueue.h"
+#include "../../ArdJackW/src/RingBuf.h"
+
+#define BENCH_QUEUE_COUNT 64											// items held by each queue
+#define BENCH_TIMEOUT_MS 5000											// give up on a run (e.g. a corrupted RingBuf) after this
+
+
+
+struct BenchItem
+{
+	uint32_t Producer;
+	uint32_t Sequence;
+	char Text[56];														// filled with a pattern from 'Producer' and 'Sequence'
+};
+
+
+class BenchQueue
+{
+public:
+	virtual ~BenchQueue() {}
+
+	virtual bool Pop(BenchItem* item) = 0;
+	virtual bool Push(const BenchItem* item) = 0;
+};
+
+
+class LockFreeBenchQueue : public BenchQueue
+{
+protected:
+	LockFreeQueue _Queue;
+
+public:
+	LockFreeBenchQueue() : _Queue(sizeof(BenchItem), BENCH_QUEUE_COUNT) {}
+
+	virtual bool Pop(BenchItem* item) override { return _Queue.Pop(item); }
+	virtual bool Push(const BenchItem* item) override { return _Queue.Push(item); }
+};
+
+
+class RingBufBenchQueue : public BenchQueue
+{
+protected:
+	bool _Locked;
+	std::mutex _Mutex;
+	RingBuf* _RingBuf;
+
+public:
+	RingBufBenchQueue(bool locked)
+	{
+		_Locked = locked;
+		_RingBuf = RingBuf_new(sizeof(BenchItem), BENCH_QUEUE_COUNT);
+	}
+
+	~RingBufBenchQueue()
+	{
+		RingBuf_delete(_RingBuf);
+	}
+
+	virtual bool Pop(BenchItem* item) override
+	{
+		// As 'FifoBuffer::Pop': test, then pull.
+		if (_Locked)
+			_Mutex.lock();
+
+		bool result = !_RingBuf->isEmpty(_RingBuf);
+
+		if (result)
+			_RingBuf->pull(_RingBuf, item);
+
+		if (_Locked)
+			_Mutex.unlock();
+
+		return result;
+	}
+
+	virtual bool Push(const BenchItem* item) override
+	{
+		// As 'FifoBuffer::Push': test, then add.
+		if (_Locked)
+			_Mutex.lock();
+
+		bool result = !_RingBuf->isFull(_RingBuf);
+
+		if (result)
+			_RingBuf->add(_RingBuf, item);
+
+		if (_Locked)
+			_Mutex.unlock();
+
+		return result;
+	}
+};
+
+
+
+static std::atomic<bool> _Stop;
+
+
+
+static double NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static char Pattern(uint32_t producer, uint32_t sequence, int i)
+{
+	return (char)('a' + (producer * 7 + sequence + i) % 26);
+}
+
+
+static void Produce(BenchQueue* queue, uint32_t producer, uint32_t count)
+{
+	BenchItem item;
+	item.Producer = producer;
+
+	for (uint32_t sequence = 0; sequence < count; sequence++)
+	{
+		item.Sequence = sequence;
+
+		for (int i = 0; i < (int)sizeof(item.Text); i++)
+			item.Text[i] = Pattern(producer, sequence, i);
+
+		while (!queue->Push(&item))
+		{
+			if (_Stop.load(std::memory_order_relaxed))
+				return;
+
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+static void Run(const char* caption, BenchQueue* queue, int producers, uint32_t count)
+{
+	uint32_t expected[64];
+	long errors = 0;
+	long received = 0;
+	long total = (long)producers * count;
+
+	for (int p = 0; p < producers; p++)
+		expected[p] = 0;
+
+	_Stop = false;
+
+	std::thread* threads[64];
+	double start = NowNs();
+
+	for (int p = 0; p < producers; p++)
+		threads[p] = new std::thread(Produce, queue, (uint32_t)p, count);
+
+	// Consume on this thread, checking each item.
+	BenchItem item;
+
+	while (received < total)
+	{
+		if (!queue->Pop(&item))
+		{
+			if (NowNs() - start > BENCH_TIMEOUT_MS * 1e6)
+				break;
+
+			std::this_thread::yield();
+			continue;
+		}
+
+		received++;
+
+		bool ok = (item.Producer < (uint32_t)producers) && (item.Sequence == expected[item.Producer]);
+
+		for (int i = 0; ok && (i < (int)sizeof(item.Text)); i++)
+			ok = (item.Text[i] == Pattern(item.Producer, item.Sequence, i));
+
+		if (ok)
+			expected[item.Producer]++;
+		else
+		{
+			errors++;
+
+			// Resynchronise on this producer, if the item's plausible.
+			if (item.Producer < (uint32_t)producers)
+				expected[item.Producer] = item.Sequence + 1;
+		}
+	}
+
+	double seconds = (NowNs() - start) / 1e9;
+
+	_Stop = true;
+
+	for (int p = 0; p < producers; p++)
+	{
+		threads[p]->join();
+		delete threads[p];
+	}
+
+	long lost = total - received;
+
+	printf("%-24s %d producer(s): %9.2f M items/s   received %ld of %ld, %ld bad   %s\n", caption, producers,
+		received / seconds / 1e6, received, total, errors, ((errors == 0) && (lost == 0)) ? "PASS" : "FAIL");
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t count = (argc > 1) ? atoi(argv[1]) : 1000000;
+	int producers = (argc > 2) ? atoi(argv[2]) : 3;
+
+	if ((producers < 1) || (producers > 64))
+	{
+		printf("Producers must be 1 to 64\n");
+		return 1;
+	}
+
+	Globals::Verbosity = 0;
+
+	printf("%u items per producer, queues of %d x %d bytes\n\n", count, BENCH_QUEUE_COUNT, (int)sizeof(BenchItem));
+
+	BenchQueue* queue = new RingBufBenchQueue(false);
+	Run("RingBuf (unguarded)", queue, producers, count);
+	delete queue;
+
+	queue = new RingBufBenchQueue(true);
+	Run("RingBuf + mutex", queue, producers, count);
+	Run("RingBuf + mutex", queue, 1, count);
+	delete queue;
+
+	queue = new LockFreeBenchQueue();
+	Run("LockFreeQueue", queue, producers, count);
+	Run("LockFreeQueue", queue, 1, count);
+	delete queue;
+
+	return 0;
+}
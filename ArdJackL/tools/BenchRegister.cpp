@@ -0,0 +1,125 @@
+/*
+	BenchRegister.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+// BenchRegister.cpp
+//
+// Microbenchmark for Register over 10, 100, 1000 and 4000 objects:
+//	- LookupName (last object added), compared with scanning 'Objects' (as 'LookupName' used to);
+//	- LookupName (missing name);
+//	- Resolve (a cached ObjectHandle).
+//
+// Usage:
+//		BenchRegister [iterations]
+
+#include "pch.h"
+
+#include <time.h>
+
+#include "Globals.h"
+#include "IoTObject.h"
+#include "Register.h"
+#include "Utils.h"
+
+
+
+static double NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static IoTObject* ScanLookup(Register* reg, const char* name)
+{
+	// Find 'name' by scanning the objects in order (the old 'Register::LookupName').
+	for (int i = 0; i < reg->ObjectCount; i++)
+	{
+		if (Utils::StringEquals(reg->Objects[i]->Name, name))
+			return reg->Objects[i];
+	}
+
+	return NULL;
+}
+
+
+static void Run(int count, int iterations)
+{
+	Register* reg = new Register();
+	char last[ARDJACK_MAX_NAME_LENGTH];
+
+	for (int i = 0; i < count; i++)
+	{
+		sprintf(last, "Object%d", i);
+		reg->AddObject(new IoTObject(last));
+	}
+
+	// Keep the compiler from discarding the lookups.
+	volatile size_t sink = 0;
+
+	double start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		sink += (size_t)reg->LookupName(last);
+	double lookupNs = (NowNs() - start) / iterations;
+
+	start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		sink += (size_t)ScanLookup(reg, last);
+	double scanNs = (NowNs() - start) / iterations;
+
+	start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		sink += (size_t)reg->LookupName("NoSuchObject");
+	double missNs = (NowNs() - start) / iterations;
+
+	ObjectHandle handle = reg->LookupHandle(last);
+
+	start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		sink += (size_t)reg->Resolve(handle);
+	double resolveNs = (NowNs() - start) / iterations;
+
+	printf("%6d objects: LookupName %7.1f ns (scan %9.1f ns)   miss %7.1f ns   Resolve %5.1f ns\n",
+		count, lookupNs, scanNs, missNs, resolveNs);
+
+	delete reg;
+}
+
+
+int main(int argc, char* argv[])
+{
+	int iterations = (argc > 1) ? atoi(argv[1]) : 100000;
+
+	Globals::Verbosity = 0;
+
+	Run(10, iterations);
+	Run(100, iterations);
+	Run(1000, iterations / 10 + 1);
+	Run(4000, iterations / 10 + 1);
+
+	return 0;
+}
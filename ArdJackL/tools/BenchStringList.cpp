@@ -0,0 +1,129 @@
+/*
+	BenchStringList.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+// BenchStringList.cpp
+//
+// Microbenchmark for StringList over 10, 100 and 1000 items:
+//	- Get (indexed), compared with walking the packed buffer from the start (as 'Get' used to);
+//	- IndexOf (last item);
+//	- Put (longer, then shorter, text into the middle item).
+//
+// Usage:
+//		BenchStringList [iterations]
+
+#include "pch.h"
+
+#include <time.h>
+
+#include "Globals.h"
+#include "StringList.h"
+
+
+
+static double NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static const char* ScanGet(StringList* list, int index)
+{
+	// Find item 'index' by walking the packed buffer from item 0 (the old 'StringList::Get').
+	const char* ptr = list->Get(0);
+
+	for (int i = 0; i < index; i++)
+		ptr += strlen(ptr) + 1;
+
+	return ptr;
+}
+
+
+static void Run(int count, int iterations)
+{
+	StringList list;
+	char temp[40];
+
+	for (int i = 0; i < count; i++)
+	{
+		sprintf(temp, "Item %d", i);
+		list.Add(temp);
+	}
+
+	// Keep the compiler from discarding the lookups.
+	volatile size_t sink = 0;
+
+	// Get every item.
+	double start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		for (int i = 0; i < count; i++)
+			sink += (size_t)list.Get(i);
+	double getNs = (NowNs() - start) / ((double)iterations * count);
+
+	start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		for (int i = 0; i < count; i++)
+			sink += (size_t)ScanGet(&list, i);
+	double scanNs = (NowNs() - start) / ((double)iterations * count);
+
+	// Find the last item.
+	sprintf(temp, "Item %d", count - 1);
+
+	start = NowNs();
+	for (int n = 0; n < iterations; n++)
+		sink += list.IndexOf(temp);
+	double indexOfNs = (NowNs() - start) / iterations;
+
+	// Grow and shrink the middle item.
+	int middle = count / 2;
+
+	start = NowNs();
+	for (int n = 0; n < iterations; n++)
+	{
+		list.Put(middle, "A somewhat longer replacement item");
+		list.Put(middle, "Short");
+	}
+	double putNs = (NowNs() - start) / (2.0 * iterations);
+
+	printf("%6d items: Get %8.1f ns (scan %9.1f ns)   IndexOf(last) %10.1f ns   Put(middle) %9.1f ns\n",
+		count, getNs, scanNs, indexOfNs, putNs);
+}
+
+
+int main(int argc, char* argv[])
+{
+	int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+
+	Globals::Verbosity = 0;
+
+	Run(10, iterations);
+	Run(100, iterations);
+	Run(1000, iterations / 10 + 1);
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+/*
+	UdpLatency.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+// UdpLatency.cpp
+//
+// Measures request -> response latency for an ArdJack host's UDP Connection (e.g. 'udp0').
+// Sends one request at a time and waits for the (next) response datagram.
+//
+// Usage:
+//		UdpLatency [-h host] [-p port] [-l listenPort] [-n count] [-w warmup] [request]
+//
+// E.g.
+//		UdpLatency -p 5101 -l 5102 -n 1000 '$host: ?ai0'
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+
+
+static double NowUs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* host = "127.0.0.1";
+	int port = 5101;
+	int listenPort = 5102;
+	int count = 200;
+	int warmup = 10;
+	const char* request = "$host: ?ai0";
+
+	int opt;
+
+	while ((opt = getopt(argc, argv, "h:p:l:n:w:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'h': host = optarg; break;
+		case 'p': port = atoi(optarg); break;
+		case 'l': listenPort = atoi(optarg); break;
+		case 'n': count = atoi(optarg); break;
+		case 'w': warmup = atoi(optarg); break;
+		default:
+			fprintf(stderr, "Usage: %s [-h host] [-p port] [-l listenPort] [-n count] [-w warmup] [request]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	if (optind < argc)
+		request = argv[optind];
+
+	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	struct sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons(listenPort);
+
+	if (bind(sock, (struct sockaddr*)&local, sizeof(local)) != 0)
+	{
+		perror("bind");
+		return 1;
+	}
+
+	struct sockaddr_in remote;
+	memset(&remote, 0, sizeof(remote));
+	remote.sin_family = AF_INET;
+	remote.sin_addr.s_addr = inet_addr(host);
+	remote.sin_port = htons(port);
+
+	std::vector<double> samples;
+	int lost = 0;
+	char buffer[512];
+
+	for (int i = 0; i < warmup + count; i++)
+	{
+		double start = NowUs();
+
+		sendto(sock, request, strlen(request), 0, (struct sockaddr*)&remote, sizeof(remote));
+
+		struct pollfd pfd = { sock, POLLIN, 0 };
+
+		if (poll(&pfd, 1, 1000) <= 0)
+		{
+			lost++;
+			continue;
+		}
+
+		int len = recv(sock, buffer, sizeof(buffer) - 1, 0);
+		double elapsed = NowUs() - start;
+
+		if (len < 0)
+		{
+			lost++;
+			continue;
+		}
+
+		buffer[len] = 0;
+
+		if (i == 0)
+			printf("First response: '%s'\n", buffer);
+
+		if (i >= warmup)
+			samples.push_back(elapsed);
+	}
+
+	close(sock);
+
+	if (samples.empty())
+	{
+		printf("No responses (%d lost)\n", lost);
+		return 1;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0.0;
+
+	for (double sample : samples)
+		sum += sample;
+
+	int n = (int)samples.size();
+
+	printf("requests %d, responses %d, lost %d\n", count, n, lost);
+	printf("latency us: min %.1f  mean %.1f  p50 %.1f  p99 %.1f  max %.1f\n",
+		samples[0], sum / n, samples[n / 2], samples[std::min(n - 1, (int)(n * 0.99))], samples[n - 1]);
+
+	return 0;
+}
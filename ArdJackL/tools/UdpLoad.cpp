@@ -0,0 +1,534 @@
+/*
+	UdpLoad.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+// UdpLoad.cpp
+//
+// Load generator for an ArdJack host's UDP Connection (e.g. 'udp0').
+// Many simulated clients, each with its own socket (source port) and 'from' path, send a mix of Device requests
+// ('?ai0', '!do0 1' and 'getinventory') at a target total rate, in format 0 or format 1, e.g.
+//		$host: ?ai0
+//		[type=request from=\\load\c3 to=\host] ?ai0
+//
+// The Device sends all its responses to its output Connection's one destination (e.g. 'udp0' OutPort), without a
+// request ID, and answers its buffer in order - so each response is matched to the oldest outstanding request of
+// the same kind. A successful write has no response, so writes only add load. A request that isn't answered
+// within the timeout counts as lost.
+//
+// Usage:
+//		UdpLoad [-h host] [-p port] [-l listenPort] [-d device] [-f format] [-c clients] [-r rate] [-t seconds]
+//			[-m read:write:inventory] [-T timeoutMs]
+//
+// E.g.
+//		UdpLoad -p 5101 -l 5102 -f 1 -c 16 -r 2000 -t 5 -m 8:1:1
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+
+enum RequestKind
+{
+	KIND_READ,
+	KIND_WRITE,
+	KIND_INVENTORY,
+	KIND_COUNT
+};
+
+static const char* KindNames[KIND_COUNT] = { "read", "write", "inventory" };
+static const char* KindTexts[KIND_COUNT] = { "?ai0", "!do0 1", "getinventory" };
+
+// The Part read by KIND_READ requests, i.e. the first word of their responses.
+static const char* ReadPartName = "ai0";
+
+
+struct PendingRequest
+{
+	double SentUs;
+	int Received;											// responses so far (for 'getinventory')
+};
+
+
+static std::deque<PendingRequest> _Pending[KIND_COUNT];
+static std::vector<double> _Latencies[KIND_COUNT];
+static long _Lost[KIND_COUNT];
+static long _Sent[KIND_COUNT];
+
+static long _Errors = 0;									// 'ERROR' responses
+static char _InventoryFirstWord[40] = "";					// first word of the first 'getinventory' response
+static int _InventoryLines = 0;								// responses per 'getinventory'
+static double _LastResponseUs = 0.0;
+static long _Responses = 0;
+static long _SendErrors = 0;
+static long _Unmatched = 0;
+
+
+
+static double NowUs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+
+static void FirstWord(const char* text, char* word, int size)
+{
+	// Skip a format 1 '[...]' header or a format 0 '$prefix:', then copy the first word of the response text.
+	if (text[0] == '[')
+	{
+		const char* end = strchr(text, ']');
+
+		if (NULL != end)
+			text = end + 1;
+	}
+	else if (text[0] == '$')
+	{
+		const char* end = strchr(text, ' ');
+
+		if (NULL != end)
+			text = end;
+	}
+
+	while (*text == ' ')
+		text++;
+
+	int length = 0;
+
+	while ((text[length] != 0) && (text[length] != ' ') && (length < size - 1))
+	{
+		word[length] = text[length];
+		length++;
+	}
+
+	word[length] = 0;
+}
+
+
+static void Expire(double now, double timeoutUs)
+{
+	for (int kind = 0; kind < KIND_COUNT; kind++)
+	{
+		std::deque<PendingRequest>* pending = &_Pending[kind];
+
+		while (!pending->empty() && (now - pending->front().SentUs > timeoutUs))
+		{
+			_Lost[kind]++;
+			pending->pop_front();
+		}
+	}
+}
+
+
+static void MatchResponse(const char* text, double now)
+{
+	char word[40];
+	FirstWord(text, word, sizeof(word));
+
+	_Responses++;
+	_LastResponseUs = now;
+
+	if (strcmp(word, "ERROR") == 0)
+	{
+		_Errors++;
+		return;
+	}
+
+	if (strcmp(word, ReadPartName) == 0)
+	{
+		std::deque<PendingRequest>* pending = &_Pending[KIND_READ];
+
+		if (pending->empty())
+		{
+			_Unmatched++;
+			return;
+		}
+
+		_Latencies[KIND_READ].push_back(now - pending->front().SentUs);
+		pending->pop_front();
+		return;
+	}
+
+	if ((NULL == strstr(word, ".count")) && (NULL == strstr(word, ".config")))
+	{
+		_Unmatched++;
+		return;
+	}
+
+	// A 'getinventory' response: its first line starts the oldest unstarted request, the others continue the
+	// latest started one. The request is answered by its last line.
+	std::deque<PendingRequest>* pending = &_Pending[KIND_INVENTORY];
+	std::deque<PendingRequest>::iterator iter = pending->end();
+
+	if (strcmp(word, _InventoryFirstWord) == 0)
+	{
+		iter = std::find_if(pending->begin(), pending->end(),
+			[](const PendingRequest& request) { return request.Received == 0; });
+	}
+	else
+	{
+		for (std::deque<PendingRequest>::iterator it = pending->begin(); it != pending->end(); ++it)
+		{
+			if (it->Received > 0)
+				iter = it;
+		}
+	}
+
+	if (iter == pending->end())
+	{
+		_Unmatched++;
+		return;
+	}
+
+	if (++iter->Received >= _InventoryLines)
+	{
+		_Latencies[KIND_INVENTORY].push_back(now - iter->SentUs);
+		pending->erase(iter);
+	}
+}
+
+
+static double Percentile(const std::vector<double>& samples, double percent)
+{
+	int n = (int)samples.size();
+
+	return samples[std::min(n - 1, (int)(n * percent / 100.0))];
+}
+
+
+static int Probe(int clientSock, int listenSock, const char* text, char* firstWord)
+{
+	// Send one request and count its responses (until there's a 500 ms gap).
+	send(clientSock, text, strlen(text), 0);
+
+	int count = 0;
+	char buffer[512];
+	struct pollfd pfd = { listenSock, POLLIN, 0 };
+
+	while (poll(&pfd, 1, 500) > 0)
+	{
+		int len = recv(listenSock, buffer, sizeof(buffer) - 1, 0);
+
+		if (len < 0)
+			break;
+
+		buffer[len] = 0;
+
+		if ((count == 0) && (NULL != firstWord))
+			FirstWord(buffer, firstWord, 40);
+
+		count++;
+	}
+
+	return count;
+}
+
+
+static void ReceiveAll(int sock)
+{
+	char buffer[512];
+
+	while (true)
+	{
+		int len = recv(sock, buffer, sizeof(buffer) - 1, MSG_DONTWAIT);
+
+		if (len < 0)
+			break;
+
+		buffer[len] = 0;
+		MatchResponse(buffer, NowUs());
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* host = "127.0.0.1";
+	int port = 5101;
+	int listenPort = 5102;
+	const char* device = "host";
+	int format = 0;
+	int clients = 8;
+	double rate = 1000.0;
+	double seconds = 5.0;
+	int weights[KIND_COUNT] = { 8, 1, 1 };
+	int timeoutMs = 1000;
+
+	const char* usage = "Usage: %s [-h host] [-p port] [-l listenPort] [-d device] [-f format] [-c clients] [-r rate] "
+		"[-t seconds] [-m read:write:inventory] [-T timeoutMs]\n";
+	int opt;
+
+	while ((opt = getopt(argc, argv, "h:p:l:d:f:c:r:t:m:T:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'h': host = optarg; break;
+		case 'p': port = atoi(optarg); break;
+		case 'l': listenPort = atoi(optarg); break;
+		case 'd': device = optarg; break;
+		case 'f': format = atoi(optarg); break;
+		case 'c': clients = atoi(optarg); break;
+		case 'r': rate = atof(optarg); break;
+		case 't': seconds = atof(optarg); break;
+		case 'm':
+			if (sscanf(optarg, "%d:%d:%d", &weights[KIND_READ], &weights[KIND_WRITE], &weights[KIND_INVENTORY]) != 3)
+			{
+				fprintf(stderr, usage, argv[0]);
+				return 2;
+			}
+			break;
+		case 'T': timeoutMs = atoi(optarg); break;
+		default:
+			fprintf(stderr, usage, argv[0]);
+			return 2;
+		}
+	}
+
+	int totalWeight = weights[KIND_READ] + weights[KIND_WRITE] + weights[KIND_INVENTORY];
+
+	if ((format < 0) || (format > 1) || (clients < 1) || (rate <= 0.0) || (seconds <= 0.0) || (totalWeight <= 0))
+	{
+		fprintf(stderr, usage, argv[0]);
+		return 2;
+	}
+
+	// The listening socket, with a large buffer, so that responses are lost by the host rather than by us.
+	int listenSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	int bufferSize = 8 * 1024 * 1024;
+	setsockopt(listenSock, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+	struct sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons(listenPort);
+
+	if (bind(listenSock, (struct sockaddr*)&local, sizeof(local)) != 0)
+	{
+		perror("bind");
+		return 1;
+	}
+
+	struct sockaddr_in remote;
+	memset(&remote, 0, sizeof(remote));
+	remote.sin_family = AF_INET;
+	remote.sin_addr.s_addr = inet_addr(host);
+	remote.sin_port = htons(port);
+
+	// The clients, each with its own socket and request texts.
+	std::vector<int> sockets(clients);
+	std::vector<std::string> texts(clients * KIND_COUNT);
+	char text[200];
+
+	for (int client = 0; client < clients; client++)
+	{
+		sockets[client] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+		if (connect(sockets[client], (struct sockaddr*)&remote, sizeof(remote)) != 0)
+		{
+			perror("connect");
+			return 1;
+		}
+
+		for (int kind = 0; kind < KIND_COUNT; kind++)
+		{
+			if (format == 0)
+				sprintf(text, "$%s: %s", device, KindTexts[kind]);
+			else
+				sprintf(text, "[type=request from=\\\\load\\c%d to=\\%s] %s", client, device, KindTexts[kind]);
+
+			texts[client * KIND_COUNT + kind] = text;
+		}
+	}
+
+	// Check the host is answering and, if needed, how many responses a 'getinventory' request gets.
+	if (Probe(sockets[0], listenSock, texts[KIND_READ].c_str(), NULL) == 0)
+	{
+		printf("No response to '%s' - is the host running?\n", texts[KIND_READ].c_str());
+		return 1;
+	}
+
+	if (weights[KIND_INVENTORY] > 0)
+	{
+		_InventoryLines = Probe(sockets[0], listenSock, texts[KIND_INVENTORY].c_str(), _InventoryFirstWord);
+
+		if (_InventoryLines == 0)
+		{
+			printf("No response to '%s'\n", texts[KIND_INVENTORY].c_str());
+			return 1;
+		}
+	}
+
+	printf("format %d, %d clients, '%s' on %s:%d, target %.0f requests/s for %.1f s, mix %d:%d:%d\n",
+		format, clients, device, host, port, rate, seconds, weights[KIND_READ], weights[KIND_WRITE],
+		weights[KIND_INVENTORY]);
+
+	// Send at the target rate, matching responses as they arrive.
+	long total = (long)(rate * seconds);
+	double timeoutUs = timeoutMs * 1000.0;
+	double start = NowUs();
+	double lastSentUs = start;
+	long next = 0;
+
+	while (true)
+	{
+		double now = NowUs();
+
+		while ((next < total) && (start + next * 1e6 / rate <= now))
+		{
+			int slot = (int)(next % totalWeight);
+			int kind = 0;
+
+			while (slot >= weights[kind])
+				slot -= weights[kind++];
+
+			int client = (int)(next % clients);
+			const std::string& wire = texts[client * KIND_COUNT + kind];
+
+			lastSentUs = NowUs();
+
+			if (send(sockets[client], wire.c_str(), wire.length(), 0) < 0)
+				_SendErrors++;
+			else
+			{
+				_Sent[kind]++;
+
+				if (kind != KIND_WRITE)
+					_Pending[kind].push_back({ lastSentUs, 0 });
+			}
+
+			next++;
+		}
+
+		Expire(now, timeoutUs);
+
+		if (next >= total)
+		{
+			bool pending = false;
+
+			for (int kind = 0; kind < KIND_COUNT; kind++)
+				pending |= !_Pending[kind].empty();
+
+			if (!pending)
+				break;
+		}
+
+		// Wait for a response, or until the next request is due.
+		double waitUs = (next < total) ? start + next * 1e6 / rate - NowUs() : 1000.0;
+
+		if (waitUs > 0.0)
+		{
+			struct timespec ts = { (time_t)(waitUs / 1e6), (long)(fmod(waitUs, 1e6) * 1000.0) };
+			struct pollfd pfd = { listenSock, POLLIN, 0 };
+			ppoll(&pfd, 1, &ts, NULL);
+		}
+
+		ReceiveAll(listenSock);
+	}
+
+	// Allow a little longer for stray responses, so they're counted as unmatched.
+	usleep(100 * 1000);
+	ReceiveAll(listenSock);
+
+	for (int client = 0; client < clients; client++)
+		close(sockets[client]);
+
+	close(listenSock);
+
+	// Report.
+	double sendSeconds = (lastSentUs - start) / 1e6;
+	double elapsedSeconds = (std::max(lastSentUs, _LastResponseUs) - start) / 1e6;
+	long sent = _Sent[KIND_READ] + _Sent[KIND_WRITE] + _Sent[KIND_INVENTORY];
+	long answered = 0;
+	std::vector<double> all;
+
+	printf("sent %ld in %.2f s (%.0f/s), send errors %ld\n", sent, sendSeconds, sent / std::max(sendSeconds, 1e-6),
+		_SendErrors);
+	printf("responses %ld, errors %ld, unmatched %ld\n\n", _Responses, _Errors, _Unmatched);
+	printf("%-10s %8s %8s %6s %7s %9s %9s %9s %9s %9s %9s\n", "kind", "sent", "answered", "lost", "lost %",
+		"min us", "mean us", "p50 us", "p90 us", "p99 us", "max us");
+
+	for (int kind = 0; kind < KIND_COUNT; kind++)
+	{
+		std::vector<double>& samples = _Latencies[kind];
+
+		if (kind == KIND_WRITE)
+		{
+			printf("%-10s %8ld %8s\n", KindNames[kind], _Sent[kind], "-");
+			continue;
+		}
+
+		int n = (int)samples.size();
+		answered += n;
+		all.insert(all.end(), samples.begin(), samples.end());
+
+		printf("%-10s %8ld %8d %6ld %7.1f", KindNames[kind], _Sent[kind], n, _Lost[kind],
+			(_Sent[kind] > 0) ? 100.0 * _Lost[kind] / _Sent[kind] : 0.0);
+
+		if (n > 0)
+		{
+			std::sort(samples.begin(), samples.end());
+
+			double sum = 0.0;
+
+			for (double sample : samples)
+				sum += sample;
+
+			printf(" %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f", samples[0], sum / n, Percentile(samples, 50),
+				Percentile(samples, 90), Percentile(samples, 99), samples[n - 1]);
+		}
+
+		printf("\n");
+	}
+
+	if (all.empty())
+	{
+		printf("\nNo requests answered\n");
+		return 1;
+	}
+
+	std::sort(all.begin(), all.end());
+
+	printf("\nthroughput: %.0f requests/s answered, %.0f responses/s; latency us: p50 %.1f  p99 %.1f  max %.1f\n",
+		answered / elapsedSeconds, _Responses / elapsedSeconds, Percentile(all, 50), Percentile(all, 99),
+		all[all.size() - 1]);
+
+	return 0;
+}
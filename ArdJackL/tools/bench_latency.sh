@@ -0,0 +1,31 @@
+#!/bin/sh
+# Measures 'udp0' request -> response latency with the host polling every 20 ms (as ArdJackW does),
+# then with the epoll event loop.
+#
+# Usage: bench_latency.sh [build folder]
+
+BUILD=${1:-build}
+COUNT=${COUNT:-200}
+
+run()
+{
+	mode=$1
+	shift
+
+	"$BUILD/ArdJackL" "$@" \
+		"configure udp0 InPort=5101 OutIP=127.0.0.1 OutPort=5102" \
+		"configure host Input=udp0 Output=udp0" \
+		"activate host" \
+		"set verbosity 0" < /dev/null > /dev/null 2>&1 &
+	pid=$!
+
+	sleep 1
+	echo "== $mode"
+	"$BUILD/UdpLatency" -p 5101 -l 5102 -n "$COUNT" '$host: ?ai0'
+
+	kill $pid
+	wait $pid 2>/dev/null
+}
+
+run "polling (20 ms timers)" -poll
+run "event loop (epoll)"
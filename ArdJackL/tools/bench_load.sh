@@ -0,0 +1,32 @@
+#!/bin/sh
+# Loads 'udp0' from many simulated clients, with format 0 then format 1 requests, and reports throughput, loss and
+# latency percentiles.
+#
+# Usage: bench_load.sh [build folder]
+#
+# Set CLIENTS, RATE, DURATION (s) or MIX (read:write:inventory weights) to change the load.
+
+BUILD=${1:-build}
+CLIENTS=${CLIENTS:-16}
+RATE=${RATE:-2000}
+DURATION=${DURATION:-5}
+MIX=${MIX:-8:1:1}
+
+"$BUILD/ArdJackL" \
+	"configure udp0 InPort=5101 OutIP=127.0.0.1 OutPort=5102" \
+	"configure host Input=udp0 Output=udp0" \
+	"activate host" \
+	"set verbosity 0" < /dev/null > /dev/null 2>&1 &
+pid=$!
+
+sleep 1
+
+for format in 0 1
+do
+	echo "== format $format"
+	"$BUILD/UdpLoad" -p 5101 -l 5102 -f $format -c "$CLIENTS" -r "$RATE" -t "$DURATION" -m "$MIX"
+	echo
+done
+
+kill $pid
+wait $pid 2>/dev/null
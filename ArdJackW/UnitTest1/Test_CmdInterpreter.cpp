@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "CmdInterpreter.h"
+#include "CommandSet.h"
+#include "Globals.h"
+#include "Register.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_CmdInterpreter)
+	{
+	public:
+		TEST_METHOD(Test_Macros)
+		{
+			// Arrange.
+			if (NULL == Globals::ObjectRegister)
+				Globals::ObjectRegister = new Register();
+
+			strcpy(Globals::CommandSeparator, ";");
+			strcpy(Globals::CommentPrefix, "#");
+			strcpy(Globals::OneCommandPrefix, "|");
+
+			CmdInterpreter interp;
+			CommandSet set;
+			interp.AddCommandSet(&set);
+			CmdInterpreter* saveInterpreter = Globals::Interpreter;
+			Globals::Interpreter = &interp;
+			int saveVerbosity = Globals::Verbosity;
+
+			// Act / Assert.
+			// Several commands.
+			interp.AddMacro("m1", "set verbosity 1; set verbosity 2");
+			Assert::IsTrue(interp.ExecuteCommand("m1"));
+			Assert::AreEqual(2, Globals::Verbosity);
+			Assert::IsTrue(interp.ExecuteCommand("m1"));
+			Assert::AreEqual(2, Globals::Verbosity);
+
+			// A Macro that runs another, which changes.
+			interp.AddMacro("m2", "m3");
+			interp.AddMacro("m3", "set verbosity 3");
+			Assert::IsTrue(interp.ExecuteCommand("m2"));
+			Assert::AreEqual(3, Globals::Verbosity);
+
+			interp.AddMacro("m3", "set verbosity 1");
+			Assert::IsTrue(interp.ExecuteCommand("m2"));
+			Assert::AreEqual(1, Globals::Verbosity);
+
+			// A Macro that redefines itself while it runs.
+			interp.AddMacro("m4", "define m4 set verbosity 2; set verbosity 0");
+			Assert::IsTrue(interp.ExecuteCommand("m4"));
+			Assert::AreEqual(0, Globals::Verbosity);
+			Assert::IsTrue(interp.ExecuteCommand("m4"));
+			Assert::AreEqual(2, Globals::Verbosity);
+
+			// A single command's result is the Macro's.
+			interp.AddMacro("m5", "nosuchverb");
+			Assert::IsFalse(interp.ExecuteCommand("m5"));
+			interp.AddMacro("m5", "nosuchverb; set verbosity 0");
+			Assert::IsTrue(interp.ExecuteCommand("m5"));
+			Assert::AreEqual(0, Globals::Verbosity);
+
+			// A change in the command syntax.
+			interp.AddMacro("m6", "#set verbosity 1");
+			Assert::IsTrue(interp.ExecuteCommand("m6"));
+			Assert::AreEqual(0, Globals::Verbosity);
+
+			strcpy(Globals::CommentPrefix, "//");
+			Assert::IsFalse(interp.ExecuteCommand("m6"));
+
+			strcpy(Globals::CommentPrefix, "#");
+			Globals::Interpreter = saveInterpreter;
+			Globals::Verbosity = saveVerbosity;
+		}
+
+
+		TEST_METHOD(Test_Verbs)
+		{
+			// Arrange.
+			if (NULL == Globals::ObjectRegister)
+				Globals::ObjectRegister = new Register();
+
+			strcpy(Globals::CommandSeparator, ";");
+			strcpy(Globals::CommentPrefix, "#");
+			strcpy(Globals::OneCommandPrefix, "|");
+
+			CmdInterpreter interp;
+			CommandSet set;
+			interp.AddCommandSet(&set);
+			int saveVerbosity = Globals::Verbosity;
+			char verb[20];
+
+			// Act / Assert.
+			// A command.
+			Assert::IsTrue(interp.ExecuteCommand("SET verbosity 1"));
+			Assert::AreEqual(1, Globals::Verbosity);
+
+			// A Macro, which changes.
+			interp.AddMacro("m1", "set verbosity 2");
+			Assert::IsTrue(interp.ExecuteCommand("M1"));
+			Assert::AreEqual(2, Globals::Verbosity);
+
+			interp.AddMacro("m1", "set verbosity 3");
+			Assert::IsTrue(interp.ExecuteCommand("m1"));
+			Assert::AreEqual(3, Globals::Verbosity);
+
+			// An unknown verb, until it's defined.
+			Assert::IsFalse(interp.ExecuteCommand("m2"));
+			Assert::IsFalse(interp.ExecuteCommand("m2"));
+
+			interp.AddMacro("m2", "set verbosity 0");
+			Assert::IsTrue(interp.ExecuteCommand("m2"));
+			Assert::AreEqual(0, Globals::Verbosity);
+
+			// More unknown verbs than the index holds.
+			for (int i = 0; i < ARDJACK_VERB_INDEX_SIZE; i++)
+			{
+				sprintf(verb, "unknown%d", i);
+				Assert::IsFalse(interp.ExecuteCommand(verb));
+			}
+
+			Assert::IsTrue(interp.ExecuteCommand("m1"));
+			Assert::AreEqual(3, Globals::Verbosity);
+
+			// A command hides a Macro of the same name.
+			interp.AddMacro("set", "set verbosity 4");
+			Assert::IsTrue(interp.ExecuteCommand("set verbosity 0"));
+			Assert::AreEqual(0, Globals::Verbosity);
+
+			// A removed Macro.
+			interp.RemoveMacro("m1");
+			Assert::IsFalse(interp.ExecuteCommand("m1"));
+
+			Globals::Verbosity = saveVerbosity;
+		}
+	};
+}
@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "ConfigProp.h"
+#include "ConfigSchema.h"
+#include "Configuration.h"
+#include "Globals.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_Configuration)
+	{
+	public:
+		static void AddProps(Configuration* config, int port)
+		{
+			config->AddBooleanProp("Flag", "A flag.");
+			config->AddIntegerProp("Port", "Port number.", port);
+			config->AddStringProp("Host", "Host name.", "localhost");
+		}
+
+
+		TEST_METHOD(Test_Handle)
+		{
+			// Arrange.
+			Configuration config1;
+			Configuration config2;
+			AddProps(&config1, 5001);
+			config2.AddStringProp("Extra", "Not in 'config1'.");
+			AddProps(&config2, 5002);
+			ConfigHandle handle = { "Port" };
+			int port;
+
+			// Act / Assert.
+			// A handle follows each Configuration's schema.
+			Assert::IsTrue(config1.GetAsInteger(&handle, &port));
+			Assert::AreEqual(5001, port);
+			Assert::AreEqual(1, (int)handle.Index);
+
+			Assert::IsTrue(config2.GetAsInteger(&handle, &port));
+			Assert::AreEqual(5002, port);
+			Assert::AreEqual(2, (int)handle.Index);
+
+			Assert::IsTrue(config1.Resolve(&handle) == config1.LookupPath("Port"));
+
+			ConfigHandle missing = { "Missing" };
+			Assert::IsFalse(config1.GetAsInteger(&missing, &port));
+		}
+
+
+		TEST_METHOD(Test_LookupPath)
+		{
+			// Arrange.
+			Configuration config;
+			char name[20];
+
+			for (int i = 0; i < 20; i++)
+			{
+				sprintf(name, "Prop%c", 'T' - i);
+				config.AddIntegerProp(name, "A property.", i);
+			}
+
+			config.SortItems();
+			int value;
+
+			// Act / Assert.
+			for (int i = 0; i < 20; i++)
+			{
+				sprintf(name, "prop%c", 't' - i);
+				Assert::IsTrue(config.GetAsInteger(name, &value));
+				Assert::AreEqual(i, value);
+			}
+
+			Assert::IsTrue(NULL == config.LookupPath("Prop"));
+			Assert::IsTrue(NULL == config.LookupPath("PropZ"));
+			Assert::IsTrue(NULL == config.LookupPath(""));
+		}
+
+
+		TEST_METHOD(Test_Reuse)
+		{
+			// Arrange.
+			Configuration config1;
+			Configuration config2;
+			AddProps(&config1, 5001);
+			AddProps(&config2, 5002);
+			int port;
+
+			// Act.
+			// Changing a property's description changes only this Configuration's schema.
+			config2.AddIntegerProp("Port", "Output port number.", 5003);
+
+			// Assert.
+			Assert::IsFalse(config1.Schema == config2.Schema);
+			Assert::AreEqual(3, (int)config2.PropCount);
+			Assert::IsTrue(strcmp(config1.LookupPath("Port")->Description(), "Port number.") == 0);
+			Assert::IsTrue(strcmp(config2.LookupPath("Port")->Description(), "Output port number.") == 0);
+			Assert::IsTrue(strcmp(config2.LookupPath("Host")->StringValue(), "localhost") == 0);
+
+			Assert::IsTrue(config2.GetAsInteger("Port", &port));
+			Assert::AreEqual(5003, port);
+		}
+
+
+		TEST_METHOD(Test_SharedSchema)
+		{
+			// Arrange.
+			Configuration config1;
+			Configuration config2;
+			char host[ARDJACK_MAX_CONFIG_VALUE_LENGTH];
+			int port;
+
+			// Act.
+			AddProps(&config1, 5001);
+			AddProps(&config2, 5002);
+			config2.SetFromString("host", "example.com");
+
+			// Assert.
+			// The names etc. are shared, the values aren't.
+			Assert::IsTrue(config1.Schema == config2.Schema);
+			Assert::AreEqual(3, (int)config1.Schema->Count);
+			Assert::IsTrue(config1.LookupPath("Port")->Def == config2.LookupPath("PORT")->Def);
+
+			Assert::IsTrue(config1.GetAsInteger("Port", &port));
+			Assert::AreEqual(5001, port);
+			Assert::IsTrue(config2.GetAsInteger("Port", &port));
+			Assert::AreEqual(5002, port);
+
+			Assert::IsTrue(config1.GetAsString("Host", host));
+			Assert::IsTrue(strcmp(host, "localhost") == 0);
+			Assert::IsTrue(config2.GetAsString("Host", host));
+			Assert::IsTrue(strcmp(host, "example.com") == 0);
+
+			Assert::IsTrue(NULL == config1.LookupPath("Missing"));
+		}
+	};
+}
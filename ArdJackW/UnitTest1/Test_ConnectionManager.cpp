@@ -0,0 +1,232 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Connection.h"
+#include "ConnectionManager.h"
+#include "Globals.h"
+#include "IoTClock.h"
+
+
+
+namespace UnitTest1
+{
+	// An active Connection which notes what it sends.
+	class SendingConnection : public Connection
+	{
+	public:
+		char Sent[200];
+
+		SendingConnection(const char* name) : Connection(name)
+		{
+			_Active = true;
+			Sent[0] = NULL;
+		}
+
+		virtual bool SendQueuedOutput(const char* text) override
+		{
+			strcat(Sent, text);
+			return true;
+		}
+	};
+
+
+	TEST_CLASS(Test_ConnectionManager)
+	{
+	public:
+		TEST_METHOD(Test_Coalesce)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			ConnectionManager mgr;
+			Connection conn("conn0");
+			Assert::IsTrue(mgr.AddOutputQueue(&conn));
+			conn.OverflowPolicy = ARDJACK_OUTPUT_OVERFLOW_COALESCE;
+			const int count = conn.OutputQueueSize;
+			char text[20];
+
+			// Act.
+			// Fill the buffer with values of 2 Parts (keys 1 and 2), then add one more for key 1.
+			for (int i = 0; i < count; i++)
+			{
+				sprintf(text, "value%d", i);
+				Assert::IsTrue(mgr.QueueOutput(&conn, text, 1 + i % 2));
+			}
+
+			Assert::IsTrue(mgr.QueueOutput(&conn, "last", 1));
+
+			// Assert.
+			// Making room discarded a superseded value, and only the latest value for each key is still current.
+			Assert::AreEqual(1, conn.Coalesced);
+			Assert::AreEqual(0, conn.DroppedNewest + conn.DroppedOldest);
+
+			FifoBuffer* queue = conn.OutputQueue;
+			ConnectionOutputBufferItem item;
+			int current = 0;
+
+			while (queue->Pop(&item, true))
+			{
+				if (!conn.IsSuperseded(item.Key, item.Sequence))
+				{
+					current++;
+					Assert::IsTrue((item.Key == 2) || (strcmp(item.Text, "last") == 0));
+				}
+			}
+
+			Assert::AreEqual(2, current);
+		}
+
+
+		TEST_METHOD(Test_DropNewest)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			ConnectionManager mgr;
+			Connection conn("conn0");
+			Assert::IsTrue(mgr.AddOutputQueue(&conn));
+			const int count = conn.OutputQueueSize;
+
+			for (int i = 0; i < count; i++)
+				Assert::IsTrue(mgr.QueueOutput(&conn, "old"));
+
+			// Act.
+			bool result = mgr.QueueOutput(&conn, "new");
+
+			// Assert.
+			Assert::IsFalse(result);
+			Assert::AreEqual(1, conn.DroppedNewest);
+			FifoBuffer* queue = conn.OutputQueue;
+			Assert::AreEqual(count, queue->Count());
+		}
+
+
+		TEST_METHOD(Test_DropOldest)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			ConnectionManager mgr;
+			Connection conn("conn0");
+			Assert::IsTrue(mgr.AddOutputQueue(&conn));
+			conn.OverflowPolicy = ARDJACK_OUTPUT_OVERFLOW_DROP_OLDEST;
+			const int count = conn.OutputQueueSize;
+			char text[20];
+
+			// Act.
+			for (int i = 0; i < count + 3; i++)
+			{
+				sprintf(text, "item%d", i);
+				Assert::IsTrue(mgr.QueueOutput(&conn, text));
+			}
+
+			// Assert.
+			Assert::AreEqual(3, conn.DroppedOldest);
+			Assert::AreEqual(0, conn.DroppedNewest);
+
+			FifoBuffer* queue = conn.OutputQueue;
+			ConnectionOutputBufferItem item;
+			Assert::IsTrue(queue->Pop(&item));
+			Assert::IsTrue(strcmp(item.Text, "item3") == 0);
+		}
+
+
+		TEST_METHOD(Test_Resize)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			ConnectionManager mgr;
+			SendingConnection conn("conn0");
+			conn.OutputQueueSize = 4;
+			Assert::IsTrue(mgr.AddOutputQueue(&conn));
+			FifoBuffer* queue = conn.OutputQueue;
+
+			Assert::IsTrue(mgr.QueueOutput(&conn, "a"));
+			Assert::IsTrue(mgr.QueueOutput(&conn, "b"));
+
+			// Act.
+			// Reactivating with a new size keeps the queue, for the flushing thread to resize - while another thread
+			// is still using the old queue.
+			conn.OutputQueueSize = 8;
+			Assert::IsTrue(mgr.AddOutputQueue(&conn));
+			FifoBuffer* kept = conn.OutputQueue;
+			FifoBuffer* held = conn.UseOutputQueue();
+
+			mgr.CheckOutputBuffer();
+
+			ConnectionOutputBufferItem item;
+			strcpy(item.Text, "c");
+			Assert::IsTrue(held->Push(&item));
+
+			bool retiredWhileHeld = (conn.RetiredOutputQueue == queue);
+			conn.ReleaseOutputQueue();
+			mgr.CheckOutputBuffer();
+
+			// Assert.
+			// The old queue's output, including that pushed after the resize, is sent, and the old queue is deleted
+			// once no thread can be using it.
+			FifoBuffer* resized = conn.OutputQueue;
+			Assert::IsTrue(kept == queue);
+			Assert::IsTrue(retiredWhileHeld);
+			Assert::AreEqual(1, mgr.OutputQueueCount);
+			Assert::AreEqual(8, resized->Capacity);
+			Assert::IsTrue(NULL == conn.RetiredOutputQueue);
+			Assert::IsTrue(strcmp(conn.Sent, "abc") == 0);
+		}
+
+
+		TEST_METHOD(Test_RoundRobin)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			ConnectionManager mgr;
+			SendingConnection conn1("conn1");
+			SendingConnection conn2("conn2");
+			Assert::IsTrue(mgr.AddOutputQueue(&conn1));
+			Assert::IsTrue(mgr.AddOutputQueue(&conn2));
+
+			// 'conn1' has a backlog, 'conn2' has a little output.
+			const char* texts1[] = { "a", "b", "c", "d" };
+
+			for (int i = 0; i < 4; i++)
+				Assert::IsTrue(mgr.QueueOutput(&conn1, texts1[i]));
+
+			Assert::IsTrue(mgr.QueueOutput(&conn2, "x"));
+			Assert::IsTrue(mgr.QueueOutput(&conn2, "y"));
+
+			int saveItems = Globals::DrainMaxItems;
+
+			// Act.
+			// Send 3 items on one tick, then 1 on the next.
+			Globals::DrainMaxItems = 3;
+			mgr.CheckOutputBuffer();
+
+			Globals::DrainMaxItems = 1;
+			mgr.CheckOutputBuffer();
+
+			Globals::DrainMaxItems = saveItems;
+
+			// Assert.
+			// The queues take turns, across ticks too, so 'conn2' isn't held up behind 'conn1'.
+			Assert::IsTrue(strcmp(conn1.Sent, "ab") == 0);
+			Assert::IsTrue(strcmp(conn2.Sent, "xy") == 0);
+			Assert::AreEqual(2L, conn2.OutputSent);
+			FifoBuffer* queue1 = conn1.OutputQueue;
+			Assert::AreEqual(2, queue1->Count());
+
+			// Removing a Connection's queue stops it being flushed.
+			Assert::IsTrue(mgr.RemoveOutputQueue(&conn1));
+			Assert::AreEqual(1, mgr.OutputQueueCount);
+			Assert::IsFalse(mgr.RemoveOutputQueue(&conn1));
+		}
+	};
+}
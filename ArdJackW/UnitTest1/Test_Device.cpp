@@ -0,0 +1,248 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Connection.h"
+#include "Device.h"
+#include "DeviceCodec1.h"
+#include "DeviceManager.h"
+#include "Dynamic.h"
+#include "Globals.h"
+#include "IoTClock.h"
+#include "IoTMessage.h"
+#include "Part.h"
+#include "PartManager.h"
+
+
+
+namespace UnitTest1
+{
+	// An active Connection which notes the messages it's asked to output.
+	class NotingConnection : public Connection
+	{
+	public:
+		int Count;
+		char First[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+		char Last[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+
+		NotingConnection(const char* name) : Connection(name)
+		{
+			_Active = true;
+			Count = 0;
+			First[0] = NULL;
+			Last[0] = NULL;
+		}
+
+		virtual bool OutputMessage(IoTMessage* msg) override
+		{
+			if (Count++ == 0)
+				strcpy(First, msg->Text());
+
+			strcpy(Last, msg->Text());
+
+			return true;
+		}
+	};
+
+
+	// A Device whose inputs all read 'NextValue', and whose Parts all accept writes.
+	class ScannedDevice : public Device
+	{
+	public:
+		int NextValue;
+
+		ScannedDevice(const char* name, bool batchNotify) : Device(name)
+		{
+			_BatchNotify = batchNotify;
+			NextValue = 0;
+		}
+
+		bool Notify(Part* part, const char* value)
+		{
+			return AddToNotifyBatch(part, value);
+		}
+
+		virtual bool Read(Part* part, Dynamic* value) override
+		{
+			part->Value.SetInt(NextValue);
+
+			return value->Copy(&part->Value);
+		}
+
+		virtual bool Write(Part* part, Dynamic* value) override
+		{
+			return part->Value.Copy(value);
+		}
+	};
+
+
+	TEST_CLASS(Test_Device)
+	{
+	public:
+		static void Prepare()
+		{
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			if (NULL == Globals::DeviceCodec)
+				Globals::DeviceCodec = new DeviceCodec1();
+
+			if (NULL == Globals::PartMgr)
+				Globals::PartMgr = new PartManager();
+		}
+
+
+		static int Scan(bool batchNotify, char* first)
+		{
+			// Arrange.
+			Prepare();
+
+			ScannedDevice dev("dev0", batchNotify);
+			NotingConnection conn("conn0");
+			dev.OutputConnection = &conn;
+			dev.AddParts("ai", 20, ARDJACK_PART_TYPE_ANALOG_INPUT, 0, 0, 0);
+			dev.SetNotify(ARDJACK_PART_TYPE_ANALOG_INPUT, true);
+
+			// Act.
+			// All 20 inputs change.
+			bool changes;
+			dev.NextValue = 5;
+			dev.ScanInputsOnce(&changes, true);
+
+			Assert::IsTrue(changes);
+			strcpy(first, conn.First);
+
+			return conn.Count;
+		}
+
+
+		TEST_METHOD(Test_BulkRead)
+		{
+			// Arrange.
+			Prepare();
+
+			DeviceManager mgr;
+			ScannedDevice dev("dev0", false);
+			NotingConnection conn("conn0");
+			dev.OutputConnection = &conn;
+			dev.AddParts("ai", 2, ARDJACK_PART_TYPE_ANALOG_INPUT, 0, 0, 0);
+			dev.AddParts("di", 2, ARDJACK_PART_TYPE_DIGITAL_INPUT, 0, 0, 0);
+			dev.AddParts("do", 2, ARDJACK_PART_TYPE_DIGITAL_OUTPUT, 0, 0, 0);
+			dev.NextValue = 3;
+
+			// Act / Assert.
+			// A list of Parts, a Part type and a selector each get one response holding all their values.
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "?ai1 di0"));
+			Assert::IsTrue(strcmp(conn.First, "parts ai1=3 di0=3") == 0);
+
+			conn.Count = 0;
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "read ai do0"));
+			Assert::IsTrue(strcmp(conn.First, "parts ai0=3 ai1=3 do0=3") == 0);
+
+			conn.Count = 0;
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "?allin"));
+			Assert::AreEqual(1, conn.Count);
+			Assert::IsTrue(strcmp(conn.First, "parts ai0=3 ai1=3 di0=3 di1=3") == 0);
+
+			// A single Part keeps its own response, even with something other than a Part expression after it.
+			conn.Count = 0;
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "?di1"));
+			Assert::IsTrue(strcmp(conn.First, "di1 3") == 0);
+
+			conn.Count = 0;
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "?ai0 1"));
+			Assert::IsTrue(strcmp(conn.First, "ai0 3") == 0);
+
+			// Nothing is read if any expression is invalid.
+			conn.Count = 0;
+			Assert::IsFalse(mgr.HandleDeviceRequest(&dev, "?ai0 ai1 xx"));
+			Assert::AreEqual(1, conn.Count);
+			Assert::IsTrue(strncmp(conn.First, "ERROR ", 6) == 0);
+		}
+
+
+		TEST_METHOD(Test_BulkWrite)
+		{
+			// Arrange.
+			Prepare();
+
+			DeviceManager mgr;
+			ScannedDevice dev("dev0", false);
+			NotingConnection conn("conn0");
+			dev.OutputConnection = &conn;
+			dev.AddParts("do", 3, ARDJACK_PART_TYPE_DIGITAL_OUTPUT, 0, 0, 0);
+
+			// Act / Assert.
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "!do0=1 DO2=1"));
+			Assert::AreEqual(1, dev.Parts[0]->Value.AsInt());
+			Assert::IsTrue(dev.Parts[1]->Value.IsEmpty());
+			Assert::AreEqual(1, dev.Parts[2]->Value.AsInt());
+
+			Assert::IsTrue(mgr.HandleDeviceRequest(&dev, "write allout=0"));
+			Assert::AreEqual(0, dev.Parts[1]->Value.AsInt());
+
+			// Nothing is written if any item is invalid.
+			Assert::IsFalse(mgr.HandleDeviceRequest(&dev, "!do0=1 xx=1"));
+			Assert::AreEqual(0, dev.Parts[0]->Value.AsInt());
+			Assert::AreEqual(1, conn.Count);
+			Assert::IsTrue(strncmp(conn.First, "ERROR ", 6) == 0);
+		}
+
+
+		TEST_METHOD(Test_NotifyBatch)
+		{
+			char first[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+
+			// Act.
+			int count = Scan(true, first);
+
+			// Assert.
+			// The changes don't fit in one notification, so there are 2.
+			Assert::AreEqual(2, count);
+			Assert::IsTrue(strncmp(first, "parts ai0=5 ai1=5 ", 18) == 0);
+			Assert::IsTrue(strlen(first) <= strlen("parts ") + ARDJACK_MAX_NOTIFY_BATCH_LENGTH);
+		}
+
+
+		TEST_METHOD(Test_NotifyLongItem)
+		{
+			// Arrange.
+			Prepare();
+
+			ScannedDevice dev("dev0", true);
+			NotingConnection conn("conn0");
+			dev.OutputConnection = &conn;
+			dev.AddParts("ai", 2, ARDJACK_PART_TYPE_ANALOG_INPUT, 0, 0, 0);
+
+			char value[ARDJACK_MAX_NOTIFY_BATCH_LENGTH + 1];
+			memset(value, 'x', ARDJACK_MAX_NOTIFY_BATCH_LENGTH);
+			value[ARDJACK_MAX_NOTIFY_BATCH_LENGTH] = NULL;
+
+			// Act / Assert.
+			// An item too long for any batch is sent whole, on its own, after the batch so far.
+			Assert::IsTrue(dev.Notify(dev.Parts[0], "1"));
+			Assert::IsTrue(dev.Notify(dev.Parts[1], value));
+			Assert::AreEqual(2, conn.Count);
+			Assert::IsTrue(strcmp(conn.First, "parts ai0=1") == 0);
+			Assert::IsTrue(strncmp(conn.Last, "ai1 ", 4) == 0);
+			Assert::IsTrue(strcmp(conn.Last + 4, value) == 0);
+
+			Assert::IsTrue(dev.FlushNotifyBatch());
+			Assert::AreEqual(2, conn.Count);
+		}
+
+
+		TEST_METHOD(Test_NotifyEach)
+		{
+			char first[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+
+			// Act.
+			int count = Scan(false, first);
+
+			// Assert.
+			Assert::AreEqual(20, count);
+			Assert::IsTrue(strcmp(first, "ai0 5") == 0);
+		}
+	};
+}
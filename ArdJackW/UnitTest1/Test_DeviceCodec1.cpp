@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Device.h"
+#include "DeviceCodec1.h"
+#include "Globals.h"
+#include "StringList.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_DeviceCodec1)
+	{
+	public:
+		static bool SpanEquals(const char* span, int length, const char* text)
+		{
+			return (length == (int)strlen(text)) && (strncmp(span, text, length) == 0);
+		}
+
+
+		TEST_METHOD(Test_DecodeRequest)
+		{
+			// Arrange.
+			DeviceCodec1 codec;
+			char aName[ARDJACK_MAX_NAME_LENGTH];
+			StringList values;
+
+			// Act / Assert.
+			Assert::AreEqual(ARDJACK_OPERATION_READ, codec.DecodeRequest("  ?AI0  ", aName, &values));
+			Assert::IsTrue(strcmp(aName, "ai0") == 0);
+			Assert::AreEqual(0, (int)values.Count);
+
+			Assert::AreEqual(ARDJACK_OPERATION_WRITE, codec.DecodeRequest("write lcd0 'Hello world' 2", aName, &values));
+			Assert::IsTrue(strcmp(aName, "lcd0") == 0);
+			Assert::AreEqual(2, (int)values.Count);
+			Assert::IsTrue(strcmp(values.Get(0), "Hello world") == 0);
+			Assert::IsTrue(strcmp(values.Get(1), "2") == 0);
+
+			Assert::AreEqual(ARDJACK_OPERATION_WRITE, codec.DecodeRequest("!do0=1 do1=0", aName, &values));
+			Assert::IsTrue(strcmp(aName, "") == 0);
+			Assert::AreEqual(2, (int)values.Count);
+
+			Assert::AreEqual(ARDJACK_OPERATION_CONFIGURE, codec.DecodeRequest("configure Period=1.5", aName, &values));
+			Assert::AreEqual(1, (int)values.Count);
+			Assert::IsTrue(strcmp(values.Get(0), "Period=1.5") == 0);
+
+			Assert::AreEqual(ARDJACK_OPERATION_GET_COUNT, codec.DecodeRequest("?di.count", aName, &values));
+			Assert::IsTrue(strcmp(aName, "di") == 0);
+
+			Assert::AreEqual(ARDJACK_OPERATION_NONE, codec.DecodeRequest("?di.size", aName, &values));
+			Assert::AreEqual(ARDJACK_OPERATION_NONE, codec.DecodeRequest("fetch ai0", aName, &values));
+			Assert::AreEqual(ARDJACK_OPERATION_NONE, codec.DecodeRequest("", aName, &values));
+		}
+
+
+		TEST_METHOD(Test_LookupOperation)
+		{
+			// Every verb finds its operation, whatever its case, and nothing else does.
+			Assert::AreEqual(ARDJACK_OPERATION_ACTIVATE, Device::LookupOperation("activate"));
+			Assert::AreEqual(ARDJACK_OPERATION_CONFIGUREPART, Device::LookupOperation("ConfigurePart"));
+			Assert::AreEqual(ARDJACK_OPERATION_GET_INVENTORY, Device::LookupOperation("GETINVENTORY"));
+			Assert::AreEqual(ARDJACK_OPERATION_GET_METRICS, Device::LookupOperation("getmetrics"));
+			Assert::AreEqual(ARDJACK_OPERATION_UNSUBSCRIBE, Device::LookupOperation("unsubscribe"));
+			Assert::AreEqual(ARDJACK_OPERATION_WRITE, Device::LookupOperation("write di0 1", 5));
+
+			Assert::AreEqual(ARDJACK_OPERATION_NONE, Device::LookupOperation("writ"));
+			Assert::AreEqual(ARDJACK_OPERATION_NONE, Device::LookupOperation("writer"));
+			Assert::AreEqual(ARDJACK_OPERATION_NONE, Device::LookupOperation(""));
+		}
+
+
+		TEST_METHOD(Test_Tokenize)
+		{
+			// Arrange.
+			DeviceCodec1 codec;
+			DeviceRequestTokens tokens;
+			const char* line = "read ai0 ai1 \"di 2\"";
+
+			// Act.
+			int oper = codec.Tokenize(line, &tokens);
+
+			// Assert.
+			// The spans point into 'line'.
+			Assert::AreEqual(ARDJACK_OPERATION_READ, oper);
+			Assert::IsTrue(tokens.Prefix == NULL);
+			Assert::IsTrue(tokens.Name == line + 5);
+			Assert::IsTrue(SpanEquals(tokens.Name, tokens.NameLength, "ai0"));
+			Assert::AreEqual(2, tokens.ValueCount);
+			Assert::IsTrue(SpanEquals(tokens.Values[0], tokens.ValueLengths[0], "ai1"));
+			Assert::IsTrue(SpanEquals(tokens.Values[1], tokens.ValueLengths[1], "di 2"));
+		}
+	};
+}
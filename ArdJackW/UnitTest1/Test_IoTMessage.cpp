@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "IoTMessage.h"
+#include "MessagePathTable.h"
+#include "Utils.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_IoTMessage)
+	{
+	public:
+		TEST_METHOD(Test_DecodeFormat0)
+		{
+			// Arrange.
+			IoTMessage msg;
+
+			// Act.
+			msg.Decode("  $host: ?ai0  \r\n");
+
+			// Assert.
+			Assert::AreEqual((int)ARDJACK_MESSAGE_FORMAT_0, (int)msg.Format);
+			Assert::IsTrue(Utils::StringEquals(msg.Text(), "$host: ?ai0", false));
+			Assert::IsTrue(Utils::StringEquals(msg.WireText(), "$host: ?ai0", false));
+			Assert::IsTrue(Utils::StringEquals(msg.FromPath(), "", false));
+		}
+
+
+		TEST_METHOD(Test_DecodeFormat1)
+		{
+			// Arrange.
+			IoTMessage msg;
+
+			// Act.
+			msg.Decode("[TYPE=request from=\\\\pc1\\rem0 to=\\\\host_A\\host return=\\\\pc1\\rem1]   ?ai0 ai1");
+
+			// Assert.
+			Assert::AreEqual((int)ARDJACK_MESSAGE_FORMAT_1, (int)msg.Format);
+			Assert::IsTrue(Utils::StringEquals(msg.Type(), "request", false));
+			Assert::IsTrue(Utils::StringEquals(msg.FromPath(), "\\\\pc1\\rem0", false));
+			Assert::IsTrue(Utils::StringEquals(msg.ToPath(), "\\\\host_A\\host", false));
+			Assert::IsTrue(Utils::StringEquals(msg.ReturnPath(), "\\\\pc1\\rem1", false));
+			Assert::IsTrue(Utils::StringEquals(msg.Text(), "?ai0 ai1", false));
+			Assert::IsTrue(Utils::StringEquals(msg.WireText(),
+				"[TYPE=request from=\\\\pc1\\rem0 to=\\\\host_A\\host return=\\\\pc1\\rem1]   ?ai0 ai1", false));
+		}
+
+
+		TEST_METHOD(Test_DecodeFormat2_Invalid)
+		{
+			// Arrange.
+			IoTMessage msg;
+
+			// Act.
+			msg.Decode("~hello");
+
+			// Assert.
+			Assert::AreEqual((int)ARDJACK_MESSAGE_FORMAT_0, (int)msg.Format);
+			Assert::IsTrue(Utils::StringEquals(msg.Text(), "~hello", false));
+		}
+
+
+		TEST_METHOD(Test_DecodeFormat2_UnknownId)
+		{
+			// Arrange.
+			MessagePathTable senderPaths;
+			MessagePathTable receiverPaths;
+			MessagePathTable otherPaths;
+			IoTMessage sent;
+			IoTMessage reply;
+			IoTMessage received;
+
+			// A peer that has already acknowledged the paths sends them as IDs.
+			IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "ai0 1", &sent,
+				"\\\\host_A\\host", "\\\\pc1\\rem0", "", &senderPaths, 1);
+			received.Decode(sent.WireText(), &receiverPaths, 2);
+			IoTMessage::CreateMessageToSend("request", ARDJACK_MESSAGE_FORMAT_2, "?ai0", &reply,
+				"\\\\pc1\\rem0", "\\\\host_A\\host", "", &receiverPaths, 2);
+			sent.Decode(reply.WireText(), &senderPaths, 1);
+			IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "ai0 2", &sent,
+				"\\\\host_A\\host", "\\\\pc1\\rem0", "", &senderPaths, 1);
+
+			// Act.
+			// Neither a different peer nor a different table has learned them.
+			bool otherPeer = received.Decode(sent.WireText(), &receiverPaths, 3);
+			bool otherTable = received.Decode(sent.WireText(), &otherPaths, 2);
+			bool noTable = received.Decode(sent.WireText());
+
+			// Assert.
+			Assert::IsFalse(otherPeer);
+			Assert::IsFalse(otherTable);
+			Assert::IsFalse(noTable);
+			Assert::IsTrue(Utils::StringEquals(received.FromPath(), "", false));
+			Assert::IsTrue(received.Decode(sent.WireText(), &receiverPaths, 2));
+			Assert::IsTrue(Utils::StringEquals(received.FromPath(), "\\\\host_A\\host", false));
+		}
+
+
+		TEST_METHOD(Test_DecodeThenSet)
+		{
+			// Arrange.
+			IoTMessage msg;
+
+			// Act.
+			msg.Decode("[type=request from=a to=b] text");
+			msg.SetText("changed");
+			msg.Encode();
+
+			// Assert.
+			Assert::IsTrue(Utils::StringEquals(msg.FromPath(), "a", false));
+			Assert::IsTrue(Utils::StringEquals(msg.Text(), "changed", false));
+			Assert::IsTrue(Utils::StringEquals(msg.WireText(), "[type=request from=a to=b] changed", false));
+		}
+
+
+		TEST_METHOD(Test_EncodeDecodeFormat2)
+		{
+			// Arrange.
+			MessagePathTable senderPaths;
+			MessagePathTable receiverPaths;
+			IoTMessage sent;
+			IoTMessage reply;
+			IoTMessage received;
+
+			// Act.
+			// The first message sends the paths in full, and the reply acknowledges them.
+			IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "ai0 1023 di0 -1 +2", &sent,
+				"\\\\host_A\\host", "\\\\pc1\\rem0", "\\\\pc1\\rem1", &senderPaths, 1);
+			int firstLength = (int)strlen(sent.WireText());
+			bool firstDecoded = received.Decode(sent.WireText(), &receiverPaths, 2);
+
+			IoTMessage::CreateMessageToSend("request", ARDJACK_MESSAGE_FORMAT_2, "?ai0", &reply,
+				"\\\\pc1\\rem0", "\\\\host_A\\host", "", &receiverPaths, 2);
+			sent.Decode(reply.WireText(), &senderPaths, 1);
+
+			// So the second message sends them as IDs (and acknowledges the reply's paths).
+			IoTMessage::CreateMessageToSend("response", ARDJACK_MESSAGE_FORMAT_2, "ai0 1023 di0 -1 +2", &sent,
+				"\\\\host_A\\host", "\\\\pc1\\rem0", "\\\\pc1\\rem1", &senderPaths, 1);
+			bool secondDecoded = received.Decode(sent.WireText(), &receiverPaths, 2);
+
+			// Assert.
+			Assert::IsTrue(firstDecoded);
+			Assert::IsTrue(secondDecoded);
+			Assert::AreEqual((int)ARDJACK_MESSAGE_FORMAT_2, (int)received.Format);
+			Assert::IsTrue((int)strlen(sent.WireText()) < firstLength);
+			Assert::IsTrue(NULL == strstr(sent.WireText(), "host_A"));
+			Assert::IsTrue(Utils::StringEquals(received.Type(), "response", false));
+			Assert::IsTrue(Utils::StringEquals(received.FromPath(), "\\\\host_A\\host", false));
+			Assert::IsTrue(Utils::StringEquals(received.ToPath(), "\\\\pc1\\rem0", false));
+			Assert::IsTrue(Utils::StringEquals(received.ReturnPath(), "\\\\pc1\\rem1", false));
+			Assert::IsTrue(Utils::StringEquals(received.Text(), "ai0 1023 di0 -1 +2", false));
+			Assert::IsTrue(Utils::StringEquals(received.WireText(), sent.WireText(), false));
+		}
+
+	};
+}
@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "LockFreeQueue.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_LockFreeQueue)
+	{
+	public:
+		TEST_METHOD(Test_Laps)
+		{
+			// Arrange.
+			LockFreeQueue queue(sizeof(int), 3);
+			int value;
+
+			// Act / Assert.
+			Assert::IsFalse(queue.Pop(&value));
+
+			// Run several laps of the 3 cells, filling the queue each time.
+			for (int lap = 0; lap < 4; lap++)
+			{
+				for (int i = 0; i < 3; i++)
+				{
+					value = lap * 10 + i;
+					Assert::IsTrue(queue.Push(&value));
+				}
+
+				Assert::IsFalse(queue.Push(&value));
+				Assert::AreEqual(3, queue.Count());
+
+				for (int i = 0; i < 3; i++)
+				{
+					Assert::IsTrue(queue.Pop(&value));
+					Assert::AreEqual(lap * 10 + i, value);
+				}
+
+				Assert::IsFalse(queue.Pop(&value));
+				Assert::AreEqual(0, queue.Count());
+			}
+		}
+	};
+}
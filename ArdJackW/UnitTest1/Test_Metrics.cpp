@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "Metrics.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_Metrics)
+	{
+	public:
+		TEST_METHOD(Test_Histogram)
+		{
+			// Arrange.
+			Metric metric;
+			metric.Type = ARDJACK_METRIC_TYPE_HISTOGRAM;
+
+			// Act.
+			// 98 fast samples (10..107 us) and 2 slow ones.
+			for (int i = 0; i < 98; i++)
+				metric.Record(10 + i);
+
+			metric.Record(5000);
+			metric.Record(20000);
+
+			// Assert.
+			Assert::AreEqual(100UL, metric.Count);
+			Assert::AreEqual(20000UL, metric.Max);
+
+			// A percentile is the end of its bucket, which is within 25% of the true value.
+			unsigned long p50 = metric.Percentile(50);
+			Assert::IsTrue((p50 >= 59) && (p50 <= 59 * 5 / 4));
+
+			unsigned long p99 = metric.Percentile(99);
+			Assert::IsTrue((p99 >= 5000) && (p99 <= 5000 * 5 / 4));
+
+			Assert::AreEqual(20000UL, metric.Percentile(100));
+
+			// Every value lies in the bucket which starts at or below it.
+			for (unsigned long value = 1; value < 0x80000000UL; value = value * 3 + 1)
+			{
+				int index = Metric::BucketIndex(value);
+				Assert::IsTrue(Metric::BucketStart(index) <= value);
+				Assert::IsTrue(Metric::BucketStart(index + 1) > value);
+			}
+
+			metric.Reset();
+			Assert::AreEqual(0UL, metric.Percentile(50));
+		}
+
+
+		TEST_METHOD(Test_Registry)
+		{
+			// Arrange.
+			Metrics::Init();
+
+			// Act.
+			Metrics::Items[ARDJACK_METRIC_CONNECTION_RX].Add();
+			Metrics::Items[ARDJACK_METRIC_CONNECTION_RX].Add(2);
+			Metrics::Items[ARDJACK_METRIC_DEVICE_QUEUED].SetLevel(7);
+			Metrics::Items[ARDJACK_METRIC_DEVICE_QUEUED].SetLevel(3);
+
+			int id = Metrics::AddMetric("user_count", ARDJACK_METRIC_TYPE_COUNTER);
+
+			// Assert.
+			Assert::AreEqual(ARDJACK_METRIC_BUILTIN_COUNT, id);
+			Assert::IsTrue(Metrics::LookupMetric("CONN_RX") == &Metrics::Items[ARDJACK_METRIC_CONNECTION_RX]);
+			Assert::IsTrue(Metrics::LookupMetric("user_count") == &Metrics::Items[id]);
+			Assert::IsTrue(Metrics::LookupMetric("missing") == NULL);
+
+			char text[100];
+			Assert::IsTrue(strcmp(Metrics::Items[ARDJACK_METRIC_CONNECTION_RX].ToString(text), "count 3") == 0);
+			Assert::IsTrue(strcmp(Metrics::Items[ARDJACK_METRIC_DEVICE_QUEUED].ToString(text), "value 3 max 7") == 0);
+
+			Metrics::Reset();
+			Assert::AreEqual(0L, Metrics::Items[ARDJACK_METRIC_CONNECTION_RX].Value);
+
+			Metrics::Init();
+		}
+	};
+}
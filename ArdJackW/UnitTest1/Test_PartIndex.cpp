@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "Part.h"
+#include "PartIndex.h"
+#include "PartManager.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_PartIndex)
+	{
+	public:
+		TEST_METHOD(Test_Find)
+		{
+			// Arrange.
+			if (NULL == Globals::PartMgr)
+				Globals::PartMgr = new PartManager();
+
+			Part parts[ARDJACK_MAX_PARTS];
+			Part* partPtrs[ARDJACK_MAX_PARTS];
+			PartIndex index;
+
+			for (int i = 0; i < ARDJACK_MAX_PARTS; i++)
+			{
+				sprintf(parts[i].Name, "part%d", i);
+				partPtrs[i] = &parts[i];
+			}
+
+			// Act.
+			index.Rebuild(partPtrs, ARDJACK_MAX_PARTS);
+
+			// Assert.
+			Assert::IsTrue(index.Find(partPtrs, ARDJACK_MAX_PARTS, "part0") == 0);
+			Assert::IsTrue(index.Find(partPtrs, ARDJACK_MAX_PARTS, "PART17") == 17);
+			Assert::IsTrue(index.Find(partPtrs, ARDJACK_MAX_PARTS, "part") == -1);
+		}
+
+
+		TEST_METHOD(Test_Next)
+		{
+			// Arrange.
+			if (NULL == Globals::PartMgr)
+				Globals::PartMgr = new PartManager();
+
+			Part parts[ARDJACK_MAX_PARTS];
+			Part* partPtrs[ARDJACK_MAX_PARTS];
+			PartIndex index;
+
+			// Alternate analog inputs and digital outputs, with the last Part notifying.
+			for (int i = 0; i < ARDJACK_MAX_PARTS; i++)
+			{
+				sprintf(parts[i].Name, "part%d", i);
+				parts[i].Type = (i % 2 == 0) ? ARDJACK_PART_TYPE_ANALOG_INPUT : ARDJACK_PART_TYPE_DIGITAL_OUTPUT;
+				partPtrs[i] = &parts[i];
+			}
+
+			parts[ARDJACK_MAX_PARTS - 1].Notifying = true;
+
+			const uint8_t analog = 1 << ARDJACK_PART_CATEGORY_ANALOG;
+			const uint8_t input = 1 << ARDJACK_PART_CATEGORY_INPUT;
+			const uint8_t notifying = 1 << ARDJACK_PART_CATEGORY_NOTIFYING;
+			const uint8_t output = 1 << ARDJACK_PART_CATEGORY_OUTPUT;
+
+			// Act.
+			index.Rebuild(partPtrs, ARDJACK_MAX_PARTS);
+
+			// Assert.
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, analog | input, 0, 0) == 0);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, analog | input, 0, 1) == 2);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, output, 0, 0) == 1);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, analog | output, 0, 0) == -1);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, 0, input | output, 5) == 5);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, 0, 0, ARDJACK_MAX_PARTS) == -1);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, notifying, 0, 0) == ARDJACK_MAX_PARTS - 1);
+
+			index.SetCategory(ARDJACK_MAX_PARTS - 1, ARDJACK_PART_CATEGORY_NOTIFYING, false);
+			Assert::IsTrue(index.Next(ARDJACK_MAX_PARTS, notifying, 0, 0) == -1);
+		}
+	};
+}
@@ -0,0 +1,69 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "IoTClock.h"
+#include "IoTObject.h"
+#include "PollProfiler.h"
+#include "Utils.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_PollProfiler)
+	{
+	public:
+		TEST_METHOD(Test_Objects)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			IoTObject obj("obj0");
+			unsigned long nowUs = Utils::NowUs();
+
+			// Act.
+			PollProfiler::Record(&obj.PollProfile, nowUs - 3000);
+			PollProfiler::Record(&obj.PollProfile, nowUs - 1000);
+
+			// Assert.
+			Assert::AreEqual(2L, obj.PollProfile.Polls);
+			Assert::IsTrue(obj.PollProfile.MaxUs >= 3000);
+			Assert::IsTrue(obj.PollProfile.LastUs < obj.PollProfile.MaxUs);
+			Assert::IsTrue(obj.PollProfile.TotalUs >= 4000.0);
+		}
+
+
+		TEST_METHOD(Test_Timers)
+		{
+			// Arrange.
+			if (NULL == Globals::Clock)
+				Globals::Clock = new IoTClock();
+
+			int timer = PollProfiler::AddTimer("timer0", 5);
+			Assert::IsTrue(timer >= 0);
+
+			PollStats* stats = &PollProfiler::Timers[timer].Stats;
+			unsigned long nowUs = Utils::NowUs();
+
+			// Act.
+			// One quick tick, one which took 10 ms (longer than the period), and 2 skipped ticks.
+			PollProfiler::TimerTicked(timer, nowUs);
+			PollProfiler::TimerTicked(timer, nowUs - 10000);
+			PollProfiler::TimerSkipped(timer, 2);
+
+			// Ticks of timers which don't exist are ignored.
+			PollProfiler::TimerTicked(-1, nowUs);
+			PollProfiler::TimerSkipped(ARDJACK_MAX_POLL_TIMERS);
+
+			// Assert.
+			Assert::AreEqual(2L, stats->Polls);
+			Assert::AreEqual(1L, stats->Overruns);
+			Assert::AreEqual(2L, stats->Skipped);
+			Assert::IsTrue(stats->MaxUs >= 10000);
+		}
+	};
+}
@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "IoTObject.h"
+#include "Register.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_Register)
+	{
+	public:
+		TEST_METHOD(Test_Handles)
+		{
+			// Arrange.
+			Register reg;
+			IoTObject* obj1 = new IoTObject("obj1");
+			IoTObject* obj2 = new IoTObject("obj2");
+			reg.AddObject(obj1);
+			reg.AddObject(obj2);
+
+			// Act.
+			ObjectHandle handle1 = reg.LookupHandle("OBJ1");
+			ObjectHandle handle2 = reg.GetHandle(obj2);
+			ObjectHandle missing = reg.LookupHandle("obj3");
+
+			// Assert.
+			Assert::IsTrue(reg.Resolve(handle1) == obj1);
+			Assert::IsTrue(reg.Resolve(handle2) == obj2);
+			Assert::IsTrue(reg.Resolve(missing) == NULL);
+
+			// A deleted object's handle is stale, even after its slot is reused.
+			reg.DeleteObject(obj1);
+			Assert::IsTrue(reg.Resolve(handle1) == NULL);
+			Assert::IsTrue(reg.LookupName("obj1") == NULL);
+
+			IoTObject* obj3 = new IoTObject("obj3");
+			reg.AddObject(obj3);
+			Assert::IsTrue(reg.Resolve(handle1) == NULL);
+			Assert::IsTrue(reg.Resolve(handle2) == obj2);
+			Assert::IsTrue(reg.Resolve(reg.LookupHandle("obj3")) == obj3);
+		}
+
+
+		TEST_METHOD(Test_LookupName)
+		{
+			// Arrange.
+			Register reg;
+			char name[ARDJACK_MAX_NAME_LENGTH];
+			int count = ARDJACK_MAX_OBJECTS;
+
+			for (int i = 0; i < count; i++)
+			{
+				sprintf(name, "obj%d", i);
+				Assert::IsTrue(reg.AddObject(new IoTObject(name)));
+			}
+
+			// Act.
+			// Delete every third object, to exercise removal from the middle of probe runs.
+			for (int i = 0; i < count; i += 3)
+			{
+				sprintf(name, "OBJ%d", i);
+				Assert::IsTrue(reg.DeleteObject(reg.LookupName(name)));
+			}
+
+			// Assert.
+			for (int i = 0; i < count; i++)
+			{
+				sprintf(name, "Obj%d", i);
+				IoTObject* obj = reg.LookupName(name);
+
+				if (i % 3 == 0)
+					Assert::IsTrue(obj == NULL);
+				else
+					Assert::IsTrue((obj != NULL) && (strcmp(obj->Name + 3, name + 3) == 0));
+			}
+		}
+	};
+}
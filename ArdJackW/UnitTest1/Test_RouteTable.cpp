@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include "Globals.h"
+#include "IoTMessage.h"
+#include "Route.h"
+#include "RouteTable.h"
+#include "Utils.h"
+
+
+
+namespace UnitTest1
+{
+	TEST_CLASS(Test_RouteTable)
+	{
+	public:
+		TEST_METHOD(Test_Lookup)
+		{
+			// Arrange.
+			// Routes set up as by 'Globals::SetupStandardRoutes' and 'Device::ApplyConfig'.
+			Route commands("Commands", ARDJACK_ROUTE_TYPE_COMMAND);
+			commands.SetTextFilter("$cmd:");
+			commands.Filter.TypeFilter.Operation = ARDJACK_STRING_COMPARE_EQUALS;
+			strcpy(commands.Filter.TypeFilter.Text, "Command");
+
+			Route device("Device_dev1", ARDJACK_ROUTE_TYPE_REQUEST);
+			device.SetTextFilter("$dev1:");
+			device.Filter.ToFilter.Operation = ARDJACK_STRING_COMPARE_ENDS_WITH;
+			strcpy(device.Filter.ToFilter.Text, "\\dev1");
+			device.Filter.TypeFilter.Operation = ARDJACK_STRING_COMPARE_EQUALS;
+			strcpy(device.Filter.TypeFilter.Text, "Request");
+
+			Route* routes[] = { &commands, &device };
+			RouteTable table;
+			IoTMessage msg;
+
+			// Act.
+			table.Compile(routes, 2);
+
+			// Assert.
+			msg.Decode("$CMD: display");
+			Assert::IsTrue(table.Lookup(&msg) == 1);
+
+			msg.Decode("$dev1: ?ai0");
+			Assert::IsTrue(table.Lookup(&msg) == 2);
+
+			msg.Decode("$dev2: ?ai0");
+			Assert::IsTrue(table.Lookup(&msg) == 0);
+
+			msg.Decode("[type=request to=\\\\pc1\\DEV1] ?ai0");
+			Assert::IsTrue(table.Lookup(&msg) == 2);
+
+			msg.Decode("[type=response to=\\\\pc1\\dev1] ai0 1");
+			Assert::IsTrue(table.Lookup(&msg) == 0);
+
+			msg.Decode("[type=command] display");
+			Assert::IsTrue(table.Lookup(&msg) == 1);
+		}
+
+
+		TEST_METHOD(Test_LookupGeneric)
+		{
+			// Arrange.
+			Route any("Any");
+
+			Route contains("Contains");
+			contains.Filter.BodyFilter.Operation = ARDJACK_STRING_COMPARE_CONTAINS;
+			strcpy(contains.Filter.BodyFilter.Text, "ai0");
+
+			Route* routes[] = { &any, &contains };
+			RouteTable table;
+			IoTMessage msg;
+
+			// Act.
+			table.Compile(routes, 2);
+			msg.Decode("[type=request] ?di0");
+
+			// Assert.
+			Assert::IsFalse(table.IsGeneric(0));
+			Assert::IsTrue(table.IsGeneric(1));
+			Assert::IsTrue(table.Lookup(&msg) == 3);
+		}
+
+	};
+}
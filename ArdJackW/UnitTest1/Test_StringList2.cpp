@@ -119,6 +119,33 @@ namespace UnitTest1
 		}
 
 
+		TEST_METHOD(Test_ManyItems)
+		{
+			// Arrange.
+			StringList sl1;
+
+			char temp[40];
+			int count = 1000;
+
+			// Act.
+			for (int i = 0; i < count; i++)
+			{
+				sprintf(temp, "Item %d", i);
+				sl1.Add(temp);
+			}
+
+			// Assert.
+			Assert::AreEqual(count, (int)sl1.Count);
+
+			for (int i = 0; i < count; i++)
+			{
+				sprintf(temp, "Item %d", i);
+				Assert::IsTrue(Utils::StringEquals(temp, sl1.Get(i), false));
+				Assert::AreEqual(i, sl1.IndexOf(temp));
+			}
+		}
+
+
 		TEST_METHOD(Test_Put)
 		{
 			// Arrange.
@@ -259,6 +286,33 @@ namespace UnitTest1
 		}
 
 
+		TEST_METHOD(Test_Put_Remove)
+		{
+			// Arrange.
+			StringList sl1;
+
+			// Act.
+			sl1.Add("Hello");
+			sl1.Add("cruel");
+			sl1.Add("World!");
+			sl1.Add("again");
+
+			sl1.Put(1, "very, very cruel");
+			sl1.Remove(0);
+			sl1.Put(0, "kind");
+			sl1.Remove(1);
+			sl1.Add("and again");
+			sl1.LogIt();
+
+			// Assert.
+			Assert::AreEqual(3, (int)sl1.Count);
+			Assert::IsTrue(Utils::StringEquals(sl1.Get(0), "kind"));
+			Assert::IsTrue(Utils::StringEquals(sl1.Get(1), "again"));
+			Assert::IsTrue(Utils::StringEquals(sl1.Get(2), "and again"));
+			Assert::AreEqual(2, sl1.IndexOf("and again"));
+		}
+
+
 		TEST_METHOD(Test_RemoveFirst)
 		{
 			// Arrange.
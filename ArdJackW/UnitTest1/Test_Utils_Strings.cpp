@@ -140,6 +140,21 @@ namespace UnitTest1
 		}
 
 
+		TEST_METHOD(Test_StringEqualsN)
+		{
+			// Arrange.
+			const char* path = "\\\\Iceland\\dev1";
+
+			// Act.
+
+			// Assert.
+			Assert::IsTrue(Utils::StringEqualsN(path + 2, "iceland", 7, true));
+			Assert::IsFalse(Utils::StringEqualsN(path + 2, "iceland", 7, false));
+			Assert::IsFalse(Utils::StringEqualsN(path + 2, "icelandic", 7, true));
+			Assert::IsFalse(Utils::StringEqualsN(path + 2, "ice", 7, true));
+		}
+
+
 		TEST_METHOD(Test_StringReplace)
 		{
 			// Arrange.
@@ -92,6 +92,25 @@ long WinClock::NowMs()
 }
 
 
+unsigned long WinClock::NowUs()
+{
+	// Microseconds for measuring intervals (wrapping, as for 'micros()').
+	static LARGE_INTEGER frequency = { 0 };
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+
+	QueryPerformanceCounter(&counter);
+
+	// Split the conversion so that it can't overflow.
+	LONGLONG seconds = counter.QuadPart / frequency.QuadPart;
+	LONGLONG remainder = counter.QuadPart % frequency.QuadPart;
+
+	return (unsigned long)(seconds * 1000000LL + remainder * 1000000LL / frequency.QuadPart);
+}
+
+
 bool WinClock::NowUtc(DateTime* dt)
 {
 	SYSTEMTIME st;
@@ -45,6 +45,7 @@ public:
 
 	virtual bool Now(DateTime* dt) override;
 	virtual long NowMs() override;
+	virtual unsigned long NowUs() override;
 	virtual bool NowUtc(DateTime* dt) override;
 	virtual bool SetDate(int day, int month, int year, bool utc = false) override;
 	virtual bool SetDateTime(DateTime* dt, bool utc = false) override;
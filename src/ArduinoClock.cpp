@@ -79,6 +79,12 @@ long ArduinoClock::NowMs()
 }
 
 
+unsigned long ArduinoClock::NowUs()
+{
+	return micros();
+}
+
+
 bool ArduinoClock::NowUtc(DateTime* now)
 {
 	// TEMPORARY:
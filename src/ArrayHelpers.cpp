@@ -40,6 +40,16 @@
 
 
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
+
+long ArrayHelpers::HeapUsed()
+{
+	// Returns used heap size in bytes.
+	struct mallinfo2 info = mallinfo2();
+
+	return (long)info.uordblks;
+}
+
 #else
 
 long ArrayHelpers::HeapUsed()
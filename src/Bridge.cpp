@@ -35,6 +35,7 @@
 #include "Bridge.h"
 #include "Connection.h"
 #include "Globals.h"
+#include "IoTMessage.h"
 #include "Route.h"
 #include "Log.h"
 #include "Utils.h"
@@ -236,6 +237,16 @@ bool Bridge::Connection1_Callback(Route* sender, IoTMessage* msg)
 	// Forward this message to Connection 2.
 	Connection* conn = (Connection*)_Object2;
 
+	// A format 2 message's path IDs were interned with its sender, so re-encode it for this Connection's peer.
+	if (msg->Format == ARDJACK_MESSAGE_FORMAT_2)
+	{
+		uint32_t peer;
+		MessagePathTable* paths = conn->OutputPaths(&peer);
+
+		if (!msg->Encode(paths, peer))
+			return false;
+	}
+
 	return conn->OutputMessage(msg);
 }
 
@@ -262,6 +273,16 @@ bool Bridge::Connection2_Callback(Route* sender, IoTMessage* msg)
 	// Forward this message to Connection 1.
 	Connection* conn = (Connection*)_Object1;
 
+	// A format 2 message's path IDs were interned with its sender, so re-encode it for this Connection's peer.
+	if (msg->Format == ARDJACK_MESSAGE_FORMAT_2)
+	{
+		uint32_t peer;
+		MessagePathTable* paths = conn->OutputPaths(&peer);
+
+		if (!msg->Encode(paths, peer))
+			return false;
+	}
+
 	return conn->OutputMessage(msg);
 }
 
@@ -31,6 +31,7 @@
 #endif
 
 #include "CmdInterpreter.h"
+#include "CmdScript.h"
 #include "CommandSet.h"
 #include "Dictionary.h"
 #include "Displayer.h"
@@ -40,6 +41,14 @@
 #include "Utils.h"
 
 
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	// The index is never more than half full, so leave at least as many slots again for unknown verbs.
+	#if ARDJACK_VERB_INDEX_SIZE < 4 * (ARDJACK_MAX_COMMANDS * ARDJACK_MAX_COMMAND_SETS + ARDJACK_MAX_MACROS)
+		#error "ARDJACK_VERB_INDEX_SIZE is too small for the commands and Macros"
+	#endif
+#endif
+
+
 
 CmdInterpreter::CmdInterpreter()
 {
@@ -50,17 +59,41 @@ CmdInterpreter::CmdInterpreter()
 	
 	for (int i = 0; i < ARDJACK_MAX_COMMAND_SETS; i++)
 		CommandSets[i] = NULL;
+
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	_IndexedCommands = 0;
+	_VerbCount = 0;
+	_VerbsChanged = true;
+	_VerbsComplete = false;
+#endif
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	_Scripts = NULL;
+#endif
 }
 
 
 CmdInterpreter::~CmdInterpreter()
 {
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	while (NULL != _Scripts)
+	{
+		CmdScript* next = _Scripts->Next;
+		delete _Scripts;
+		_Scripts = next;
+	}
+#endif
 }
 
 
 bool CmdInterpreter::AddCommandSet(CommandSet* commandSet)
 {
 	CommandSets[CommandSetCount++] = commandSet;
+
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	_VerbsChanged = true;
+#endif
+
 	return true;
 }
 
@@ -73,10 +106,171 @@ bool CmdInterpreter::AddMacro(const char* name, const char* content)
 			Log::LogInfo(PRM("AddMacro: Adding Macro '"), name, "'");
 	}
 
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	_VerbsChanged = true;
+#endif
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	DiscardScript(name);
+#endif
+
 	return Macros.Add(name, content);
 }
 
 
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+
+VerbIndexEntry* CmdInterpreter::AddVerb(const char* name, uint32_t hash, uint8_t kind)
+{
+	// Add 'name', which mustn't be in the verb index already, if there's room (the index is never more than half full).
+	if ((strlen(name) >= ARDJACK_MAX_NAME_LENGTH) || (_VerbCount >= ARDJACK_VERB_INDEX_SIZE / 2))
+		return NULL;
+
+	// Linear probing.
+	int i = hash & (ARDJACK_VERB_INDEX_SIZE - 1);
+
+	while (_Verbs[i].Kind != ARDJACK_VERB_KIND_NONE)
+		i = (i + 1) & (ARDJACK_VERB_INDEX_SIZE - 1);
+
+	VerbIndexEntry* entry = &_Verbs[i];
+	entry->Command = NULL;
+	entry->Hash = hash;
+	entry->Kind = kind;
+	entry->Macro = -1;
+	strcpy(entry->Name, name);
+	entry->Set = NULL;
+
+	_VerbCount++;
+
+	return entry;
+}
+
+#endif
+
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+
+bool CmdInterpreter::Compile(const char* multiLine, CmdScript* script)
+{
+	// Compile 'multiLine' onto the end of 'script', splitting it into commands just as 'Execute' does.
+	if (Utils::StringStartsWith(multiLine, Globals::CommentPrefix))
+		return true;
+
+	if (strlen(Globals::CommandSeparator) == 0)
+		return CompileCommand(multiLine, script);
+
+	if (Utils::StringStartsWith(multiLine, Globals::OneCommandPrefix))
+	{
+		const char* start = Utils::FindFirstNonWhitespace(multiLine + 1);
+		return CompileCommand(start, script);
+	}
+
+	// TEMPORARY: only using first character of Command Separator.
+	char sep = Globals::CommandSeparator[0];
+
+	if (NULL == strchr(multiLine, (int)sep))
+	{
+		// 'multiLine' is a single command.
+		return CompileCommand(multiLine, script);
+	}
+
+	// Split 'multiLine' into separate commands and compile them.
+	char temp[ARDJACK_MAX_COMMAND_LENGTH];
+
+	strcpy(temp, multiLine);
+	char command[ARDJACK_MAX_COMMAND_LENGTH];
+
+	script->Single = false;
+
+	while (strlen(temp) > 0)
+	{
+		if (!Utils::GetFirstField(temp, sep, command, ARDJACK_MAX_COMMAND_LENGTH, true))
+			break;
+
+		if (!CompileCommand(command, script))
+			return false;
+	}
+
+	return true;
+}
+
+
+bool CmdInterpreter::CompileCommand(const char* line, CmdScript* script)
+{
+	// Compile the single command 'line' onto the end of 'script', resolving its verb if it's a command.
+	if (strlen(line) == 0)
+		return true;
+
+	if (Utils::StringStartsWith(line, Globals::CommentPrefix))
+		return true;
+
+	char verb[40];
+	const char* remainder = NULL;
+
+	Utils::GetArgs(line, verb, &remainder);
+
+	if (strlen(verb) == 0)
+		return true;
+
+	// Commands are only ever added, and the first Command Set's wins, so a command stays resolved. Any other verb is
+	// looked up when it runs, as Macros and objects come and go.
+	for (int i = 0; i < CommandSetCount; i++)
+	{
+		CommandInfo* info = CommandSets[i]->Lookup(verb);
+
+		if (NULL != info)
+			return script->Add(line, verb, remainder, CommandSets[i], info);
+	}
+
+	return script->Add(line, verb, remainder, NULL, NULL);
+}
+
+#endif
+
+
+int CmdInterpreter::CountCommands()
+{
+	// Returns the no.of commands in all Command Sets.
+	int result = 0;
+
+	for (int i = 0; i < CommandSetCount; i++)
+		result += CommandSets[i]->Count();
+
+	return result;
+}
+
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+
+void CmdInterpreter::DiscardScript(const char* name)
+{
+	// Discard the compiled form of Macro 'name' (if any), deleting it once it stops running.
+	CmdScript* previous = NULL;
+
+	for (CmdScript* script = _Scripts; NULL != script; script = script->Next)
+	{
+		if (Utils::StringEquals(script->Name, name))
+		{
+			if (NULL == previous)
+				_Scripts = script->Next;
+			else
+				previous->Next = script->Next;
+
+			if (script->Running > 0)
+				script->Discarded = true;
+			else
+				delete script;
+
+			return;
+		}
+
+		previous = script;
+	}
+}
+
+#endif
+
+
 bool CmdInterpreter::Execute(const char* multiLine)
 {
 	if (Utils::StringStartsWith(multiLine, Globals::CommentPrefix))
@@ -140,27 +334,25 @@ bool CmdInterpreter::ExecuteCommand(const char* line)
 	if (strlen(verb) == 0)
 		return true;
 
+	return ExecuteCommand2(line, verb, remainder);
+}
+
+
+bool CmdInterpreter::ExecuteCommand2(const char* line, const char* verb, const char* remainder)
+{
+	// Execute command 'line', already split into 'verb' and 'remainder'.
 	if (CommandSetCount == 0)
 	{
 		Log::LogWarning(PRM("Interpreter has no Command Set: "), line);
 		return false;
 	}
 
-	// Do we recognise this command?
-	for (int i = 0; i < CommandSetCount; i++)
-	{
-		if (CommandSets[i]->Handle(line, verb, remainder))
-			return true;
-	}
+	// Is it a command or a Macro?
+	bool handled;
+	bool result = ExecuteVerb(line, verb, remainder, &handled);
 
-	if (Globals::Verbosity > 7)
-		Log::LogInfo(PRM("Not handled by CommandSet(s): '"), verb, "'");
-
-	// Is it a Macro?
-	const char* content = LookupMacro(verb);
-
-	if (NULL != content)
-		return ExecuteMacro(verb, content, remainder);
+	if (handled)
+		return result;
 
 	// Is it an Object name, or 'Device.Part' syntax?
 	bool saveLogIncludeMemory = Log::IncludeMemory;
@@ -188,10 +380,172 @@ bool CmdInterpreter::ExecuteMacro(const char* name, const char* content, const c
 	if (Globals::Verbosity > 2)
 		Log::LogInfo(PRM("ExecuteMacro: '"), name, "'");
 
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	CmdScript* script = GetScript(name, content);
+
+	if (NULL != script)
+		return ExecuteScript(script);
+#endif
+
 	return Execute(content);
 }
 
 
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+
+bool CmdInterpreter::ExecuteScript(CmdScript* script)
+{
+	// Execute 'script'. As with 'Execute', the result is the command's if the Script is a single command, otherwise true.
+	bool result = true;
+	script->Running++;
+
+	for (int i = 0; i < script->Count; i++)
+	{
+		ScriptInstruction* instruction = &script->Instructions[i];
+		const char* line = script->Text + instruction->Line;
+		const char* args = (instruction->Args < 0) ? NULL : script->Text + instruction->Args;
+
+		if (Globals::Verbosity > 2)
+			Log::LogInfo(PRM("Command: '"), line, "'");
+
+		if (NULL != instruction->Command)
+		{
+			instruction->Set->Execute(instruction->Command, args);
+			result = true;
+		}
+		else
+			result = ExecuteCommand2(line, script->Text + instruction->Verb, args);
+	}
+
+	script->Running--;
+
+	if (!script->Single)
+		result = true;
+
+	if (script->Discarded && (script->Running == 0))
+		delete script;
+
+	return result;
+}
+
+#endif
+
+
+bool CmdInterpreter::ExecuteVerb(const char* line, const char* verb, const char* remainder, bool* handled)
+{
+	// If 'verb' is a command or a Macro, execute it and set 'handled'.
+	*handled = true;
+
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	VerbIndexEntry* entry = LookupVerb(verb);
+
+	if (NULL != entry)
+	{
+		switch (entry->Kind)
+		{
+		case ARDJACK_VERB_KIND_COMMAND:
+			entry->Set->Execute(entry->Command, remainder);
+			return true;
+
+		case ARDJACK_VERB_KIND_MACRO:
+			return ExecuteMacro(verb, Macros.Values.Get(entry->Macro), remainder);
+		}
+
+		*handled = false;
+		return false;
+	}
+#endif
+
+	// Do we recognise this command?
+	for (int i = 0; i < CommandSetCount; i++)
+	{
+		if (CommandSets[i]->Handle(line, verb, remainder))
+			return true;
+	}
+
+	if (Globals::Verbosity > 7)
+		Log::LogInfo(PRM("Not handled by CommandSet(s): '"), verb, "'");
+
+	// Is it a Macro?
+	const char* content = LookupMacro(verb);
+
+	if (NULL != content)
+		return ExecuteMacro(verb, content, remainder);
+
+	*handled = false;
+
+	return false;
+}
+
+
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+
+VerbIndexEntry* CmdInterpreter::FindVerb(const char* name, uint32_t hash)
+{
+	// Returns the verb index's entry for 'name' (case-insensitive), or NULL.
+	int i = hash & (ARDJACK_VERB_INDEX_SIZE - 1);
+
+	while (_Verbs[i].Kind != ARDJACK_VERB_KIND_NONE)
+	{
+		if ((_Verbs[i].Hash == hash) && Utils::StringEquals(_Verbs[i].Name, name))
+			return &_Verbs[i];
+
+		i = (i + 1) & (ARDJACK_VERB_INDEX_SIZE - 1);
+	}
+
+	return NULL;
+}
+
+#endif
+
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+
+CmdScript* CmdInterpreter::GetScript(const char* name, const char* content)
+{
+	// Returns the compiled form of Macro 'name', compiling 'content' if it hasn't been compiled with the current command
+	// syntax and commands, or NULL if it can't be.
+	int commands = CountCommands();
+	uint32_t hash = Utils::HashText(name);
+
+	for (CmdScript* script = _Scripts; NULL != script; script = script->Next)
+	{
+		if ((script->Hash == hash) && Utils::StringEquals(script->Name, name))
+		{
+			if (script->IsCurrent(commands))
+				return script;
+
+			DiscardScript(name);
+			break;
+		}
+	}
+
+	if (strlen(name) >= ARDJACK_MAX_NAME_LENGTH)
+		return NULL;
+
+	CmdScript* script = new CmdScript();
+	script->Hash = hash;
+	strcpy(script->Name, name);
+	script->SetSyntax(commands);
+
+	if (!Compile(content, script))
+	{
+		delete script;
+		return NULL;
+	}
+
+	if (Globals::Verbosity > 4)
+		Log::LogInfoF(PRM("GetScript: Compiled Macro '%s', %d commands"), name, script->Count);
+
+	script->Next = _Scripts;
+	_Scripts = script;
+
+	return script;
+}
+
+#endif
+
+
 const char* CmdInterpreter::LookupMacro(const char* name)
 {
 	const char* result = Macros.Get(name);
@@ -207,6 +561,100 @@ const char* CmdInterpreter::LookupMacro(const char* name)
 }
 
 
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+
+VerbIndexEntry* CmdInterpreter::LookupVerb(const char* name)
+{
+	// Returns the verb index's entry for 'name' - a command, a Macro or a verb already known to be neither - or NULL if
+	// the index can't say.
+	int commands = CountCommands();
+
+	if (_VerbsChanged || (commands != _IndexedCommands))
+		RebuildVerbs();
+
+	if (!_VerbsComplete)
+		return NULL;
+
+	uint32_t hash = Utils::HashText(name);
+	VerbIndexEntry* entry = FindVerb(name, hash);
+
+	if (NULL != entry)
+		return entry;
+
+	// It's neither a command nor a Macro, so remember that (starting afresh when the index fills up).
+	entry = AddVerb(name, hash, ARDJACK_VERB_KIND_UNKNOWN);
+
+	if ((NULL == entry) && (_VerbCount >= ARDJACK_VERB_INDEX_SIZE / 2))
+		_VerbsChanged = true;
+
+	return entry;
+}
+
+
+void CmdInterpreter::RebuildVerbs()
+{
+	// Index every command, then every Macro. As when they're searched in turn, the first Command Set's command hides
+	// any later one of the same name, and a command hides a Macro.
+	for (int i = 0; i < ARDJACK_VERB_INDEX_SIZE; i++)
+		_Verbs[i].Kind = ARDJACK_VERB_KIND_NONE;
+
+	_IndexedCommands = 0;
+	_VerbCount = 0;
+	_VerbsChanged = false;
+	_VerbsComplete = true;
+
+	for (int i = 0; i < CommandSetCount; i++)
+	{
+		CommandSet* set = CommandSets[i];
+
+		for (int j = 0; j < set->Count(); j++)
+		{
+			CommandInfo* info = set->Get(j);
+			uint32_t hash = Utils::HashText(info->Name);
+			_IndexedCommands++;
+
+			if (NULL != FindVerb(info->Name, hash))
+				continue;
+
+			VerbIndexEntry* entry = AddVerb(info->Name, hash, ARDJACK_VERB_KIND_COMMAND);
+
+			if (NULL == entry)
+			{
+				_VerbsComplete = false;
+				continue;
+			}
+
+			entry->Command = info;
+			entry->Set = set;
+		}
+	}
+
+	for (int i = 0; i < Macros.Count(); i++)
+	{
+		const char* name = Macros.Keys.Get(i);
+		uint32_t hash = Utils::HashText(name);
+
+		if (NULL != FindVerb(name, hash))
+			continue;
+
+		VerbIndexEntry* entry = AddVerb(name, hash, ARDJACK_VERB_KIND_MACRO);
+
+		if (NULL == entry)
+		{
+			_VerbsComplete = false;
+			continue;
+		}
+
+		entry->Macro = i;
+	}
+
+	if (Globals::Verbosity > 4)
+		Log::LogInfoF(PRM("RebuildVerbs: %d commands and Macros, complete %d"), _VerbCount, _VerbsComplete);
+}
+
+#endif
+
+
 bool CmdInterpreter::RemoveMacro(const char* name, bool quiet)
 {
 	if (!Macros.ContainsKey(name))
@@ -218,6 +666,14 @@ bool CmdInterpreter::RemoveMacro(const char* name, bool quiet)
 
 	Macros.Remove(name);
 
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	_VerbsChanged = true;
+#endif
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	DiscardScript(name);
+#endif
+
 	return true;
 }
 
@@ -34,13 +34,55 @@
 #include "Dictionary.h"
 #include "Globals.h"
 
+class CmdScript;
 class CommandSet;
+struct CommandInfo;
+
+
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+
+// A verb in the Interpreter's verb index.
+struct VerbIndexEntry
+{
+	CommandInfo* Command;
+	uint32_t Hash;
+	uint8_t Kind;														// enumeration: ARDJACK_VERB_KIND_COMMAND etc.
+	int Macro;															// index in 'Macros'
+	char Name[ARDJACK_MAX_NAME_LENGTH];
+	CommandSet* Set;													// the Command Set of 'Command'
+};
+
+#endif
 
 
 
 class CmdInterpreter
 {
 protected:
+#ifdef ARDJACK_INCLUDE_VERB_INDEX
+	int _IndexedCommands;												// commands in all Command Sets when the index was built
+	bool _VerbsChanged;													// must '_Verbs' be rebuilt?
+	bool _VerbsComplete;												// does '_Verbs' hold every command and Macro?
+	int _VerbCount;														// used slots in '_Verbs'
+	VerbIndexEntry _Verbs[ARDJACK_VERB_INDEX_SIZE];						// open-addressed index of commands, Macros and unknown verbs
+
+	virtual VerbIndexEntry* AddVerb(const char* name, uint32_t hash, uint8_t kind);
+	virtual VerbIndexEntry* FindVerb(const char* name, uint32_t hash);
+	virtual VerbIndexEntry* LookupVerb(const char* name);
+	virtual void RebuildVerbs();
+#endif
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	CmdScript* _Scripts;												// compiled Macros
+
+	virtual bool CompileCommand(const char* line, CmdScript* script);
+	virtual void DiscardScript(const char* name);
+	virtual CmdScript* GetScript(const char* name, const char* content);
+#endif
+
+	virtual int CountCommands();
+	virtual bool ExecuteCommand2(const char* line, const char* verb, const char* remainder);
+	virtual bool ExecuteVerb(const char* line, const char* verb, const char* remainder, bool* handled);
 
 public:
 	uint8_t CommandSetCount;
@@ -52,9 +94,15 @@ public:
 
 	bool AddCommandSet(CommandSet* commandSet);
 	bool AddMacro(const char* name, const char* content);
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	bool Compile(const char* multiLine, CmdScript* script);
+#endif
 	bool Execute(const char* multiLine);
 	bool ExecuteCommand(const char* line);
 	bool ExecuteMacro(const char* name, const char* content, const char* remainder);
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+	bool ExecuteScript(CmdScript* script);
+#endif
 	const char* LookupMacro(const char* name);
 	bool RemoveMacro(const char* name, bool quiet = false);
 };
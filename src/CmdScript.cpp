@@ -0,0 +1,171 @@
+/*
+	CmdScript.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+
+#include "CmdScript.h"
+#include "Log.h"
+#include "Utils.h"
+
+
+
+CmdScript::CmdScript()
+{
+	_InstructionsSize = 0;
+	_TextSize = 0;
+
+	CommandSeparator[0] = NULL;
+	Commands = 0;
+	CommentPrefix[0] = NULL;
+	Count = 0;
+	Discarded = false;
+	Hash = 0;
+	Instructions = NULL;
+	Name[0] = NULL;
+	Next = NULL;
+	OneCommandPrefix[0] = NULL;
+	Running = 0;
+	Single = true;
+	Text = NULL;
+	TextLength = 0;
+}
+
+
+CmdScript::~CmdScript()
+{
+	if (NULL != Instructions)
+		Utils::MemFree(Instructions);
+
+	if (NULL != Text)
+		Utils::MemFree(Text);
+}
+
+
+bool CmdScript::Add(const char* line, const char* verb, const char* remainder, CommandSet* set, CommandInfo* command)
+{
+	// Add command line 'line', already split into 'verb' and 'remainder' (which points into 'line', or is NULL).
+	if (Count >= _InstructionsSize)
+	{
+		int newSize = (_InstructionsSize < 4) ? 4 : 2 * _InstructionsSize;
+		ScriptInstruction* newInstructions = (ScriptInstruction*)Utils::MemMalloc(newSize * sizeof(ScriptInstruction));
+
+		if (NULL == newInstructions)
+		{
+			Log::LogError(PRM("CmdScript::Add: Out of memory"));
+			return false;
+		}
+
+		if (NULL != Instructions)
+		{
+			memcpy(newInstructions, Instructions, Count * sizeof(ScriptInstruction));
+			Utils::MemFree(Instructions);
+		}
+
+		Instructions = newInstructions;
+		_InstructionsSize = newSize;
+	}
+
+	ScriptInstruction* instruction = &Instructions[Count];
+	instruction->Line = AddText(line, strlen(line));
+	instruction->Verb = AddText(verb, strlen(verb));
+
+	if ((instruction->Line < 0) || (instruction->Verb < 0))
+		return false;
+
+	instruction->Args = (NULL == remainder) ? -1 : instruction->Line + (int)(remainder - line);
+	instruction->Command = command;
+	instruction->Set = set;
+
+	Count++;
+
+	return true;
+}
+
+
+int CmdScript::AddText(const char* text, int length)
+{
+	// Append 'length' characters of 'text' to 'Text', returning their offset, or -1.
+	int newLength = TextLength + length + 1;
+
+	if (newLength > _TextSize)
+	{
+		int newSize = (newLength < 32) ? 32 : (int)(1.5 * newLength);
+		char* newText = (char*)Utils::MemMalloc(newSize);
+
+		if (NULL == newText)
+		{
+			Log::LogError(PRM("CmdScript::AddText: Out of memory"));
+			return -1;
+		}
+
+		if (NULL != Text)
+		{
+			memcpy(newText, Text, TextLength);
+			Utils::MemFree(Text);
+		}
+
+		Text = newText;
+		_TextSize = newSize;
+	}
+
+	int result = TextLength;
+	memcpy(Text + result, text, length);
+	Text[result + length] = NULL;
+	TextLength = newLength;
+
+	return result;
+}
+
+
+bool CmdScript::IsCurrent(int commands)
+{
+	// Was this Script compiled with the current command syntax and 'commands' commands?
+	return (commands == Commands) &&
+		(strcmp(CommandSeparator, Globals::CommandSeparator) == 0) &&
+		(strcmp(CommentPrefix, Globals::CommentPrefix) == 0) &&
+		(strcmp(OneCommandPrefix, Globals::OneCommandPrefix) == 0);
+}
+
+
+void CmdScript::SetSyntax(int commands)
+{
+	// Record the command syntax, and the no.of commands, used to compile this Script.
+	Commands = commands;
+	strcpy(CommandSeparator, Globals::CommandSeparator);
+	strcpy(CommentPrefix, Globals::CommentPrefix);
+	strcpy(OneCommandPrefix, Globals::OneCommandPrefix);
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+	CmdScript.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_SCRIPTS
+
+class CommandSet;
+struct CommandInfo;
+
+
+
+// A compiled command line.
+struct ScriptInstruction
+{
+	int Args;															// offset of the arguments in the Script's 'Text', or -1
+	CommandInfo* Command;												// the resolved command, or NULL if the verb is looked up when it runs
+	int Line;															// offset of the command line in 'Text'
+	CommandSet* Set;													// the Command Set of 'Command'
+	int Verb;															// offset of the verb in 'Text'
+};
+
+
+
+// A list of compiled command lines, e.g. a Macro's content.
+class CmdScript
+{
+protected:
+	int _InstructionsSize;												// allocated length of 'Instructions'
+	int _TextSize;														// allocated length of 'Text'
+
+	int AddText(const char* text, int length);
+
+public:
+	char CommandSeparator[6];											// 'Globals::CommandSeparator' when compiled
+	int Commands;														// commands in the Interpreter's Command Sets when compiled
+	char CommentPrefix[4];												// 'Globals::CommentPrefix' when compiled
+	int Count;
+	bool Discarded;														// delete it when it stops running?
+	uint32_t Hash;														// hash of 'Name'
+	ScriptInstruction* Instructions;
+	char Name[ARDJACK_MAX_NAME_LENGTH];									// the Macro's name
+	CmdScript* Next;													// next in the Interpreter's list of compiled Macros
+	char OneCommandPrefix[4];											// 'Globals::OneCommandPrefix' when compiled
+	int Running;														// runs in progress (Macros can nest)
+	bool Single;														// a single command, whose result is the Script's?
+	char* Text;
+	int TextLength;														// used length of 'Text'
+
+	CmdScript();
+	~CmdScript();
+
+	bool Add(const char* line, const char* verb, const char* remainder, CommandSet* set, CommandInfo* command);
+	bool IsCurrent(int commands);
+	void SetSyntax(int commands);
+};
+
+#endif
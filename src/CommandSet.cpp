@@ -159,6 +159,36 @@ CommandInfo* CommandSet::AddCommand(const char* name, CommandSetCallback callbac
 }
 
 
+int CommandSet::Count()
+{
+	return _CommandCount;
+}
+
+
+bool CommandSet::Execute(CommandInfo* info, const char* args)
+{
+	// Execute command 'info', which must be one of this Command Set's.
+	bool (CommandSet::*pCallback)(const char* args) = info->Callback;
+
+	if (pCallback == &CommandSet::command_nyi)
+	{
+		Log::LogWarning("NOT YET IMPLEMENTED:", info->Name);
+		return true;
+	}
+
+	return (*this.*pCallback)(args);
+}
+
+
+CommandInfo* CommandSet::Get(int index)
+{
+	if ((index < 0) || (index >= _CommandCount))
+		return NULL;
+
+	return _Commands[index];
+}
+
+
 bool CommandSet::Handle(const char* line, const char* verb, const char* remainder)
 {
 	if (_CommandCount == 0)
@@ -168,33 +198,34 @@ bool CommandSet::Handle(const char* line, const char* verb, const char* remainde
 	}
 
 	// Is this command in '_Commands'?
-	if (strlen(verb) >= ARDJACK_MAX_VERB_LENGTH)
+	CommandInfo* info = Lookup(verb);
+
+	if (NULL == info)
 		return false;
 
+	Execute(info, remainder);
+
+	return true;
+}
+
+
+CommandInfo* CommandSet::Lookup(const char* verb)
+{
+	// Returns the command called 'verb' (case-insensitive), or NULL.
+	if (strlen(verb) >= ARDJACK_MAX_VERB_LENGTH)
+		return NULL;
+
 	char ucVerb[ARDJACK_MAX_VERB_LENGTH];
 	strcpy(ucVerb, verb);
 	_strupr(ucVerb);
 
-	bool (CommandSet::*pCallback)(const char* args);
-
 	for (int i = 0; i < _CommandCount; i++)
 	{
-		CommandInfo* info = _Commands[i];
-
-		if (strcmp(ucVerb, info->Name) == 0)
-		{
-			pCallback = info->Callback;
-
-			if (pCallback == &CommandSet::command_nyi)
-				Log::LogWarning("NOT YET IMPLEMENTED:", ucVerb);
-			else
-				(*this.*pCallback)(remainder);
-
-			return true;
-		}
+		if (strcmp(ucVerb, _Commands[i]->Name) == 0)
+			return _Commands[i];
 	}
 
-	return false;
+	return NULL;
 }
 
 
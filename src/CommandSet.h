@@ -104,6 +104,10 @@ public:
 	~CommandSet();
 
 	CommandInfo* AddCommand(const char* name, CommandSetCallback callback);
+	int Count();
+	bool Execute(CommandInfo* info, const char* args);
+	CommandInfo* Get(int index);
 	bool Handle(const char* line, const char* verb, const char* remainder);
+	CommandInfo* Lookup(const char* verb);
 };
 
@@ -31,41 +31,42 @@
 #endif
 
 #include "ConfigProp.h"
+#include "ConfigSchema.h"
 #include "Globals.h"
 #include "Log.h"
-#include "StringList.h"
 #include "Utils.h"
 
 
 
 
-ConfigProp::ConfigProp()
+void ConfigProp::Clear()
 {
-	_Strings = new StringList(40);
+	// Free the value (there's no constructor or destructor, as a Configuration keeps its properties in one block).
+	if (NULL != String)
+	{
+		Utils::MemFree(String);
+		String = NULL;
+	}
 
-	DataType = ARDJACK_DATATYPE_BOOLEAN;
-	//Parent = NULL;
-	Value_Boolean = false;
-	Value_Integer = 0;
 	Value_Real = 0.0;
 }
 
 
-ConfigProp::~ConfigProp()
+uint8_t ConfigProp::DataType()
 {
-	delete _Strings;
+	return Def->DataType;
 }
 
 
 const char* ConfigProp::Description()
 {
-	return _Strings->Get(1);
+	return Def->Description;
 }
 
 
 bool ConfigProp::GetAsBoolean(bool* value)
 {
-	switch (DataType)
+	switch (Def->DataType)
 	{
 	case ARDJACK_DATATYPE_BOOLEAN:
 		*value = Value_Boolean;
@@ -90,7 +91,7 @@ bool ConfigProp::GetAsBoolean(bool* value)
 
 bool ConfigProp::GetAsInteger(int* value)
 {
-	switch (DataType)
+	switch (Def->DataType)
 	{
 	case ARDJACK_DATATYPE_BOOLEAN:
 		*value = Value_Boolean ? 1 : 0;
@@ -115,7 +116,7 @@ bool ConfigProp::GetAsInteger(int* value)
 
 bool ConfigProp::GetAsReal(double* value)
 {
-	switch (DataType)
+	switch (Def->DataType)
 	{
 	case ARDJACK_DATATYPE_BOOLEAN:
 		*value = Value_Boolean ? 1 : 0;
@@ -140,7 +141,7 @@ bool ConfigProp::GetAsReal(double* value)
 
 bool ConfigProp::GetAsString(char* value)
 {
-	switch (DataType)
+	switch (Def->DataType)
 	{
 	case ARDJACK_DATATYPE_BOOLEAN:
 		strcpy(value, Utils::Bool2yesno(Value_Boolean));
@@ -165,7 +166,7 @@ bool ConfigProp::GetAsString(char* value)
 
 const char* ConfigProp::Name()
 {
-	return _Strings->Get(0);
+	return Def->Name;
 }
 
 
@@ -189,21 +190,9 @@ const char* ConfigProp::Name()
 //}
 
 
-bool ConfigProp::SetDescription(const char* value)
-{
-	return _Strings->Put(1, value);
-}
-
-
-bool ConfigProp::SetName(const char* value)
-{
-	return _Strings->Put(0, value);
-}
-
-
 bool ConfigProp::SetFromString(const char* value)
 {
-	switch (DataType)
+	switch (Def->DataType)
 	{
 	case ARDJACK_DATATYPE_BOOLEAN:
 		Value_Boolean = Utils::String2Bool(value, Value_Boolean);
@@ -218,7 +207,23 @@ bool ConfigProp::SetFromString(const char* value)
 		break;
 
 	case ARDJACK_DATATYPE_STRING:
-		_Strings->Put(3, value);
+		{
+			// Reuse the buffer if it's big enough.
+			int size = Utils::StringLen(value) + 1;
+
+			if ((NULL == String) || (size > Utils::StringLen(String) + 1))
+			{
+				char* newString = (char*)Utils::MemMalloc(size);
+				if (NULL == newString) return false;
+
+				if (NULL != String)
+					Utils::MemFree(String);
+
+				String = newString;
+			}
+
+			strcpy(String, value);
+		}
 		break;
 	}
 
@@ -226,20 +231,14 @@ bool ConfigProp::SetFromString(const char* value)
 }
 
 
-bool ConfigProp::SetUnit(const char* value)
-{
-	return _Strings->Put(2, value);
-}
-
-
 const char* ConfigProp::StringValue()
 {
-	return _Strings->Get(3);
+	return (NULL == String) ? "" : String;
 }
 
 
 const char* ConfigProp::Unit()
 {
-	return _Strings->Get(2);
+	return Def->Unit;
 }
 
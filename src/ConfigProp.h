@@ -36,37 +36,33 @@
 
 #include "Globals.h"
 
-class StringList;
+struct ConfigPropDef;
 
 
 
+// A Configuration property's value. Its name, description, unit and data type are shared, in 'Def'.
 class ConfigProp
 {
-protected:
-	StringList* _Strings;													// [0] Name, [1] Description, [2] Unit, [3] Value
-
 public:
-	uint8_t DataType;														// enumeration ARDJACK_DATATYPE_BOOLEAN etc.
-	//ConfigProp* Parent;
-	bool Value_Boolean;
-	long Value_Integer;
-	double Value_Real;
-
-	ConfigProp();
-	~ConfigProp();
-
-	virtual const char* Description();
-	virtual bool GetAsBoolean(bool* value);
-	virtual bool GetAsInteger(int* value);
-	virtual bool GetAsReal(double* value);
-	virtual bool GetAsString(char* value);
-	virtual const char* Name();
-	//virtual char* Path(char* out);
-	virtual bool SetDescription(const char* value);
-	virtual bool SetFromString(const char* value);
-	virtual bool SetName(const char* value);
-	virtual bool SetUnit(const char* value);
-	virtual const char* StringValue();
-	virtual const char* Unit();
+	const ConfigPropDef* Def;
+	char* String;														// the value, if it's a string (or NULL)
+
+	union
+	{
+		bool Value_Boolean;
+		long Value_Integer;
+		double Value_Real;
+	};
+
+	void Clear();
+	uint8_t DataType();													// enumeration ARDJACK_DATATYPE_BOOLEAN etc.
+	const char* Description();
+	bool GetAsBoolean(bool* value);
+	bool GetAsInteger(int* value);
+	bool GetAsReal(double* value);
+	bool GetAsString(char* value);
+	const char* Name();
+	bool SetFromString(const char* value);
+	const char* StringValue();
+	const char* Unit();
 };
-
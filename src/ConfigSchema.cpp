@@ -0,0 +1,182 @@
+/*
+	ConfigSchema.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "ConfigSchema.h"
+#include "Globals.h"
+#include "Log.h"
+#include "Utils.h"
+
+
+
+ConfigSchema ConfigSchema::Root;
+
+
+
+ConfigSchema::ConfigSchema()
+{
+	_Children = NULL;
+	_Next = NULL;
+
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+	_Index = NULL;
+#endif
+
+	Count = 0;
+	Def.DataType = ARDJACK_DATATYPE_BOOLEAN;
+	Def.Description = "";
+	Def.Name = "";
+	Def.Unit = "";
+	Parent = NULL;
+}
+
+
+ConfigSchema::~ConfigSchema()
+{
+	// Schemas are shared, so they live as long as the program.
+}
+
+
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+
+bool ConfigSchema::BuildIndex()
+{
+	// Sort the properties by name (case-insensitive), for 'Lookup'.
+	if ((NULL != _Index) || (Count == 0))
+		return true;
+
+	ConfigIndexEntry* index = (ConfigIndexEntry*)Utils::MemMalloc(Count * sizeof(ConfigIndexEntry));
+	if (NULL == index) return false;
+
+	// Insertion sort, walking back from the last property.
+	int used = 0;
+
+	for (ConfigSchema* schema = this; schema->Count > 0; schema = schema->Parent)
+	{
+		int i = used++;
+
+		while ((i > 0) && (stricmp(index[i - 1].Name, schema->Def.Name) > 0))
+		{
+			index[i] = index[i - 1];
+			i--;
+		}
+
+		index[i].Index = schema->Count - 1;
+		index[i].Name = schema->Def.Name;
+	}
+
+	_Index = index;
+
+	return true;
+}
+
+#endif
+
+
+ConfigSchema* ConfigSchema::Extend(const char* name, int dataType, const char* desc, const char* unit)
+{
+	// Returns the schema that adds property 'name' to this one, creating it the first time it's needed.
+	for (ConfigSchema* child = _Children; NULL != child; child = child->_Next)
+	{
+		if (child->Matches(name, dataType, desc, unit))
+			return child;
+	}
+
+	// Keep the strings in one block.
+	int nameSize = Utils::StringLen(name) + 1;
+	int descSize = Utils::StringLen(desc) + 1;
+	int unitSize = Utils::StringLen(unit) + 1;
+
+	char* block = (char*)Utils::MemMalloc(nameSize + descSize + unitSize);
+	if (NULL == block) return NULL;
+
+	ConfigSchema* result = new ConfigSchema();
+	result->Count = Count + 1;
+	result->Def.DataType = dataType;
+	result->Def.Name = strcpy(block, name);
+	result->Def.Description = strcpy(block + nameSize, desc);
+	result->Def.Unit = strcpy(block + nameSize + descSize, unit);
+	result->Parent = this;
+
+	result->_Next = _Children;
+	_Children = result;
+
+	if (Globals::Verbosity > 7)
+		Log::LogInfoF(PRM("ConfigSchema::Extend: '%s', %d properties"), name, result->Count);
+
+	return result;
+}
+
+
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+
+bool ConfigSchema::Lookup(const char* name, int* index)
+{
+	// Binary search for property 'name' (case-insensitive), setting 'index' to its index, or -1. Returns false if
+	// there's no index to search.
+	*index = -1;
+
+	if (!BuildIndex())
+		return false;
+
+	int low = 0;
+	int high = Count - 1;
+
+	while (low <= high)
+	{
+		int mid = (low + high) / 2;
+		int compare = stricmp(name, _Index[mid].Name);
+
+		if (compare == 0)
+		{
+			*index = _Index[mid].Index;
+			break;
+		}
+
+		if (compare < 0)
+			high = mid - 1;
+		else
+			low = mid + 1;
+	}
+
+	return true;
+}
+
+#endif
+
+
+bool ConfigSchema::Matches(const char* name, int dataType, const char* desc, const char* unit)
+{
+	// Does 'Def' describe this property exactly?
+	return (Def.DataType == dataType) && (strcmp(Def.Name, name) == 0) && (strcmp(Def.Description, desc) == 0) &&
+		(strcmp(Def.Unit, unit) == 0);
+}
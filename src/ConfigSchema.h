@@ -0,0 +1,96 @@
+/*
+	ConfigSchema.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+	#include "DetectBoard.h"
+#else
+	#include "stdafx.h"
+#endif
+
+#include <stdint.h>
+
+#include "Globals.h"
+
+
+
+// The shared description of a Configuration property.
+struct ConfigPropDef
+{
+	uint8_t DataType;													// enumeration ARDJACK_DATATYPE_BOOLEAN etc.
+	const char* Description;
+	const char* Name;
+	const char* Unit;
+};
+
+
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+
+// A property in a schema's index.
+struct ConfigIndexEntry
+{
+	uint8_t Index;														// in the schema's properties
+	const char* Name;
+};
+
+#endif
+
+
+
+// The shared properties of every Configuration built by the same sequence of 'Add' calls, e.g. every UDP Connection.
+// Schemas form a tree: each one extends its parent by one property, 'Def'.
+class ConfigSchema
+{
+protected:
+	ConfigSchema* _Children;											// first schema that extends this one
+	ConfigSchema* _Next;												// next schema that extends '_Parent'
+
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+	ConfigIndexEntry* _Index;											// the properties, sorted by name
+#endif
+
+	virtual bool Matches(const char* name, int dataType, const char* desc, const char* unit);
+
+public:
+	uint8_t Count;														// no.of properties, including 'Def'
+	ConfigPropDef Def;
+	ConfigSchema* Parent;
+
+	static ConfigSchema Root;											// no properties
+
+	ConfigSchema();
+	~ConfigSchema();
+
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+	virtual bool BuildIndex();
+#endif
+	virtual ConfigSchema* Extend(const char* name, int dataType, const char* desc, const char* unit);
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+	virtual bool Lookup(const char* name, int* index);
+#endif
+};
@@ -31,6 +31,7 @@
 #endif
 
 #include "ConfigProp.h"
+#include "ConfigSchema.h"
 #include "Configuration.h"
 #include "Globals.h"
 #include "Log.h"
@@ -41,26 +42,28 @@
 
 Configuration::Configuration()
 {
+	_PropSize = 0;
+
 	strcpy(Name, "");
 	PropCount = 0;
-
-	for (int i = 0; i < ARDJACK_MAX_CONFIG_PROPERTIES; i++)
-		Properties[i] = NULL;
+	Properties = NULL;
+	Schema = &ConfigSchema::Root;
 }
 
 
 Configuration::~Configuration()
 {
-	for (int i = 0; i < ARDJACK_MAX_CONFIG_PROPERTIES; i++)
-	{
-		if (NULL != Properties[i])
-			delete Properties[i];
-	}
+	for (int i = 0; i < PropCount; i++)
+		Properties[i].Clear();
+
+	if (NULL != Properties)
+		Utils::MemFree(Properties);
 }
 
 
 ConfigProp* Configuration::Add(const char* name, int dataType, const char* desc, const char* unit)
 {
+	// Add a property, or change an existing one. The result is only valid until the next 'Add'.
 	char temp[102];
 
 	ConfigProp* result = LookupPath(name);
@@ -70,10 +73,26 @@ ConfigProp* Configuration::Add(const char* name, int dataType, const char* desc,
 		sprintf(temp, PRM("Reusing existing Configuration property '%s'"), result->Name());
 		Log::LogInfo(temp);
 
-		result->DataType = dataType;
-		//result->Parent = NULL;
-		result->SetDescription(desc);
-		result->SetUnit(unit);
+		// Switch to the schema with the changed property.
+		int index = (int)(result - Properties);
+		ConfigSchema* schema = &ConfigSchema::Root;
+
+		for (int i = 0; i < PropCount; i++)
+		{
+			const ConfigPropDef* def = Properties[i].Def;
+
+			if (i == index)
+				schema = schema->Extend(def->Name, dataType, desc, unit);
+			else
+				schema = schema->Extend(def->Name, def->DataType, def->Description, def->Unit);
+
+			if (NULL == schema) return NULL;
+		}
+
+		if (result->DataType() != dataType)
+			result->Clear();
+
+		SetSchema(schema);
 
 		return result;
 	}
@@ -88,20 +107,35 @@ ConfigProp* Configuration::Add(const char* name, int dataType, const char* desc,
 	}
 
 	// Create a new property.
-	result = Properties[PropCount];
+	ConfigSchema* schema = Schema->Extend(name, dataType, desc, unit);
+	if (NULL == schema) return NULL;
 
-	if (NULL == result)
+	if (PropCount >= _PropSize)
 	{
-		result = new ConfigProp();
-		Properties[PropCount] = result;
+		int newSize = (_PropSize < 4) ? 4 : 2 * _PropSize;
+
+		if (newSize > ARDJACK_MAX_CONFIG_PROPERTIES)
+			newSize = ARDJACK_MAX_CONFIG_PROPERTIES;
+
+		ConfigProp* newProperties = (ConfigProp*)Utils::MemMalloc(newSize * sizeof(ConfigProp));
+		if (NULL == newProperties) return NULL;
+
+		if (NULL != Properties)
+		{
+			memcpy(newProperties, Properties, PropCount * sizeof(ConfigProp));
+			Utils::MemFree(Properties);
+		}
+
+		Properties = newProperties;
+		_PropSize = newSize;
 	}
 
-	PropCount++;
+	result = &Properties[PropCount++];
+	result->Def = &schema->Def;
+	result->String = NULL;
+	result->Value_Real = 0.0;
 
-	result->SetName(name);
-	result->DataType = dataType;
-	result->SetDescription(desc);
-	result->SetUnit(unit);
+	Schema = schema;
 
 	return result;
 }
@@ -173,6 +207,17 @@ bool Configuration::GetAsBoolean(const char* path, bool* value)
 }
 
 
+bool Configuration::GetAsBoolean(ConfigHandle* handle, bool* value)
+{
+	value[0] = NULL;
+
+	ConfigProp* prop = Resolve(handle);
+	if (NULL == prop) return false;
+
+	return prop->GetAsBoolean(value);
+}
+
+
 bool Configuration::GetAsInteger(const char* path, int* value)
 {
 	value[0] = NULL;
@@ -184,6 +229,17 @@ bool Configuration::GetAsInteger(const char* path, int* value)
 }
 
 
+bool Configuration::GetAsInteger(ConfigHandle* handle, int* value)
+{
+	value[0] = NULL;
+
+	ConfigProp* prop = Resolve(handle);
+	if (NULL == prop) return false;
+
+	return prop->GetAsInteger(value);
+}
+
+
 bool Configuration::GetAsReal(const char* path, double* value)
 {
 	value[0] = NULL;
@@ -195,6 +251,17 @@ bool Configuration::GetAsReal(const char* path, double* value)
 }
 
 
+bool Configuration::GetAsReal(ConfigHandle* handle, double* value)
+{
+	value[0] = NULL;
+
+	ConfigProp* prop = Resolve(handle);
+	if (NULL == prop) return false;
+
+	return prop->GetAsReal(value);
+}
+
+
 bool Configuration::GetAsString(const char* path, char* value)
 {
 	value[0] = NULL;
@@ -206,6 +273,17 @@ bool Configuration::GetAsString(const char* path, char* value)
 }
 
 
+bool Configuration::GetAsString(ConfigHandle* handle, char* value)
+{
+	value[0] = NULL;
+
+	ConfigProp* prop = Resolve(handle);
+	if (NULL == prop) return false;
+
+	return prop->GetAsString(value);
+}
+
+
 bool Configuration::GetSizes(int *nameSize, int *valueSize, int *descSize)
 {
 	*nameSize = Utils::StringLen("Name");
@@ -217,7 +295,7 @@ bool Configuration::GetSizes(int *nameSize, int *valueSize, int *descSize)
 
 	for (int i = 0; i < PropCount; i++)
 	{
-		ConfigProp* prop = Properties[i];
+		ConfigProp* prop = &Properties[i];
 
 		// Check the Name size.
 		if (Utils::StringLen(prop->Name()) > *nameSize)
@@ -231,7 +309,7 @@ bool Configuration::GetSizes(int *nameSize, int *valueSize, int *descSize)
 		prop->GetAsString(value);
 		temp[0] = NULL;
 
-		if (prop->DataType == ARDJACK_DATATYPE_STRING)
+		if (prop->DataType() == ARDJACK_DATATYPE_STRING)
 		{
 			strcat(temp, "'");
 			strcat(temp, value);
@@ -281,12 +359,12 @@ bool Configuration::LogIt()
 
 	for (int i = 0; i < PropCount; i++)
 	{
-		ConfigProp* prop = Properties[i];
+		ConfigProp* prop = &Properties[i];
 		temp[0] = NULL;
 
 		prop->GetAsString(value);
 
-		if (prop->DataType == ARDJACK_DATATYPE_STRING)
+		if (prop->DataType() == ARDJACK_DATATYPE_STRING)
 		{
 			strcat(temp, "'");
 			strcat(temp, value);
@@ -315,12 +393,19 @@ bool Configuration::LogIt()
 
 ConfigProp* Configuration::LookupPath(const char* path)
 {
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+	int index;
+
+	if (Schema->Lookup(path, &index))
+		return (index < 0) ? NULL : &Properties[index];
+#endif
+
 	ConfigProp* result = NULL;
 	//char temp[200];
 
 	for (int i = 0; i < PropCount; i++)
 	{
-		ConfigProp* prop = Properties[i];
+		ConfigProp* prop = &Properties[i];
 
 		//if (Utils::StringEquals(prop->Path(temp), path))
 		if (Utils::StringEquals(prop->Name(), path))
@@ -334,6 +419,25 @@ ConfigProp* Configuration::LookupPath(const char* path)
 }
 
 
+ConfigProp* Configuration::Resolve(ConfigHandle* handle)
+{
+	// Returns the property 'handle' refers to, or NULL. Looks it up by name only if it hasn't been resolved, or was
+	// resolved against a different schema.
+	if ((NULL != handle->Def) && (handle->Index < PropCount) && (Properties[handle->Index].Def == handle->Def))
+		return &Properties[handle->Index];
+
+	ConfigProp* result = LookupPath(handle->Name);
+
+	if (NULL != result)
+	{
+		handle->Def = result->Def;
+		handle->Index = (uint8_t)(result - Properties);
+	}
+
+	return result;
+}
+
+
 bool Configuration::SetFromString(const char* name, const char* value)
 {
 	ConfigProp* item = LookupPath(name);
@@ -343,31 +447,29 @@ bool Configuration::SetFromString(const char* name, const char* value)
 }
 
 
-int SortItemsCompare(const void* a, const void* b)
+bool Configuration::SetSchema(ConfigSchema* schema)
 {
-	// Thanks to:
-	//		https://stackoverflow.com/questions/23689687/sorting-an-array-of-struct-pointers-using-qsort
-
-	ConfigProp* itemA = *(ConfigProp**)a;
-	char nameA[ARDJACK_MAX_NAME_LENGTH];
-	strcpy(nameA, itemA->Name());
+	// Use 'schema', which has a property for each of 'Properties' in turn.
+	Schema = schema;
 
-	ConfigProp* itemB = *(ConfigProp**)b;
-	char nameB[ARDJACK_MAX_NAME_LENGTH];
-	strcpy(nameB, itemB->Name());
+	for (int i = PropCount - 1; i >= 0; i--)
+	{
+		Properties[i].Def = &schema->Def;
+		schema = schema->Parent;
+	}
 
-#ifdef ARDUINO
-	return strcasecmp(nameA, nameB);
-#else
-	return stricmp(nameA, nameB);
-#endif
+	return true;
 }
 
 
 bool Configuration::SortItems()
 {
-	//qsort(Properties, PropCount, sizeof(ConfigProp*), SortItemsCompare);
-
+	// The properties stay in the order they were added; 'LookupPath' uses the schema's index, sorted by name, which
+	// is built here (or when first needed) and shared by every Configuration with this schema.
+#ifdef ARDJACK_INCLUDE_CONFIG_INDEX
+	return Schema->BuildIndex();
+#else
 	return true;
+#endif
 }
 
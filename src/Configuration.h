@@ -35,6 +35,21 @@
 #include "Globals.h"
 
 class ConfigProp;
+class ConfigSchema;
+struct ConfigPropDef;
+
+
+
+// A reference to a Configuration property that can be cached, e.g. by a class for all its instances - it's
+// resolved by name the first time, then again only for a Configuration with a different schema.
+struct ConfigHandle
+{
+	const char* Name;
+	const ConfigPropDef* Def;											// NULL = not resolved yet
+	uint8_t Index;														// in 'Properties'
+
+	ConfigHandle(const char* name) : Name(name), Def(NULL), Index(0) {}
+};
 
 
 
@@ -42,12 +57,16 @@ class ConfigProp;
 class Configuration
 {
 protected:
+	uint8_t _PropSize;													// allocated length of 'Properties'
+
 	virtual bool GetSizes(int *nameSize, int *valueSize, int *descSize);
+	virtual bool SetSchema(ConfigSchema* schema);
 
 public:
 	char Name[ARDJACK_MAX_NAME_LENGTH];
 	uint8_t PropCount;
-	ConfigProp* Properties[ARDJACK_MAX_CONFIG_PROPERTIES];
+	ConfigProp* Properties;												// the values, in the order of 'Schema'
+	ConfigSchema* Schema;												// the shared property names, descriptions etc.
 
 	Configuration();
 	~Configuration();
@@ -59,11 +78,16 @@ public:
 	virtual ConfigProp* AddRealProp(const char* name, const char* desc, double value = 0.0, const char* unit = "");
 	virtual ConfigProp* AddStringProp(const char* name, const char* desc, const char* value = "", const char* unit = "");
 	virtual bool GetAsBoolean(const char* path, bool* value);
+	virtual bool GetAsBoolean(ConfigHandle* handle, bool* value);
 	virtual bool GetAsInteger(const char* path, int* value);
+	virtual bool GetAsInteger(ConfigHandle* handle, int* value);
 	virtual bool GetAsReal(const char* path, double* value);
+	virtual bool GetAsReal(ConfigHandle* handle, double* value);
 	virtual bool GetAsString(const char* path, char* value);
+	virtual bool GetAsString(ConfigHandle* handle, char* value);
 	virtual bool LogIt();
 	virtual ConfigProp* LookupPath(const char* path);
+	virtual ConfigProp* Resolve(ConfigHandle* handle);
 	virtual bool SetFromString(const char* path, const char* value);
 	virtual bool SortItems();
 };
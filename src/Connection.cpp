@@ -38,6 +38,7 @@
 #include "IoTMessage.h"
 #include "IoTObject.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Route.h"
 #include "Utils.h"
 
@@ -48,52 +49,131 @@ Connection::Connection(const char* name)
 {
 	_CanInput = true;
 	_CanOutput = false;
+	_CoalesceSequence = 0;
 	_CommandPrefix[0] = NULL;
 	_CommentPrefix[0] = NULL;
 	_InputAnnounce = false;
 	strcpy(_InputEncodingType, "ascii");
 	_OutputAnnounce = false;
 	strcpy(_OutputEncodingType, "ascii");
+	_RoutesChanged = true;
 	_WarnUnhandled = true;
 
+	Coalesced = 0;
 	DefaultRoute = NULL;
+	DroppedMessages = 0;
+	DroppedNewest = 0;
+	DroppedOldest = 0;
+	OutputLatencyLastUs = 0;
+	OutputLatencyMaxUs = 0;
+	OutputLatencyTotalUs = 0.0;
+	OutputQueue = NULL;
+#ifdef ARDUINO
+#else
+	OutputQueueUsers = 0;
+#endif
+	OutputQueueSize = ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS;
+	OutputSent = 0;
+	OverflowPolicy = ARDJACK_OUTPUT_OVERFLOW_DROP_NEWEST;
+	RetiredOutputQueue = NULL;
+	RoutedMessages = 0;
 	RouteCount = 0;
+	RxBatchLast = 0;
+	RxBatchMax = 0;
 	RxCount = 0;
 	RxEvents = 0;
+	RxPolls = 0;
 	TxCount = 0;
+	TxDatagrams = 0;
 	TxEvents = 0;
+	TxFlushes = 0;
+	UnroutedMessages = 0;
+
+	for (int i = 0; i < ARDJACK_MAX_COALESCE_KEYS; i++)
+	{
+		_CoalesceKeys[i] = 0;
+		_CoalesceSequences[i] = 0;
+	}
 
 	for (int i = 0; i < ARDJACK_MAX_INPUT_ROUTES; i++)
 		Routes[i] = NULL;
+
+#ifdef ARDJACK_LINUX
+	if (NULL != Globals::ConnectionMgr)
+		Globals::ConnectionMgr->Generation++;
+#endif
 }
 
 
 Connection::~Connection()
 {
 	ClearRoutes();
+
+#ifdef ARDJACK_LINUX
+	if (NULL != Globals::ConnectionMgr)
+		Globals::ConnectionMgr->Generation++;
+#endif
+
+	if (NULL != OutputQueue)
+	{
+		if (NULL != Globals::ConnectionMgr)
+			Globals::ConnectionMgr->RemoveOutputQueue(this);
+
+		delete OutputQueue;
+	}
+
+	if (NULL != RetiredOutputQueue)
+		delete RetiredOutputQueue;
 }
 
 
 bool Connection::Activate()
 {
+	static ConfigHandle canInputHandle = { "CanInput" };
+	static ConfigHandle canOutputHandle = { "CanOutput" };
+	static ConfigHandle commandPrefixHandle = { "CommandPrefix" };
+	static ConfigHandle commentPrefixHandle = { "CommentPrefix" };
+	static ConfigHandle inAnnounceHandle = { "InAnnounce" };
+	static ConfigHandle outAnnounceHandle = { "OutAnnounce" };
+	static ConfigHandle outputQueueHandle = { "OutputQueue" };
+	static ConfigHandle warnUnhandledHandle = { "WarnUnhandled" };
+	static ConfigHandle defaultRouteHandle = { "DefaultRoute" };
+	static ConfigHandle overflowHandle = { "Overflow" };
+
 	if (Globals::Verbosity > 2)
 		Log::LogInfo(PRM("Connection::Activate: '"), Name, "'");
 
 	if (!IoTObject::Activate()) return false;
 
-	Config->GetAsBoolean("CanInput", &_CanInput);
-	Config->GetAsBoolean("CanOutput", &_CanOutput);
-	Config->GetAsString("CommandPrefix", _CommandPrefix);
-	Config->GetAsString("CommentPrefix", _CommentPrefix);
-	Config->GetAsBoolean("InAnnounce", &_InputAnnounce);
-	Config->GetAsBoolean("OutAnnounce", &_OutputAnnounce);
-	Config->GetAsBoolean("WarnUnhandled", &_WarnUnhandled);
+	Config->GetAsBoolean(&canInputHandle, &_CanInput);
+	Config->GetAsBoolean(&canOutputHandle, &_CanOutput);
+	Config->GetAsString(&commandPrefixHandle, _CommandPrefix);
+	Config->GetAsString(&commentPrefixHandle, _CommentPrefix);
+	Config->GetAsBoolean(&inAnnounceHandle, &_InputAnnounce);
+	Config->GetAsBoolean(&outAnnounceHandle, &_OutputAnnounce);
+	Config->GetAsInteger(&outputQueueHandle, &OutputQueueSize);
+	Config->GetAsBoolean(&warnUnhandledHandle, &_WarnUnhandled);
 
 	char temp[ARDJACK_MAX_NAME_LENGTH];
-	Config->GetAsString("DefaultRoute", temp);
+	Config->GetAsString(&defaultRouteHandle, temp);
 
 	DefaultRoute = LookupRoute(temp);
 
+	Config->GetAsString(&overflowHandle, temp);
+
+	if (Utils::StringEquals(temp, PRM("Coalesce")))
+		OverflowPolicy = ARDJACK_OUTPUT_OVERFLOW_COALESCE;
+	else if (Utils::StringEquals(temp, PRM("DropOldest")))
+		OverflowPolicy = ARDJACK_OUTPUT_OVERFLOW_DROP_OLDEST;
+	else
+		OverflowPolicy = ARDJACK_OUTPUT_OVERFLOW_DROP_NEWEST;
+
+	// A new session - the peers may have restarted.
+	_MessagePaths.Clear();
+
+	if (!Globals::ConnectionMgr->AddOutputQueue(this))
+		return false;
+
 	return true;
 }
 
@@ -110,6 +190,8 @@ bool Connection::AddConfig()
 	Config->AddStringProp(PRM("DefaultRoute"), PRM("Default route."), "");
 	Config->AddBooleanProp(PRM("InAnnounce"), PRM("Announce each input?"), _InputAnnounce);
 	Config->AddBooleanProp(PRM("OutAnnounce"), PRM("Announce each output?"), _OutputAnnounce);
+	Config->AddIntegerProp(PRM("OutputQueue"), PRM("Output queue size."), OutputQueueSize, PRM("items"));
+	Config->AddStringProp(PRM("Overflow"), PRM("Output overflow policy (Coalesce | DropNewest | DropOldest)."), PRM("DropNewest"));
 	Config->AddBooleanProp(PRM("WarnUnhandled"), PRM("Warn on each unhandled input?"), _WarnUnhandled);
 
 	return Config->SortItems();
@@ -118,8 +200,17 @@ bool Connection::AddConfig()
 
 Route *Connection::AddRoute(Route* route)
 {
-	if (NULL != route)
-		Routes[RouteCount++] = route;
+	if (NULL == route)
+		return NULL;
+
+	if (RouteCount >= ARDJACK_MAX_INPUT_ROUTES)
+	{
+		Log::LogErrorF(PRM("Connection::AddRoute: %s, too many Routes - can't add '%s'"), Name, route->Name);
+		return NULL;
+	}
+
+	Routes[RouteCount++] = route;
+	_RoutesChanged = true;
 
 	return route;
 }
@@ -132,6 +223,12 @@ Route* Connection::AddRoute(const char* name, int type, FifoBuffer *buffer, cons
 
 	if (NULL == result)
 	{
+		if (RouteCount >= ARDJACK_MAX_INPUT_ROUTES)
+		{
+			Log::LogErrorF(PRM("Connection::AddRoute: %s, too many Routes - can't add '%s'"), Name, name);
+			return NULL;
+		}
+
 		result = new Route(name);
 		Routes[RouteCount++] = result;
 
@@ -156,6 +253,9 @@ Route* Connection::AddRoute(const char* name, int type, FifoBuffer *buffer, cons
 	typeFilter->Operation = ARDJACK_STRING_COMPARE_EQUALS;
 	Route::GetTypeName(result->Type, typeFilter->Text);
 
+	// The caller may change the filters further, so compile the Routes when they're next used.
+	_RoutesChanged = true;
+
 	return result;
 }
 
@@ -166,6 +266,7 @@ bool Connection::AlwaysUseRoute(const char* name, bool state)
 	if (NULL == route) return false;
 
 	route->AlwaysUse = state;
+	_RoutesChanged = true;
 
 	return true;
 }
@@ -202,12 +303,29 @@ bool Connection::ClearRoutes()
 		}
 	}
 
+	DefaultRoute = NULL;
 	RouteCount = 0;
+	_RoutesChanged = true;
 
 	return true;
 }
 
 
+uint32_t Connection::CoalesceKey(uint32_t key)
+{
+	// Note that the next output queued with 'key' supersedes any still queued, returning its sequence number.
+	// Called by one thread at a time, e.g. that polling the Devices for notifications.
+	int slot = key % ARDJACK_MAX_COALESCE_KEYS;
+	uint32_t sequence = ++_CoalesceSequence;
+
+	// Write the key first - a reader seeing it with the slot's previous sequence number won't coalesce wrongly.
+	_CoalesceKeys[slot] = key;
+	_CoalesceSequences[slot] = sequence;
+
+	return sequence;
+}
+
+
 bool Connection::ConfigureProperty(const char* propName, const char* propValue, const char* text)
 {
 	// Check for special cases like:
@@ -225,6 +343,8 @@ bool Connection::ConfigureRoute(const char* propName, const char* propValue, con
 	// E.g.
 	//		configure udp0 Routes.Commands.Filter.Text.Operation=true
 
+	_RoutesChanged = true;
+
 	StringList fields;
 	int count = Utils::SplitText(propName, '.', &fields, 10, 100);
 
@@ -314,6 +434,36 @@ bool Connection::ConfigureRoute(const char* propName, const char* propValue, con
 }
 
 
+bool Connection::FlushQueuedOutput()
+{
+	// Send anything gathered by 'SendQueuedOutput' (called when the output queues have been drained).
+	// By default, 'SendQueuedOutput' sends immediately, so there's nothing to do.
+	return true;
+}
+
+
+#ifdef ARDJACK_LINUX
+
+int Connection::InputHandle()
+{
+	// A file descriptor that becomes readable when input is waiting, or -1 if there isn't one.
+	return -1;
+}
+
+#endif
+
+
+bool Connection::IsSuperseded(uint32_t key, uint32_t sequence)
+{
+	// Has an output with 'key' been queued since the one with 'sequence' (see 'CoalesceKey')?
+	// Read the sequence number first, so a slot being reused for another key can't pass as newer.
+	int slot = key % ARDJACK_MAX_COALESCE_KEYS;
+	uint32_t latest = _CoalesceSequences[slot];
+
+	return (_CoalesceKeys[slot] == key) && ((int32_t)(latest - sequence) > 0);
+}
+
+
 Route* Connection::LookupRoute(const char* name, bool quiet)
 {
 	if (strlen(name) == 0)
@@ -354,8 +504,27 @@ int Connection::LookupRouteIndex(const char* name, bool quiet)
 bool Connection::OutputMessage(IoTMessage* msg)
 {
 	// Output 'msg'.
-	// Default action is to output the message 'wire text'.
-	return OutputText(msg->WireText());
+	// Default action is to output the message 'wire text', queueing it with its coalescing key (if it has one).
+	if (0 == msg->Key)
+		return OutputText(msg->WireText());
+
+	if (!_Active)
+	{
+		Log::LogError(PRM("Connection::OutputMessage: '"), Name, PRM("' is not active"));
+		return false;
+	}
+
+	return Globals::ConnectionMgr->QueueOutput(this, msg->WireText(), msg->Key);
+}
+
+
+MessagePathTable* Connection::OutputPaths(uint32_t* peer)
+{
+	// Get the format 2 paths for messages sent by this Connection, and set 'peer' to their recipient.
+	// By default, a Connection has a single peer.
+	*peer = 0;
+
+	return &_MessagePaths;
 }
 
 
@@ -368,7 +537,7 @@ bool Connection::OutputText(const char* text)
 		return false;
 	}
 
-	// Default action is to queue the text in the shared output buffer.
+	// Default action is to queue the text in this Connection's output queue.
 	return Globals::ConnectionMgr->QueueOutput(this, text);
 }
 
@@ -407,8 +576,9 @@ bool Connection::PollOutputs(int maxCount)
 }
 
 
-bool Connection::ProcessInput(const char* text)
+bool Connection::ProcessInput(const char* text, uint32_t peer)
 {
+	// 'peer' identifies the sender, if this Connection has several (see 'OutputPaths').
 	bool handled = false;
 
 	// Blank line?
@@ -419,13 +589,26 @@ bool Connection::ProcessInput(const char* text)
 	if (Utils::StringStartsWith(text, _CommentPrefix))
 		return true;
 
-	_InputMsg.Decode(text);
+#ifdef ARDJACK_INCLUDE_METRICS
+	unsigned long startUs = Utils::NowUs();
+#endif
+
+	if (!_InputMsg.Decode(text, &_MessagePaths, peer))
+	{
+		DroppedMessages++;
+		return false;
+	}
 
 	if (Globals::Verbosity > 6)
 		_InputMsg.LogIt();
 
 	RouteInputMessage(&_InputMsg, &handled);
 
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Items[ARDJACK_METRIC_CONNECTION_RX].Add();
+	Metrics::Items[ARDJACK_METRIC_CONNECTION_ROUTE].Record(Utils::NowUs() - startUs);
+#endif
+
 	if (!handled)
 	{
 		Log::LogItemF(_WarnUnhandled ? ARDJACK_LOG_WARNING : ARDJACK_LOG_INFO,
@@ -436,6 +619,16 @@ bool Connection::ProcessInput(const char* text)
 }
 
 
+void Connection::ReleaseOutputQueue()
+{
+	// The caller has finished with the queue from 'UseOutputQueue'.
+#ifdef ARDUINO
+#else
+	OutputQueueUsers--;
+#endif
+}
+
+
 bool Connection::RemoveRoute(const char* name)
 {
 	int index = LookupRouteIndex(name);
@@ -444,12 +637,17 @@ bool Connection::RemoveRoute(const char* name)
 		Log::LogWarningF(PRM("Connection::RemoveRoute: '%s' has no Route '%s'"), Name, name);
 	else
 	{
+		if (DefaultRoute == Routes[index])
+			DefaultRoute = NULL;
+
 		delete Routes[index];
 
 		for (int i = index; i < RouteCount - 1; i++)
 			Routes[i] = Routes[i + 1];
 
 		RouteCount--;
+		Routes[RouteCount] = NULL;
+		_RoutesChanged = true;
 	}
 
 	return true;
@@ -460,28 +658,40 @@ bool Connection::RouteInputMessage(IoTMessage* msg, bool* routed)
 {
 	*routed = false;
 
-	char computer[ARDJACK_MAX_NAME_LENGTH] = "";
-	char resource[ARDJACK_MAX_NAME_LENGTH] = "";
-
 	// Ignore messages that have a 'To' path not to this machine.
-	if (strlen(msg->ToPath()) > 0)
+	// The computer name is compared in place, i.e. 'computer' in '\\computer\resource'.
+	const char* toPath = msg->ToPath();
+	bool toThisComputer = false;
+
+	if ((toPath[0] == '\\') && (toPath[1] == '\\'))
 	{
-		Utils::DecodeNetworkPath(msg->ToPath(), computer, resource);
+		const char* computer = toPath + 2;
+		int length = 0;
 
-		if ((strlen(computer) > 0) && !Utils::StringEquals(computer, Globals::ComputerName))
+		while ((computer[length] != NULL) && (computer[length] != '\\'))
+			length++;
+
+		if (length > 0)
 		{
-			if (Globals::Verbosity > 4)
+			toThisComputer = Utils::StringEqualsN(computer, Globals::ComputerName, length);
+
+			if (!toThisComputer)
 			{
-				Log::LogInfoF(PRM("Connection::RouteInputMessage: '%s' ignored message to another computer: '%s'"),
-					Name, msg->WireText());
-			}
+				if (Globals::Verbosity > 4)
+				{
+					Log::LogInfoF(PRM("Connection::RouteInputMessage: '%s' ignored message to another computer: '%s'"),
+						Name, msg->WireText());
+				}
 
-			return true;
+				DroppedMessages++;
+
+				return true;
+			}
 		}
 	}
 
 	// Ignore messages from this machine.
-	if ((strlen(msg->FromPath()) > 0) && Utils::StringEquals(msg->FromPath(), Globals::FromName))
+	if ((msg->FromPath()[0] != NULL) && Utils::StringEquals(msg->FromPath(), Globals::FromName))
 	{
 		if (Globals::Verbosity > 3)
 		{
@@ -489,12 +699,16 @@ bool Connection::RouteInputMessage(IoTMessage* msg, bool* routed)
 				Name, msg->WireText());
 		}
 
+		DroppedMessages++;
+
 		return true;
 	}
 
 	if (RouteCount == 0)
 	{
 		Log::LogInfoF(PRM("Connection::RouteInputMessage: '%s' ignored message (no routes): '%s'"), Name, msg->Text());
+		DroppedMessages++;
+
 		return true;
 	}
 
@@ -520,6 +734,55 @@ bool Connection::RouteInputMessage(IoTMessage* msg, bool* routed)
 
 	if (!*routed || !stopped)
 	{
+#ifdef ARDJACK_INCLUDE_ROUTE_TABLE
+		// Look up the candidate Routes for 'msg', then use them in order.
+		if (_RoutesChanged)
+		{
+			_RouteTable.Compile(Routes, RouteCount);
+			_RoutesChanged = false;
+		}
+
+		RouteMask candidates = _RouteTable.Lookup(msg);
+		bool cleaned = false;
+
+		for (int i = 0; (i < RouteCount) && ((candidates >> i) != 0); i++)
+		{
+			Route* route = Routes[i];
+
+			if (route->AlwaysUse || ((candidates & ((RouteMask)1 << i)) == 0))
+				continue;
+
+			// Generic Routes are evaluated in full, as is every Route once the text has been cleaned (the lookup used
+			// the original text).
+			bool evaluated = cleaned || _RouteTable.IsGeneric(i);
+
+			if (evaluated && !route->Filter.EvaluateMessage(msg))
+			{
+				if (Globals::Verbosity > 6)
+				{
+					Log::LogInfoF(PRM("Connection::RouteInputMessage: '%s': route '%s' ignored input message: '%s'"),
+						Name, route->Name, msg->Text());
+				}
+
+				continue;
+			}
+
+			if ((msg->Format == ARDJACK_MESSAGE_FORMAT_0) && route->Filter.TextFilter.Active())
+			{
+				if (!evaluated)
+					route->Filter.CleanMessage(msg, &route->Filter.TextFilter);
+
+				cleaned = true;
+				candidates = ~(RouteMask)0;
+			}
+
+			route->Handle(msg);
+			*routed = true;
+
+			if (route->StopOnRouted)
+				break;
+		}
+#else
 		// Try to match 'msg' to one or more Route's filters.
 		for (int i = 0; i < RouteCount; i++)
 		{
@@ -546,10 +809,14 @@ bool Connection::RouteInputMessage(IoTMessage* msg, bool* routed)
 				}
 			}
 		}
+#endif
 	}
 
 	if (*routed)
+	{
+		RoutedMessages++;
 		return true;
+	}
 
 	// 'msg' wasn't handled by any route in 'Routes'.
 
@@ -565,12 +832,15 @@ bool Connection::RouteInputMessage(IoTMessage* msg, bool* routed)
 
 		DefaultRoute->Handle(msg);
 		*routed = true;
+		RoutedMessages++;
 
 		return true;
 	}
 
 	// We couldn't handle 'msg'.
-	if (Utils::StringEquals(computer, Globals::ComputerName))
+	UnroutedMessages++;
+
+	if (toThisComputer)
 	{
 		Log::LogWarning(PRM("Connection::RouteInputMessage: '"), Name, PRM("' didn't route message to this computer: '"),
 			msg->Text(), "'");
@@ -602,3 +872,46 @@ bool Connection::SendTextQuiet(const char* text)
 	return SendText(text);
 }
 
+
+#ifdef ARDJACK_LINUX
+
+bool Connection::SetActive(bool state)
+{
+	// The host's event loop resyncs its input handles when 'Generation' changes.
+	bool result = IoTObject::SetActive(state);
+
+	if (NULL != Globals::ConnectionMgr)
+		Globals::ConnectionMgr->Generation++;
+
+	return result;
+}
+
+#endif
+
+
+FifoBuffer* Connection::UseOutputQueue()
+{
+	// Get 'OutputQueue' for use by a thread other than the flushing one, e.g. to push output to it. If the queue is
+	// resized meanwhile, the old one isn't deleted until the caller calls 'ReleaseOutputQueue' (see
+	// 'ConnectionManager::ResizeOutputQueue').
+#ifdef ARDUINO
+#else
+	OutputQueueUsers++;
+#endif
+
+	return OutputQueue;
+}
+
+
+void Connection::UpdateRxBatchStats(int count)
+{
+	// Record the number of inputs received by a single poll.
+	if (count <= 0)
+		return;
+
+	RxBatchLast = count;
+	RxPolls++;
+
+	if (count > RxBatchMax)
+		RxBatchMax = count;
+}
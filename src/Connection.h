@@ -29,10 +29,14 @@
 	#include <arduino.h>
 #else
 	#include "stdafx.h"
+
+	#include <atomic>
 #endif
 
 #include "IoTMessage.h"
 #include "IoTObject.h"
+#include "MessagePathTable.h"
+#include "RouteTable.h"
 
 class FifoBuffer;
 class Route;
@@ -44,28 +48,61 @@ class Connection : public IoTObject
 protected:
 	bool _CanInput;
 	bool _CanOutput;
+	volatile uint32_t _CoalesceKeys[ARDJACK_MAX_COALESCE_KEYS];	// latest coalescing keys queued, by key hash
+	uint32_t _CoalesceSequence;								// latest sequence number used
+	volatile uint32_t _CoalesceSequences[ARDJACK_MAX_COALESCE_KEYS];	// sequence numbers for '_CoalesceKeys'
 	char _CommandPrefix[10];
 	char _CommentPrefix[10];
 	bool _InputAnnounce;
 	char _InputEncodingType[10];
 	IoTMessage _InputMsg;
+	MessagePathTable _MessagePaths;								// format 2 paths interned with each peer
 	bool _OutputAnnounce;
 	char _OutputEncodingType[10];
+	bool _RoutesChanged;										// must '_RouteTable' be recompiled?
+#ifdef ARDJACK_INCLUDE_ROUTE_TABLE
+	RouteTable _RouteTable;
+#endif
 	bool _WarnUnhandled;
 
 	virtual bool Activate() override;
 	virtual bool CheckAnnounce(bool output, const char* text);
 	virtual bool ConfigureProperty(const char* propName, const char* propValue, const char* text);
 	virtual bool ConfigureRoute(const char* propName, const char* propValue, const char* text);
+	virtual void UpdateRxBatchStats(int count);
 
 public:
+	int Coalesced;												// no.of queued outputs superseded by a newer one with the same key
 	Route* DefaultRoute;
+	int DroppedMessages;										// no.of inputs ignored (not for this computer, from it, no Routes, or undecodable)
+	int DroppedNewest;											// no.of outputs discarded because the output buffer was full
+	int DroppedOldest;											// no.of queued outputs discarded to make room for newer ones
+	unsigned long OutputLatencyLastUs;							// time the latest output sent spent queued
+	unsigned long OutputLatencyMaxUs;							// max.time an output spent queued
+	double OutputLatencyTotalUs;								// total time spent queued by 'OutputSent' outputs
+#ifdef ARDUINO
+	FifoBuffer* OutputQueue;									// queued output (see 'ConnectionManager::QueueOutput')
+#else
+	std::atomic<FifoBuffer*> OutputQueue;						// queued output (see 'ConnectionManager::QueueOutput')
+	std::atomic<int> OutputQueueUsers;							// no.of threads using 'OutputQueue' (see 'UseOutputQueue')
+#endif
+	int OutputQueueSize;										// items in 'OutputQueue' (it's resized to match when flushed)
+	long OutputSent;											// no.of outputs sent from 'OutputQueue'
+	uint8_t OverflowPolicy;										// enumeration: ARDJACK_OUTPUT_OVERFLOW_DROP_NEWEST etc.
+	FifoBuffer* RetiredOutputQueue;								// a replaced 'OutputQueue', until no thread can be using it
+	int RoutedMessages;											// no.of inputs handled by a Route
 	uint8_t RouteCount;
 	Route* Routes[ARDJACK_MAX_INPUT_ROUTES];
+	int RxBatchLast;											// no.of inputs received by the latest busy poll
+	int RxBatchMax;												// max.no.of inputs received by a single poll
 	int RxCount;
 	int RxEvents;
+	int RxPolls;												// no.of polls which received at least one input
 	int TxCount;
+	int TxDatagrams;											// no.of packets / writes used for 'TxEvents'
 	int TxEvents;
+	int TxFlushes;												// no.of batched sends of queued output
+	int UnroutedMessages;										// no.of inputs which no Route handled
 
 	Connection(const char* name);
 	~Connection();
@@ -75,18 +112,30 @@ public:
 	virtual Route* AddRoute(const char* name, int type, FifoBuffer* buffer, const char* prefix = "");
 	virtual bool AlwaysUseRoute(const char* name, bool state = true);
 	virtual bool ClearRoutes();
+	virtual uint32_t CoalesceKey(uint32_t key);
+	virtual bool FlushQueuedOutput();
+#ifdef ARDJACK_LINUX
+	virtual int InputHandle();
+#endif
+	virtual bool IsSuperseded(uint32_t key, uint32_t sequence);
 	virtual Route* LookupRoute(const char* name, bool quiet = false);
 	virtual int LookupRouteIndex(const char* name, bool quiet = false);
 	virtual bool OutputMessage(IoTMessage* msg);
+	virtual MessagePathTable* OutputPaths(uint32_t* peer);
 	virtual bool OutputText(const char* text);
 	virtual bool Poll() override;
 	virtual bool PollInputs(int maxCount = 5);
 	virtual bool PollOutputs(int maxCount = 5);
-	virtual bool ProcessInput(const char* text);
+	virtual bool ProcessInput(const char* text, uint32_t peer = 0);
+	virtual void ReleaseOutputQueue();
 	virtual bool RemoveRoute(const char* name);
 	virtual bool RouteInputMessage(IoTMessage* msg, bool* routed);
 	virtual bool SendQueuedOutput(const char* text);
 	virtual bool SendText(const char* text);
 	virtual bool SendTextQuiet(const char* text);
+#ifdef ARDJACK_LINUX
+	virtual bool SetActive(bool state) override;
+#endif
+	virtual FifoBuffer* UseOutputQueue();
 };
 
@@ -36,6 +36,7 @@
 #include "Globals.h"
 #include "IoTManager.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Route.h"
 #include "Utils.h"
 
@@ -49,13 +50,22 @@ ConnectionManager::ConnectionManager()
 		Log::LogInfo(PRM("ConnectionManager ctor"));
 
 	ObjectType = ARDJACK_OBJECT_TYPE_CONNECTION;
-	OutputBuffer = new FifoBuffer(sizeof(ConnectionOutputBufferItem), ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS);
+
+	_FlushNext = 0;
+#ifdef ARDJACK_LINUX
+	Generation = 0;
+#endif
+	OutputQueueCount = 0;
+
+	for (int i = 0; i < ARDJACK_MAX_OUTPUT_QUEUES; i++)
+		OutputQueues[i] = NULL;
 
 	if (NULL == Subtypes)
 	{
 		Subtypes = new Enumeration(PRM("Subtypes"));
 
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
 #else
 		Subtypes->Add(PRM("Clipboard"), ARDJACK_CONNECTION_SUBTYPE_CLIPBOARD);
 #endif
@@ -70,36 +80,159 @@ ConnectionManager::ConnectionManager()
 
 ConnectionManager::~ConnectionManager()
 {
-	if (NULL != OutputBuffer)
-		delete OutputBuffer;
+}
+
+
+bool ConnectionManager::AddOutputQueue(Connection* conn)
+{
+	// Give 'conn' an output queue of 'conn->OutputQueueSize' items, for 'CheckOutputBuffer' to flush with the others.
+	// An existing queue is kept - if 'OutputQueueSize' has changed, the flushing thread resizes it (see
+	// 'ResizeOutputQueue'), as it may be popping the queue right now.
+	if (conn->OutputQueueSize < 1)
+		conn->OutputQueueSize = 1;
+
+	if (NULL != conn->OutputQueue)
+		return true;
+
+	if (OutputQueueCount >= ARDJACK_MAX_OUTPUT_QUEUES)
+	{
+		Log::LogErrorF(PRM("ConnectionManager::AddOutputQueue: %s, too many output queues"), conn->Name);
+		return false;
+	}
+
+	conn->OutputQueue = new FifoBuffer(sizeof(ConnectionOutputBufferItem), conn->OutputQueueSize);
+	OutputQueues[OutputQueueCount++] = conn;
+
+	return true;
 }
 
 
 bool ConnectionManager::CheckOutputBuffer()
 {
-	if ((NULL == OutputBuffer) || OutputBuffer->IsEmpty())
+	// Send the Connections' queued output round-robin, one item from each in turn, so that a busy or slow Connection
+	// can't hold up the others. Stop when the queues are empty or the drain budget (items, bytes or time) is used up,
+	// and start the next tick with the Connection after the last one served.
+	int maxCount = 0;
+
+	for (int i = 0; i < OutputQueueCount; i++)
+	{
+		Connection* conn = OutputQueues[i];
+		FifoBuffer* queue = conn->OutputQueue;
+
+		if ((queue->Capacity != conn->OutputQueueSize) && (NULL == conn->RetiredOutputQueue))
+			queue = ResizeOutputQueue(conn);
+
+		if (NULL != conn->RetiredOutputQueue)
+			RetireOutputQueue(conn);
+
+		maxCount += queue->Count();
+	}
+
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Items[ARDJACK_METRIC_OUTPUT_QUEUED].SetLevel(maxCount);
+#endif
+
+	if (maxCount == 0)
 		return true;
 
-	ConnectionOutputBufferItem item;
+	if ((Globals::DrainMaxItems > 0) && (Globals::DrainMaxItems < maxCount))
+		maxCount = Globals::DrainMaxItems;
+
+	// Connections may gather their output (see 'Connection::SendQueuedOutput'), so note which ones to flush.
+	bool flush[ARDJACK_MAX_OUTPUT_QUEUES];
+
+	for (int i = 0; i < OutputQueueCount; i++)
+		flush[i] = false;
 
-	for (int i = 0; i < 5; i++)
+	ConnectionOutputBufferItem item;
+	int bytes = 0;
+	int count = 0;
+	int empty = 0;														// consecutive empty queues
+	int index = _FlushNext;
+	long startMs = Utils::NowMs();
+
+	while ((empty < OutputQueueCount) && Globals::DrainBudgetLeft(count, maxCount, startMs) &&
+		((Globals::DrainMaxBytes == 0) || (bytes < Globals::DrainMaxBytes)))
 	{
-		if (OutputBuffer->IsEmpty() || !OutputBuffer->Pop(&item))
-			break;
+		if (index >= OutputQueueCount)
+			index = 0;
+
+		Connection* conn = OutputQueues[index];
+		FifoBuffer* queue = conn->OutputQueue;
 
-		if (item.Conn->Active())
-			item.Conn->SendQueuedOutput(item.Text);
+		if (!queue->Pop(&item, true))
+		{
+			empty++;
+			index++;
+			continue;
+		}
+
+		count++;
+		empty = 0;
+
+		if ((0 != item.Key) && conn->IsSuperseded(item.Key, item.Sequence))
+		{
+			// Skip a notification that a newer one for the same Part has superseded.
+			conn->Coalesced++;
+		}
+		else if (conn->Active())
+		{
+			conn->SendQueuedOutput(item.Text);
+			SentOutput(conn, &item);
+
+			bytes += strlen(item.Text);
+			flush[index] = true;
+		}
 		else
 		{
-			Log::LogWarning(PRM("ConnectionManager::CheckOutputBuffer: '"), item.Conn->Name,
+			Log::LogWarning(PRM("ConnectionManager::CheckOutputBuffer: '"), conn->Name,
 				PRM("' is not active - item discarded: '"), item.Text, "'");
 		}
+
+		index++;
 	}
 
+	_FlushNext = (index >= OutputQueueCount) ? 0 : index;
+
+	bool itemsLeft = false;
+
+	for (int i = 0; i < OutputQueueCount; i++)
+	{
+		if (flush[i])
+			OutputQueues[i]->FlushQueuedOutput();
+
+		FifoBuffer* queue = OutputQueues[i]->OutputQueue;
+
+		if (!queue->IsEmpty())
+			itemsLeft = true;
+	}
+
+	Globals::UpdateDrainStats(&Globals::OutputDrainStats, count, itemsLeft);
+
 	return true;
 }
 
 
+void ConnectionManager::DiscardOutput(Connection* conn, ConnectionOutputBufferItem* item)
+{
+	// Discard 'item' from the output queue of 'conn', to make room for newer output.
+	if ((0 != item->Key) && conn->IsSuperseded(item->Key, item->Sequence))
+	{
+		conn->Coalesced++;
+		return;
+	}
+
+	conn->DroppedOldest++;
+
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Items[ARDJACK_METRIC_OUTPUT_DROPPED].Add();
+#endif
+
+	if (Globals::Verbosity > 3)
+		Log::LogWarning(PRM("Queue full: discarded output queued by '"), conn->Name, PRM("': '"), item->Text, "'");
+}
+
+
 bool ConnectionManager::Interact(const char* text)
 {
 	// Add/modify/delete/reset/send (to) a Connection.
@@ -192,6 +325,20 @@ int ConnectionManager::LookupSubtype(const char* name)
 }
 
 
+void ConnectionManager::MoveOutput(Connection* conn, FifoBuffer* from)
+{
+	// Move any output queued in 'from' to the output queue of 'conn', discarding what doesn't fit.
+	FifoBuffer* queue = conn->OutputQueue;
+	ConnectionOutputBufferItem item;
+
+	while (from->Pop(&item, true))
+	{
+		if (!queue->Push(&item, true))
+			DiscardOutput(conn, &item);
+	}
+}
+
+
 void ConnectionManager::Poll()
 {
 	if (_PollBusy) return;
@@ -208,27 +355,151 @@ void ConnectionManager::Poll()
 }
 
 
-bool ConnectionManager::QueueOutput(Connection* conn, const char* text)
+bool ConnectionManager::PushOutput(Connection* conn, FifoBuffer* queue, const char* text, uint32_t key)
 {
-	if (NULL == OutputBuffer)
+	// Push 'text' to 'queue', the output queue of 'conn'.
+	if (NULL == queue)
+	{
+		Log::LogError(PRM("ConnectionManager::QueueOutput: '"), conn->Name, PRM("' has no output queue"));
 		return false;
+	}
 
 	// [type=response from=\\DELL-9020_A\win to=\\pcname\rem0] User.count 10 diskA diskB diskC diskD diskE diskF diskG diskH memFreePhys memTotalPhys
 
 	ConnectionOutputBufferItem item;
-	item.Conn = conn;
+	item.QueuedUs = Utils::NowUs();
 	strcpy(item.Text, text);
 
-	for (int i = 0; i < 10; i++)
+	// A coalescing Connection sends only the latest of the items queued with the same 'key'.
+	if ((0 != key) && (conn->OverflowPolicy == ARDJACK_OUTPUT_OVERFLOW_COALESCE))
 	{
-		if (!OutputBuffer->IsFull() && OutputBuffer->Push(&item))
-			return true;
+		item.Key = key;
+		item.Sequence = conn->CoalesceKey(key);
+	}
+
+	if (queue->Push(&item, true))
+		return true;
+
+	// The queue is full. Don't wait for it to drain (that would stall this thread's polling), but apply the
+	// Connection's overflow policy.
+	if (conn->OverflowPolicy != ARDJACK_OUTPUT_OVERFLOW_DROP_NEWEST)
+	{
+		// Discard the oldest items until this one fits. Other producers may take the room first, so give up
+		// after a queue's worth.
+		ConnectionOutputBufferItem oldItem;
+
+		for (int i = 0; i < queue->Capacity; i++)
+		{
+			if (queue->Pop(&oldItem, true))
+				DiscardOutput(conn, &oldItem);
 
-		Utils::DelayMs(200);
+			if (queue->Push(&item, true))
+				return true;
+		}
 	}
 
-	Log::LogError(PRM("Buffer full: unable to queue output from '"), conn->Name, "'");
+	conn->DroppedNewest++;
+
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Items[ARDJACK_METRIC_OUTPUT_DROPPED].Add();
+#endif
+
+	if (Globals::Verbosity > 3)
+		Log::LogWarning(PRM("Queue full: discarded output from '"), conn->Name, PRM("': '"), text, "'");
 
 	return false;
 }
 
+
+bool ConnectionManager::QueueOutput(Connection* conn, const char* text, uint32_t key)
+{
+	// Queue 'text' for output by 'conn' (see 'CheckOutputBuffer').
+	FifoBuffer* queue = conn->UseOutputQueue();
+	bool result = PushOutput(conn, queue, text, key);
+	conn->ReleaseOutputQueue();
+
+	return result;
+}
+
+
+bool ConnectionManager::RemoveOutputQueue(Connection* conn)
+{
+	// Stop flushing the output queue of 'conn' (which still owns it).
+	for (int i = 0; i < OutputQueueCount; i++)
+	{
+		if (OutputQueues[i] == conn)
+		{
+			for (int j = i; j < OutputQueueCount - 1; j++)
+				OutputQueues[j] = OutputQueues[j + 1];
+
+			OutputQueues[--OutputQueueCount] = NULL;
+
+			if (_FlushNext > i)
+				_FlushNext--;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+FifoBuffer* ConnectionManager::ResizeOutputQueue(Connection* conn)
+{
+	// Replace the output queue of 'conn' with one of 'conn->OutputQueueSize' items, keeping as much of its output as
+	// fits, and return it. The flushing thread does this, as it owns the queues; other threads push to them (and pop,
+	// to make room), so the old queue is retired rather than deleted (see 'RetireOutputQueue').
+	FifoBuffer* queue = new FifoBuffer(sizeof(ConnectionOutputBufferItem), conn->OutputQueueSize);
+
+	conn->RetiredOutputQueue = conn->OutputQueue;
+	conn->OutputQueue = queue;
+
+	MoveOutput(conn, conn->RetiredOutputQueue);
+
+	return queue;
+}
+
+
+void ConnectionManager::RetireOutputQueue(Connection* conn)
+{
+	// Move any output pushed to the retired queue of 'conn' since it was replaced, and delete it once no other thread
+	// can be using it. A thread that starts using the queue after 'ResizeOutputQueue' gets the new one, so once there
+	// are no users, there never will be.
+	FifoBuffer* retired = conn->RetiredOutputQueue;
+
+#ifdef ARDUINO
+	bool unused = true;
+#else
+	// Check before moving the output, so that nothing can be pushed to 'retired' after it's emptied.
+	bool unused = (conn->OutputQueueUsers == 0);
+#endif
+
+	MoveOutput(conn, retired);
+
+	if (unused)
+	{
+		delete retired;
+		conn->RetiredOutputQueue = NULL;
+	}
+}
+
+
+void ConnectionManager::SentOutput(Connection* conn, ConnectionOutputBufferItem* item)
+{
+	// Note how long 'item' spent in the output queue of 'conn'.
+	unsigned long latency = Utils::NowUs() - item->QueuedUs;
+
+	conn->OutputLatencyLastUs = latency;
+	conn->OutputLatencyTotalUs += latency;
+	conn->OutputSent++;
+
+	if (latency > conn->OutputLatencyMaxUs)
+		conn->OutputLatencyMaxUs = latency;
+
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Items[ARDJACK_METRIC_CONNECTION_TX].Add();
+	Metrics::Items[ARDJACK_METRIC_OUTPUT_QUEUE].Record(latency);
+#endif
+}
+
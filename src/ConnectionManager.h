@@ -36,18 +36,32 @@ class Enumeration;
 class ConnectionManager : public IoTManager
 {
 protected:
+	int _FlushNext;														// index in 'OutputQueues' of the next to flush
+
+	virtual void DiscardOutput(Connection* conn, ConnectionOutputBufferItem* item);
+	virtual void MoveOutput(Connection* conn, FifoBuffer* from);
+	virtual bool PushOutput(Connection* conn, FifoBuffer* queue, const char* text, uint32_t key);
+	virtual FifoBuffer* ResizeOutputQueue(Connection* conn);
+	virtual void RetireOutputQueue(Connection* conn);
+	virtual void SentOutput(Connection* conn, ConnectionOutputBufferItem* item);
 
 public:
-	FifoBuffer* OutputBuffer;
+#ifdef ARDJACK_LINUX
+	uint32_t Generation;												// bumped when a Connection is added, removed, activated or deactivated
+#endif
+	int OutputQueueCount;
+	Connection* OutputQueues[ARDJACK_MAX_OUTPUT_QUEUES];				// Connections with an output queue
 
 	ConnectionManager();
 	~ConnectionManager();
 
+	virtual bool AddOutputQueue(Connection* conn);
 	virtual bool CheckOutputBuffer();
 	virtual bool Interact(const char* text) override;
 	virtual Connection* LookupConnection(const char* name);
 	virtual int LookupSubtype(const char* name) override;
 	virtual void Poll() override;
-	virtual bool QueueOutput(Connection* conn, const char* text);
+	virtual bool QueueOutput(Connection* conn, const char* text, uint32_t key = 0);
+	virtual bool RemoveOutputQueue(Connection* conn);
 };
 
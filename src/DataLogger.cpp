@@ -58,10 +58,12 @@
 DataLogger::DataLogger(const char* name)
 	: IoTObject(name)
 {
-	_Connection = NULL;
+	_Connection.Generation = 0;
+	_Connection.Slot = 0;
 	_ConnectionWasActive = false;
 	strcpy(_DateFormat, "dd MM yyyy");
-	_Device = NULL;
+	_Device.Generation = 0;
+	_Device.Slot = 0;
 	_DeviceWasActive = false;
 	_FieldReplacer = new FieldReplacer();
 	_Interval = 1000;																	// ms
@@ -85,14 +87,20 @@ bool DataLogger::Activate()
 	if (!IoTObject::Activate())
 		return false;
 
+	Connection* conn;
+	Device* dev;
+
+	if (!ResolveObjects(&conn, &dev))
+		return false;
+
 	// Save the states.
-	_ConnectionWasActive = _Connection->Active();
-	_DeviceWasActive = _Device->Active();
+	_ConnectionWasActive = conn->Active();
+	_DeviceWasActive = dev->Active();
 
 	// Start.
 	_NextSampleTime = 0;
-	_Device->SetActive(true);
-	_Connection->SetActive(true);
+	dev->SetActive(true);
+	conn->SetActive(true);
 
 
 	return true;
@@ -119,23 +127,32 @@ bool DataLogger::AddConfig()
 
 bool DataLogger::ApplyConfig(bool quiet)
 {
+	static ConfigHandle dateFormatHandle = { "DateFormat" };
+	static ConfigHandle inPartsHandle = { "InParts" };
+	static ConfigHandle intervalHandle = { "Interval" };
+	static ConfigHandle outFormatHandle = { "OutFormat" };
+	static ConfigHandle prefixHandle = { "Prefix" };
+	static ConfigHandle timeFormatHandle = { "TimeFormat" };
+	static ConfigHandle inputHandle = { "Input" };
+	static ConfigHandle outputHandle = { "Output" };
+
 	if (Globals::Verbosity > 4)
 		Log::LogInfo(PRM("DataLogger::ApplyConfig"));
 
 	char inPartNames[120];
 
-	Config->GetAsString("DateFormat", _DateFormat);
-	Config->GetAsString("InParts", inPartNames);
-	Config->GetAsInteger("Interval", &_Interval);
-	Config->GetAsString("OutFormat", _OutputFormat);
-	Config->GetAsString("Prefix", _Prefix);
-	Config->GetAsString("TimeFormat", _TimeFormat);
+	Config->GetAsString(&dateFormatHandle, _DateFormat);
+	Config->GetAsString(&inPartsHandle, inPartNames);
+	Config->GetAsInteger(&intervalHandle, &_Interval);
+	Config->GetAsString(&outFormatHandle, _OutputFormat);
+	Config->GetAsString(&prefixHandle, _Prefix);
+	Config->GetAsString(&timeFormatHandle, _TimeFormat);
 
 	char name[ARDJACK_MAX_NAME_LENGTH];
 	char temp[102];
 
 	// Setup the the input (a Device).
-	Config->GetAsString("Input", name);
+	Config->GetAsString(&inputHandle, name);
 	IoTObject* obj = Globals::ObjectRegister->LookupName(name);
 
 	if ((NULL == obj) || (obj->Type != ARDJACK_OBJECT_TYPE_DEVICE))
@@ -145,13 +162,13 @@ bool DataLogger::ApplyConfig(bool quiet)
 		return false;
 	}
 
-	_Device = (Device*)obj;
+	_Device = Globals::ObjectRegister->GetHandle(obj);
 
 	// Setup the specified input Parts.
-	_Device->LookupParts(inPartNames, Parts, &PartCount);
+	((Device*)obj)->LookupParts(inPartNames, Parts, &PartCount);
 
 	// Setup the output (a Connection).
-	Config->GetAsString("Output", name);
+	Config->GetAsString(&outputHandle, name);
 	obj = Globals::ObjectRegister->LookupName(name);
 
 	if ((NULL == obj) || (obj->Type != ARDJACK_OBJECT_TYPE_CONNECTION))
@@ -161,7 +178,7 @@ bool DataLogger::ApplyConfig(bool quiet)
 		return false;
 	}
 
-	_Connection = (Connection*)obj;
+	_Connection = Globals::ObjectRegister->GetHandle(obj);
 
 	// Setup the 'FieldReplacer'.
 	strcpy(_FieldReplacer->Params.DateFormat, _DateFormat);
@@ -173,9 +190,15 @@ bool DataLogger::ApplyConfig(bool quiet)
 
 bool DataLogger::Deactivate()
 {
-	// Deactivate objects that were initially inactive.
-	_Device->SetActive(_DeviceWasActive);
-	_Connection->SetActive(_ConnectionWasActive);
+	// Deactivate objects that were initially inactive (unless they've since been deleted).
+	Connection* conn;
+	Device* dev;
+
+	if (ResolveObjects(&conn, &dev))
+	{
+		dev->SetActive(_DeviceWasActive);
+		conn->SetActive(_ConnectionWasActive);
+	}
 
 	return IoTObject::Deactivate();
 }
@@ -201,8 +224,34 @@ bool DataLogger::Poll()
 }
 
 
+bool DataLogger::ResolveObjects(Connection** conn, Device** dev)
+{
+	// The input Device and output Connection are held as handles, which go stale if either object is deleted.
+	*conn = (Connection*)Globals::ObjectRegister->Resolve(_Connection);
+	*dev = (Device*)Globals::ObjectRegister->Resolve(_Device);
+
+	if ((NULL == *conn) || (NULL == *dev))
+	{
+		Log::LogErrorF(PRM("DataLogger '%s': Input or Output has been deleted"), Name);
+		return false;
+	}
+
+	return true;
+}
+
+
 bool DataLogger::Sample()
 {
+	Connection* conn;
+	Device* dev;
+
+	if (!ResolveObjects(&conn, &dev))
+	{
+		// Stop sampling - the input Device's Parts went with it.
+		_Active = false;
+		return false;
+	}
+
 	char time[20];
 	Utils::GetTimeString(time, "");
 
@@ -230,7 +279,7 @@ bool DataLogger::Sample()
 
 		part = Parts[i];
 
-		_Device->Read(part, &value);
+		dev->Read(part, &value);
 
 		if (part->Value.IsEmpty())
 			strcpy(temp, "-");
@@ -240,7 +289,7 @@ bool DataLogger::Sample()
 		strcat(line, temp);
 	}
 
-	_Connection->OutputText(line);
+	conn->OutputText(line);
 	Events++;
 
 	return true;
@@ -51,10 +51,10 @@ class Part;
 class DataLogger : public IoTObject
 {
 protected:
-	Connection* _Connection;
+	ObjectHandle _Connection;
 	bool _ConnectionWasActive;
 	char _DateFormat[22];
-	Device* _Device;
+	ObjectHandle _Device;
 	bool _DeviceWasActive;
 	FieldReplacer* _FieldReplacer;
 	int _Interval;																// sample interval (ms)
@@ -65,10 +65,11 @@ protected:
 
 	virtual bool Activate() override;
 	virtual bool Deactivate() override;
+	virtual bool ResolveObjects(Connection** conn, Device** dev);
 
 public:
 	int Events;
-	uint8_t PartCount;
+	uint16_t PartCount;
 	Part* Parts[ARDJACK_MAX_DATALOGGER_PARTS];
 
 	DataLogger(const char* name);
@@ -32,6 +32,7 @@
 	#include <typeinfo>
 #endif
 
+#include "ArrayHelpers.h"
 #include "Connection.h"
 #include "Device.h"
 #include "DeviceCodec1.h"
@@ -43,7 +44,9 @@
 #include "IoTMessage.h"
 #include "IoTObject.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Part.h"
+#include "PartIndex.h"
 #include "PartManager.h"
 #include "Route.h"
 #include "Shield.h"
@@ -53,14 +56,23 @@
 
 
 
+// The slot of a Device Operation verb's hash (see 'LookupOperation').
+static constexpr uint8_t OperationSlot(uint32_t hash)
+{
+	return (hash >> 5) & 127;
+}
+
 
 Device::Device(const char* name)
 	: IoTObject(name)
 {
+	_BatchNotify = false;
+	_Batching = false;
 	_IsOpen = false;
 	_MessageFormat = ARDJACK_MESSAGE_FORMAT_1;
 	strcpy(_MessagePrefix, "$rem0:");
 	strcpy(_MessageToPath, "\\\\pcname\\rem0");							// a UNC-like path: "\\computer\resource"
+	_NotifyBatch[0] = NULL;
 
 #ifdef ARDJACK_INCLUDE_SHIELDS
 	DeviceShield = NULL;
@@ -130,9 +142,11 @@ bool Device::AddConfig()
 	if (Globals::Verbosity > 3)
 		Log::LogInfo(PRM("Device::AddConfig: "), Name);
 
+	Config->AddBooleanProp("BatchNotify", "Send the value changes from one input scan as one 'parts' notification?",
+		_BatchNotify);
 	Config->AddStringProp("Input", "Input Connection name.");
 	Config->AddStringProp("Output", "Output Connection name.");
-	Config->AddIntegerProp("MessageFormat", "Message format (0 or 1).", _MessageFormat);
+	Config->AddIntegerProp("MessageFormat", "Message format (0, 1 or 2).", _MessageFormat);
 	Config->AddStringProp("MessagePrefix", "Message prefix (when message format = 0).", _MessagePrefix);
 	Config->AddStringProp("MessageTo", "Message 'to' path (when message format = 1).", _MessageToPath);
 
@@ -162,6 +176,12 @@ Part* Device::AddPart(const char* name, int type, int subtype, int pin)
 	else
 	{
 		// No - create a new Part.
+		if (PartCount >= ARDJACK_MAX_PARTS)
+		{
+			Log::LogErrorF(PRM("Device::AddPart: %s: Can't add Part '%s', max.%d Parts"), Name, name, ARDJACK_MAX_PARTS);
+			return NULL;
+		}
+
 		result = Globals::PartMgr->CreatePart(name, type, subtype);
 		if (NULL == result) return NULL;
 
@@ -172,6 +192,8 @@ Part* Device::AddPart(const char* name, int type, int subtype, int pin)
 		result->Subtype = subtype;
 		result->Type = type;
 
+		_PartIndex.Add(Parts, PartCount - 1);
+
 		result->AddConfig();
 	}
 
@@ -189,15 +211,60 @@ bool Device::AddParts(const char* prefix, int count, int type, int subtype, int
 	for (int i = 0; i < count; i++)
 	{
 		sprintf(name, "%s%d", prefix, index++);
-		AddPart(name, type, subtype, pin++);
+
+		if (NULL == AddPart(name, type, subtype, pin++))
+			return false;
 	}
 
 	return true;
 }
 
 
+bool Device::AddToNotifyBatch(Part* part, const char* value)
+{
+	// Add 'part=value' to the 'parts' batch, sending the batch first if there's no room.
+	int itemLength = strlen(part->Name) + strlen(value) + 1;
+	int length = strlen(_NotifyBatch);
+
+	if ((length > 0) && ((length + itemLength + 1 > ARDJACK_MAX_NOTIFY_BATCH_LENGTH) ||
+		(itemLength > ARDJACK_MAX_NOTIFY_BATCH_LENGTH)))
+	{
+		if (!FlushNotifyBatch())
+			return false;
+
+		length = 0;
+	}
+
+	if (itemLength > ARDJACK_MAX_NOTIFY_BATCH_LENGTH)
+	{
+		// Too long for any batch - send it as a single Part notification, rather than truncate it.
+		Log::LogWarningF(PRM("%s: '%s=%s' is too long for a 'parts' notification, sending it alone"), Name,
+			part->Name, value);
+
+		return SendResponse(ARDJACK_OPERATION_READ, part->Name, value);
+	}
+
+	if (length > 0)
+		_NotifyBatch[length++] = ' ';
+
+	snprintf(_NotifyBatch + length, ARDJACK_MAX_NOTIFY_BATCH_LENGTH + 1 - length, "%s=%s", part->Name, value);
+
+	return true;
+}
+
+
 bool Device::ApplyConfig(bool quiet)
 {
+	static ConfigHandle batchNotifyHandle = { "BatchNotify" };
+	static ConfigHandle inputHandle = { "Input" };
+	static ConfigHandle messageFormatHandle = { "MessageFormat" };
+	static ConfigHandle messagePrefixHandle = { "MessagePrefix" };
+	static ConfigHandle messageToHandle = { "MessageTo" };
+	static ConfigHandle outputHandle = { "Output" };
+#ifdef ARDJACK_INCLUDE_SHIELDS
+	static ConfigHandle shieldHandle = { "Shield" };
+#endif
+
 	// N.B. DON'T call the base class as the methods may overlap.
 	if (Globals::Verbosity > 4)
 		Log::LogInfo(PRM("Device::ApplyConfig: "), Name);
@@ -205,14 +272,15 @@ bool Device::ApplyConfig(bool quiet)
 	char inputName[ARDJACK_MAX_NAME_LENGTH];
 	char outputName[ARDJACK_MAX_NAME_LENGTH];
 
-	Config->GetAsString("Input", inputName);
-	Config->GetAsInteger("MessageFormat", &_MessageFormat);
-	Config->GetAsString("MessagePrefix", _MessagePrefix);
-	Config->GetAsString("MessageTo", _MessageToPath);
-	Config->GetAsString("Output", outputName);
+	Config->GetAsBoolean(&batchNotifyHandle, &_BatchNotify);
+	Config->GetAsString(&inputHandle, inputName);
+	Config->GetAsInteger(&messageFormatHandle, &_MessageFormat);
+	Config->GetAsString(&messagePrefixHandle, _MessagePrefix);
+	Config->GetAsString(&messageToHandle, _MessageToPath);
+	Config->GetAsString(&outputHandle, outputName);
 
 #ifdef ARDJACK_INCLUDE_SHIELDS
-	Config->GetAsString("Shield", _ShieldName);
+	Config->GetAsString(&shieldHandle, _ShieldName);
 #endif
 
 	// Any input Connection specified?
@@ -237,6 +305,8 @@ bool Device::ApplyConfig(bool quiet)
 		char routeName[50];
 		sprintf(routeName, PRM("Device_%s"), Name);
 		Route* route = InputConnection->AddRoute(routeName, ARDJACK_ROUTE_TYPE_REQUEST, Globals::DeviceBuffer, "");
+		if (NULL == route) return false;
+
 		route->Target = this;
 		MessageFilter* msgFilter = &route->Filter;
 
@@ -306,6 +376,8 @@ bool Device::ClearInventory()
 	for (int i = 0; i < ARDJACK_MAX_PARTS; i++)
 		Parts[i] = NULL;
 
+	_PartIndex.Clear();
+
 	return true;
 }
 
@@ -452,12 +524,13 @@ bool Device::ConfigureParts(const char* partExpr, StringList* settings, int star
 	if (Globals::Verbosity > 3)
 		Log::LogInfoF(PRM("Device::ConfigureParts: '%s', partExpr '%s'"), Name, partExpr);
 
-	Part* parts[ARDJACK_MAX_PARTS];
-	uint8_t partCount;
+	PartSelector selector;
+	Part* part = NULL;
 
-	GetParts(partExpr, parts, &partCount);
+	if (FindParts(partExpr, &selector))
+		part = NextPart(&selector);
 
-	if (partCount == 0)
+	if (NULL == part)
 	{
 		Log::LogErrorF(PRM("%s: Neither a Part nor a Part type: '%s'"), Name, partExpr);
 		return false;
@@ -470,9 +543,9 @@ bool Device::ConfigureParts(const char* partExpr, StringList* settings, int star
 	if (!SetActive(false))
 		return false;
 
-	for (int i = 0; i < partCount; i++)
+	for (; NULL != part; part = NextPart(&selector))
 	{
-		if (!parts[i]->Configure(this, settings, start, count))
+		if (!part->Configure(this, settings, start, count))
 			break;
 	}
 
@@ -525,187 +598,120 @@ bool Device::DoFlash(const char* name, int durMs)
 }
 
 
-int Device::GetCount(int partType)
-{
-	int count = 0;
-
-	for (int i = 0; i < PartCount; i++)
-	{
-		Part *part = Parts[i];
-
-		if (part->Type == partType)
-			count++;
-	}
-
-	return count;
-}
-
-
-bool Device::GetParts(const char* expr, Part* parts[], uint8_t* count, bool quiet)
+bool Device::FindParts(const char* expr, PartSelector* selector, bool quiet)
 {
 	// 'expr' is one of:
 	//		A special case like "All", "*", "AllIn", etc.
 	//		A Part's name.
 	//		A Part type.
-	// Populate 'parts' with the corresponding Part(s), and 'count' with the count.
-
-	*count = 0;
+	// Set up 'selector' for 'NextPart' to visit the corresponding Part(s), straight from the Part index.
+	// Returns false if 'expr' is none of these.
+	selector->All = 0;
+	selector->Any = 0;
+	selector->Count = 0;
+	selector->MaxCount = 0;
+	selector->Next = 0;
+	selector->PartType = ARDJACK_PART_TYPE_NONE;
+	selector->Single = NULL;
 
 	// Special case?
-	char useExpr[20];
-	strncpy(useExpr, expr, 20);
-	useExpr[strlen(expr)] = NULL;
+	char useExpr[ARDJACK_MAX_NAME_LENGTH];
+	strncpy(useExpr, expr, ARDJACK_MAX_NAME_LENGTH - 1);
+	useExpr[ARDJACK_MAX_NAME_LENGTH - 1] = NULL;
 	Utils::Trim(useExpr);
 	strlwr(useExpr);
 
-	if (Utils::StringEquals(useExpr, "all", false) || Utils::StringEquals(useExpr, "*", false))
-	{
-		for (int i = 0; i < PartCount; i++)
-			parts[(*count)++] = Parts[i];
+	const uint8_t analog = 1 << ARDJACK_PART_CATEGORY_ANALOG;
+	const uint8_t digital = 1 << ARDJACK_PART_CATEGORY_DIGITAL;
+	const uint8_t input = 1 << ARDJACK_PART_CATEGORY_INPUT;
+	const uint8_t output = 1 << ARDJACK_PART_CATEGORY_OUTPUT;
 
+	if (Utils::StringEquals(useExpr, "*", false))
 		return true;
-	}
 
-	if (Utils::StringEquals(useExpr, "allanalog", false))
+	if (strncmp(useExpr, "all", 3) == 0)
 	{
-		for (int i = 0; i < PartCount; i++)
-		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsAnalogType(part->Type))
-				parts[(*count)++] = part;
-		}
+		const char* kind = useExpr + 3;
 
-		return true;
-	}
+		if (kind[0] == NULL)
+			return true;
 
-	if (Utils::StringEquals(useExpr, "allanalogin", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "analog", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsAnalogType(part->Type) && Globals::PartMgr->IsInputType(part->Type))
-				parts[(*count)++] = part;
+			selector->All = analog;
+			return true;
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "alldigital", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "analogin", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsDigitalType(part->Type))
-				parts[(*count)++] = part;
+			selector->All = analog | input;
+			return true;
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "alldigitalin", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "digital", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsDigitalType(part->Type) && Globals::PartMgr->IsInputType(part->Type))
-				parts[(*count)++] = part;
+			selector->All = digital;
+			return true;
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "alldigitalout", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "digitalin", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsDigitalType(part->Type) && Globals::PartMgr->IsOutputType(part->Type))
-				parts[(*count)++] = part;
+			selector->All = digital | input;
+			return true;
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "allin", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "digitalout", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsInputType(part->Type))
-				parts[(*count)++] = part;
+			selector->All = digital | output;
+			return true;
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "allinout", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "in", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsInputType(part->Type) || Globals::PartMgr->IsOutputType(part->Type))
-					parts[(*count)++] = part;
+			selector->All = input;
+			return true;
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "allout", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "inout", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsOutputType(part->Type))
-				parts[(*count)++] = part;
+			selector->Any = input | output;
+			return true;
 		}
 
-		return true;
+		if (Utils::StringEquals(kind, "out", false))
+		{
+			selector->All = output;
+			return true;
+		}
 	}
-
-	if (Utils::StringEquals(useExpr, "firstbuttonorswitch", false))
+	else if (strncmp(useExpr, "first", 5) == 0)
 	{
-		for (int i = 0; i < PartCount; i++)
-		{
-			Part* part = Parts[i];
+		const char* kind = useExpr + 5;
 
-			if ((part->Type == ARDJACK_PART_TYPE_BUTTON) || (part->Type == ARDJACK_PART_TYPE_SWITCH))
+		if (Utils::StringEquals(kind, "buttonorswitch", false))
+		{
+			// Buttons and switches are digital inputs.
+			for (int i = _PartIndex.Next(PartCount, digital | input, 0, 0); i >= 0; i = _PartIndex.Next(PartCount, digital | input, 0, i + 1))
 			{
-				parts[(*count)++] = part;
-				break;
+				Part* part = Parts[i];
+
+				if ((part->Type == ARDJACK_PART_TYPE_BUTTON) || (part->Type == ARDJACK_PART_TYPE_SWITCH))
+				{
+					selector->Single = part;
+					return true;
+				}
 			}
-		}
 
-		if ((*count) == 0)
-		{
 			// Nothing found - fall back to 'firstdigitalin'.
-			return GetParts("firstdigitalin", parts, count, quiet);
+			kind = "digitalin";
 		}
 
-		return true;
-	}
-
-	if (Utils::StringEquals(useExpr, "firstdigitalin", false))
-	{
-		for (int i = 0; i < PartCount; i++)
+		if (Utils::StringEquals(kind, "digitalin", false))
 		{
-			Part* part = Parts[i];
-
-			if (Globals::PartMgr->IsDigitalType(part->Type) && Globals::PartMgr->IsInputType(part->Type))
-			{
-				parts[(*count)++] = part;
-				break;
-			}
+			selector->All = digital | input;
+			selector->MaxCount = 1;
+			return true;
 		}
-
-		return true;
 	}
 
 	// Part name?
@@ -713,24 +719,73 @@ bool Device::GetParts(const char* expr, Part* parts[], uint8_t* count, bool quie
 
 	if (NULL != part)
 	{
-		parts[(*count)++] = part;
+		selector->Single = part;
 		return true;
 	}
 
 	// Part type?
-	int partType = Globals::PartMgr->LookupType(useExpr);
+	int partType = Globals::PartMgr->LookupType(useExpr, quiet);
 
 	if (partType != ARDJACK_PART_TYPE_NONE)
-		return GetPartsOfType(partType, parts, count);
+	{
+		selector->PartType = partType;
+		return true;
+	}
 
 	if (!quiet)
-		Log::LogErrorF(PRM("GetParts: Expression '%s' returned no Parts"), expr);
+		Log::LogErrorF(PRM("FindParts: Expression '%s' returned no Parts"), expr);
+
+	return false;
+}
+
+
+bool Device::FlushNotifyBatch()
+{
+	// Send any batched value changes as one 'parts' notification, e.g. 'parts ai0=512 di3=1'.
+	if (_NotifyBatch[0] == NULL)
+		return true;
+
+	bool result = SendResponse(ARDJACK_OPERATION_NOTIFY_PARTS, "", _NotifyBatch);
+	_NotifyBatch[0] = NULL;
+
+	return result;
+}
+
+
+int Device::GetCount(int partType)
+{
+	int count = 0;
+
+	for (int i = 0; i < PartCount; i++)
+	{
+		Part *part = Parts[i];
+
+		if (part->Type == partType)
+			count++;
+	}
+
+	return count;
+}
+
+
+bool Device::GetParts(const char* expr, Part* parts[], uint16_t* count, bool quiet)
+{
+	// Populate 'parts' with the Parts of 'expr' (see 'FindParts'), and 'count' with the count.
+	PartSelector selector;
+
+	*count = 0;
+
+	if (!FindParts(expr, &selector, quiet))
+		return true;
+
+	for (Part* part = NextPart(&selector); NULL != part; part = NextPart(&selector))
+		parts[(*count)++] = part;
 
 	return true;
 }
 
 
-bool Device::GetPartsOfType(int partType, Part* parts[], uint8_t* count)
+bool Device::GetPartsOfType(int partType, Part* parts[], uint16_t* count)
 {
 	// From 'partType', populate 'parts' with the Parts of that type, and 'count' with the count.
 	*count = 0;
@@ -747,79 +802,139 @@ bool Device::GetPartsOfType(int partType, Part* parts[], uint8_t* count)
 }
 
 
-int Device::LookupOperation(const char* name)
+int Device::LookupOperation(const char* name, int length)
 {
-	char useName[ARDJACK_MAX_NAME_LENGTH];
-	strcpy(useName, name);
-	_strlwr(useName);
+	// Look up Device Operation verb 'name' (case-insensitive, 'length' chars, or NULL-terminated if -1).
+	// Each verb hashes to its own slot, so one comparison decides. A new verb whose slot collides with another's
+	// won't compile ('duplicate case value'), and needs a different 'OperationSlot'.
+	if (length < 0)
+		length = strlen(name);
 
-	if (strcmp(useName, PRM("activate")) == 0)
-		return ARDJACK_OPERATION_ACTIVATE;
+	const char* verb = NULL;
+	int oper = ARDJACK_OPERATION_NONE;
 
-	if (strcmp(useName, PRM("add")) == 0)
-		return ARDJACK_OPERATION_ADD;
+	switch (OperationSlot(Utils::HashText(name, length)))
+	{
+	case OperationSlot(Utils::HashLiteral("activate")):
+		verb = PRM("activate");
+		oper = ARDJACK_OPERATION_ACTIVATE;
+		break;
 
-	if (strcmp(useName, PRM("beep")) == 0)
-		return ARDJACK_OPERATION_BEEP;
+	case OperationSlot(Utils::HashLiteral("add")):
+		verb = PRM("add");
+		oper = ARDJACK_OPERATION_ADD;
+		break;
 
-	if (strcmp(useName, PRM("clear")) == 0)
-		return ARDJACK_OPERATION_CLEAR;
+	case OperationSlot(Utils::HashLiteral("beep")):
+		verb = PRM("beep");
+		oper = ARDJACK_OPERATION_BEEP;
+		break;
 
-	if (strcmp(useName, PRM("configure")) == 0)
-		return ARDJACK_OPERATION_CONFIGURE;
+	case OperationSlot(Utils::HashLiteral("clear")):
+		verb = PRM("clear");
+		oper = ARDJACK_OPERATION_CLEAR;
+		break;
+
+	case OperationSlot(Utils::HashLiteral("configure")):
+		verb = PRM("configure");
+		oper = ARDJACK_OPERATION_CONFIGURE;
+		break;
+
+	case OperationSlot(Utils::HashLiteral("configurepart")):
+		verb = PRM("configurepart");
+		oper = ARDJACK_OPERATION_CONFIGUREPART;
+		break;
+
+	case OperationSlot(Utils::HashLiteral("deactivate")):
+		verb = PRM("deactivate");
+		oper = ARDJACK_OPERATION_DEACTIVATE;
+		break;
 
-	if (strcmp(useName, PRM("configurepart")) == 0)
-		return ARDJACK_OPERATION_CONFIGUREPART;
+	case OperationSlot(Utils::HashLiteral("error")):
+		verb = PRM("error");
+		oper = ARDJACK_OPERATION_ERROR;
+		break;
 
-	if (strcmp(useName, PRM("deactivate")) == 0)
-		return ARDJACK_OPERATION_DEACTIVATE;
+	case OperationSlot(Utils::HashLiteral("flash")):
+		verb = PRM("flash");
+		oper = ARDJACK_OPERATION_FLASH;
+		break;
 
-	if (strcmp(useName, PRM("flash")) == 0)
-		return ARDJACK_OPERATION_FLASH;
+	case OperationSlot(Utils::HashLiteral("getconfig")):
+		verb = PRM("getconfig");
+		oper = ARDJACK_OPERATION_GET_CONFIG;
+		break;
 
-	if (strcmp(useName, PRM("error")) == 0)
-		return ARDJACK_OPERATION_ERROR;
+	case OperationSlot(Utils::HashLiteral("getcount")):
+		verb = PRM("getcount");
+		oper = ARDJACK_OPERATION_GET_COUNT;
+		break;
 
-	if (strcmp(useName, PRM("getconfig")) == 0)
-		return ARDJACK_OPERATION_GET_CONFIG;
+	case OperationSlot(Utils::HashLiteral("getglobal")):
+		verb = PRM("getglobal");
+		oper = ARDJACK_OPERATION_GET_GLOBAL;
+		break;
 
-	if (strcmp(useName, PRM("getcount")) == 0)
-		return ARDJACK_OPERATION_GET_COUNT;
+	case OperationSlot(Utils::HashLiteral("getinfo")):
+		verb = PRM("getinfo");
+		oper = ARDJACK_OPERATION_GET_INFO;
+		break;
 
-	if (strcmp(useName, PRM("getglobal")) == 0)
-		return ARDJACK_OPERATION_GET_GLOBAL;
+	case OperationSlot(Utils::HashLiteral("getinventory")):
+		verb = PRM("getinventory");
+		oper = ARDJACK_OPERATION_GET_INVENTORY;
+		break;
 
-	if (strcmp(useName, PRM("getinfo")) == 0)
-		return ARDJACK_OPERATION_GET_INFO;
+	case OperationSlot(Utils::HashLiteral("getmetrics")):
+		verb = PRM("getmetrics");
+		oper = ARDJACK_OPERATION_GET_METRICS;
+		break;
 
-	if (strcmp(useName, PRM("getinventory")) == 0)
-		return ARDJACK_OPERATION_GET_INVENTORY;
+	case OperationSlot(Utils::HashLiteral("getpartconfig")):
+		verb = PRM("getpartconfig");
+		oper = ARDJACK_OPERATION_GET_PART_CONFIG;
+		break;
 
-	if (strcmp(useName, PRM("getpartconfig")) == 0)
-		return ARDJACK_OPERATION_GET_PART_CONFIG;
+	case OperationSlot(Utils::HashLiteral("reactivate")):
+		verb = PRM("reactivate");
+		oper = ARDJACK_OPERATION_REACTIVATE;
+		break;
 
-	if (strcmp(useName, PRM("reactivate")) == 0)
-		return ARDJACK_OPERATION_REACTIVATE;
+	case OperationSlot(Utils::HashLiteral("read")):
+		verb = PRM("read");
+		oper = ARDJACK_OPERATION_READ;
+		break;
 
-	if (strcmp(useName, PRM("read")) == 0)
-		return ARDJACK_OPERATION_READ;
+	case OperationSlot(Utils::HashLiteral("setglobal")):
+		verb = PRM("setglobal");
+		oper = ARDJACK_OPERATION_SET_GLOBAL;
+		break;
 
-	if (strcmp(useName, PRM("setglobal")) == 0)
-		return ARDJACK_OPERATION_SET_GLOBAL;
+	case OperationSlot(Utils::HashLiteral("subscribe")):
+		verb = PRM("subscribe");
+		oper = ARDJACK_OPERATION_SUBSCRIBE;
+		break;
 
-	if (strcmp(useName, PRM("subscribe")) == 0)
-		return ARDJACK_OPERATION_SUBSCRIBE;
+	case OperationSlot(Utils::HashLiteral("unsubscribe")):
+		verb = PRM("unsubscribe");
+		oper = ARDJACK_OPERATION_UNSUBSCRIBE;
+		break;
 
-	if (strcmp(useName, PRM("unsubscribe")) == 0)
-		return ARDJACK_OPERATION_UNSUBSCRIBE;
+	case OperationSlot(Utils::HashLiteral("update")):
+		verb = PRM("update");
+		oper = ARDJACK_OPERATION_UPDATE;
+		break;
 
-	if (strcmp(useName, PRM("update")) == 0)
-		return ARDJACK_OPERATION_UPDATE;
+	case OperationSlot(Utils::HashLiteral("write")):
+		verb = PRM("write");
+		oper = ARDJACK_OPERATION_WRITE;
+		break;
+	}
 
-	if (strcmp(useName, PRM("write")) == 0)
-		return ARDJACK_OPERATION_WRITE;
+	if ((NULL != verb) && Utils::StringEqualsN(name, verb, length))
+		return oper;
 
-	Log::LogWarningF(PRM("Unknown Device Operation: '%s'"), useName);
+	Log::LogWarningF(PRM("Unknown Device Operation: '%.*s'"), length, name);
 
 	return ARDJACK_OPERATION_NONE;
 }
@@ -827,15 +942,10 @@ int Device::LookupOperation(const char* name)
 
 Part* Device::LookupPart(const char* name, bool quiet)
 {
-	Part* result = NULL;
-
-	for (int i = 0; i < PartCount; i++)
-	{
-		Part* part = Parts[i];
+	int index = _PartIndex.Find(Parts, PartCount, name);
 
-		if (Utils::StringEquals(part->Name, name))
-			return part;
-	}
+	if (index >= 0)
+		return Parts[index];
 
 	if (!quiet)
 		Log::LogErrorF(PRM("LookupPart: Device '%s' has no Part '%s'"), Name, name);
@@ -851,32 +961,23 @@ Part* Device::LookupPart(const char* name, int type, int subtype, bool quiet)
 	// If no, removes any Part called 'name'.
 
 	Part* result = NULL;
+	int index = _PartIndex.Find(Parts, PartCount, name);
 
-	// Copy the Parts info.
-	int oldPartCount = PartCount;
-	Part* oldParts[ARDJACK_MAX_PARTS];
-
-	for (int i = 0; i < oldPartCount; i++)
-		oldParts[i] = Parts[i];
-
-	// Rebuild the Parts info.
-	PartCount = 0;
-
-	for (int i = 0; i < oldPartCount; i++)
+	if (index >= 0)
 	{
-		Part* part = Parts[i];
-		bool copy = true;
+		Part* part = Parts[index];
 
-		if (Utils::StringEquals(part->Name, name))
+		if ((part->Type == type) && ((part->Type != ARDJACK_PART_TYPE_USER) || (part->Subtype == subtype)))
+			result = part;
+		else
 		{
-			if ((part->Type == type) && ((part->Type != ARDJACK_PART_TYPE_USER) || (part->Subtype == subtype)))
-				result = part;
-			else
-				copy = false;
-		}
+			// Remove and delete the old Part.
+			ArrayHelpers::RemoveElement((void**)Parts, PartCount, index);
+			PartCount--;
+			delete part;
 
-		if (copy)
-			Parts[PartCount++] = part;
+			_PartIndex.Rebuild(Parts, PartCount);
+		}
 	}
 
 	if ((NULL == result) && !quiet)
@@ -886,7 +987,7 @@ Part* Device::LookupPart(const char* name, int type, int subtype, bool quiet)
 }
 
 
-bool Device::LookupParts(const char* names, Part* parts[], uint8_t* count)
+bool Device::LookupParts(const char* names, Part* parts[], uint16_t* count)
 {
 	// From a space-separated list of part names in 'names', populate 'parts' with the Parts, and 'count' with the count.
 	*count = 0;
@@ -906,6 +1007,45 @@ bool Device::LookupParts(const char* names, Part* parts[], uint8_t* count)
 }
 
 
+Part* Device::NextPart(PartSelector* selector)
+{
+	// Get the next Part that 'selector' (see 'FindParts') visits, or NULL if there are no more.
+	if ((selector->MaxCount > 0) && (selector->Count >= selector->MaxCount))
+		return NULL;
+
+	if (NULL != selector->Single)
+	{
+		selector->Count++;
+		selector->MaxCount = 1;
+
+		return selector->Single;
+	}
+
+	int i = selector->Next;
+
+	if (selector->PartType != ARDJACK_PART_TYPE_NONE)
+	{
+		while ((i < PartCount) && (Parts[i]->Type != selector->PartType))
+			i++;
+
+		if (i >= PartCount)
+			return NULL;
+	}
+	else
+	{
+		i = _PartIndex.Next(PartCount, selector->All, selector->Any, i);
+
+		if (i < 0)
+			return NULL;
+	}
+
+	selector->Count++;
+	selector->Next = i + 1;
+
+	return Parts[i];
+}
+
+
 bool Device::Open()
 {
 	if (Globals::Verbosity > 3)
@@ -988,13 +1128,10 @@ bool Device::PollParts()
 	if (Globals::Verbosity > 6)
 		Log::LogInfo(Name);
 
-	for (int i = 0; i < PartCount; i++)
-	{
-		Part* part = Parts[i];
+	const uint8_t notifying = 1 << ARDJACK_PART_CATEGORY_NOTIFYING;
 
-		if (part->Notifying)
-			part->Poll();
-	}
+	for (int i = _PartIndex.Next(PartCount, notifying, 0, 0); i >= 0; i = _PartIndex.Next(PartCount, notifying, 0, i + 1))
+		Parts[i]->Poll();
 
 	return true;
 }
@@ -1080,25 +1217,39 @@ bool Device::Read(Part* part, Dynamic* value)
 #endif
 
 
+bool Device::ReadParts(PartSelector* selector)
+{
+	// Read the Parts 'selector' visits and add their values to the 'parts' batch, which the caller sends with
+	// 'FlushNotifyBatch'.
+	Dynamic value;
+	char temp[ARDJACK_MAX_DYNAMIC_STRING_LENGTH];
+
+	for (Part* part = NextPart(selector); NULL != part; part = NextPart(selector))
+	{
+		Read(part, &value);
+		value.AsString(temp);
+
+		if (!AddToNotifyBatch(part, temp))
+			return false;
+	}
+
+	return true;
+}
+
+
 bool Device::RemoveOldParts()
 {
 	// Remove and delete any Parts that don't have 'IsNew' set.
 	if (Globals::Verbosity > 5)
 		Log::LogInfoF(PRM("Device::RemoveOldParts: '%s': Entry, %d Parts"), Name, PartCount);
 
-	// Copy the Parts info.
-	Part* startParts[ARDJACK_MAX_PARTS];
-
-	for (int i = 0; i < PartCount; i++)
-		startParts[i] = Parts[i];
-
-	// Rebuild the Parts info.
+	// Compact the Parts info in place (the kept Parts only ever move down).
 	int startPartCount = PartCount;
 	PartCount = 0;
 
 	for (int i = 0; i < startPartCount; i++)
 	{
-		Part* part = startParts[i];
+		Part* part = Parts[i];
 
 		if (part->IsNew)
 			Parts[PartCount++] = part;
@@ -1106,6 +1257,11 @@ bool Device::RemoveOldParts()
 			delete part;
 	}
 
+	for (int i = PartCount; i < startPartCount; i++)
+		Parts[i] = NULL;
+
+	_PartIndex.Rebuild(Parts, PartCount);
+
 	if (Globals::Verbosity > 5)
 		Log::LogInfoF(PRM("Device::RemoveOldParts: '%s': Exit, %d Parts"), Name, PartCount);
 
@@ -1147,51 +1303,44 @@ bool Device::ScanInputsOnce(bool *changes, bool signal)
 	*changes = false;
 
 	bool change;
-	bool changeList[ARDJACK_MAX_PARTS];
+	char temp[200];
+	temp[0] = NULL;
 
-	for (int i = 0; i < PartCount; i++)
+	const uint8_t notifying = 1 << ARDJACK_PART_CATEGORY_NOTIFYING;
+
+	// Gather the value changes into as few notifications as will hold them?
+	_Batching = _BatchNotify;
+
+	for (int i = _PartIndex.Next(PartCount, notifying, 0, 0); i >= 0; i = _PartIndex.Next(PartCount, notifying, 0, i + 1))
 	{
 		Part *part = Parts[i];
-		changeList[i] = false;
 
-		if (part->Notifying)
+		CheckInput(part, &change);
+
+		if (change)
 		{
-			CheckInput(part, &change);
+			*changes = true;
 
-			if (change)
-			{
-				*changes = true;
-				changeList[i] = true;
+			//if (signal)
+			//	SignalChange_Value(part);
 
-				//if (signal)
-				//	SignalChange_Value(part);
+			if ((Globals::Verbosity > 5) && (strlen(temp) + strlen(part->Name) + 2 < sizeof(temp)))
+			{
+				strcat(temp, " ");
+				strcat(temp, part->Name);
 			}
 		}
 	}
 
-	if (*changes)
+	if (_Batching)
 	{
-		if (Globals::Verbosity > 5)
-		{
-			char temp[200];
-			temp[0] = NULL;
-
-			for (int i = 0; i < PartCount; i++)
-			{
-				Part* part = Parts[i];
-
-				if (changeList[i])
-				{
-					strcat(temp, " ");
-					strcat(temp, part->Name);
-				}
-			}
-
-			if (Globals::Verbosity > 5)
-				Log::LogInfo(Name, PRM(": Parts changed:"), temp);
-		}
+		_Batching = false;
+		FlushNotifyBatch();
 	}
 
+	if (*changes && (Globals::Verbosity > 5))
+		Log::LogInfo(Name, PRM(": Parts changed:"), temp);
+
 	return true;
 }
 
@@ -1247,8 +1396,12 @@ bool Device::SendPartConfig(Part* part)
 }
 
 
-bool Device::SendResponse(int oper, const char* aName, const char* text)
+bool Device::SendResponse(int oper, const char* aName, const char* text, uint32_t key)
 {
+#ifdef ARDJACK_INCLUDE_METRICS
+	unsigned long startUs = Utils::NowUs();
+#endif
+
 	char response[120];
 
 	DeviceCodec->EncodeResponse(response, oper, aName, text);
@@ -1286,6 +1439,10 @@ bool Device::SendResponse(int oper, const char* aName, const char* text)
 	strcpy(fromPath, fromPath);
 	strcpy(returnPath, fromPath);
 
+	// Format 2 interns the paths with the Connection's peer.
+	uint32_t peer;
+	MessagePathTable* paths = OutputConnection->OutputPaths(&peer);
+
 	switch (_MessageFormat)
 	{
 	case ARDJACK_MESSAGE_FORMAT_0:
@@ -1294,15 +1451,27 @@ bool Device::SendResponse(int oper, const char* aName, const char* text)
 		strcat(temp, " ");
 		strcat(temp, response);
 
-		IoTMessage::CreateMessageToSend(PRM("response"), _MessageFormat, temp, &_ResponseMsg, fromPath, toPath, returnPath);
+		IoTMessage::CreateMessageToSend(PRM("response"), _MessageFormat, temp, &_ResponseMsg, fromPath, toPath, returnPath,
+			paths, peer);
 		break;
 
 	default:
-		IoTMessage::CreateMessageToSend(PRM("response"), _MessageFormat, response, &_ResponseMsg, fromPath, toPath, returnPath);
+		IoTMessage::CreateMessageToSend(PRM("response"), _MessageFormat, response, &_ResponseMsg, fromPath, toPath, returnPath,
+			paths, peer);
 		break;
 	}
 
+	// A coalescing Connection sends only the latest response with a given 'key'.
+	_ResponseMsg.Key = key;
+
+#ifdef ARDJACK_INCLUDE_METRICS
+	bool result = OutputConnection->OutputMessage(&_ResponseMsg);
+	Metrics::Items[ARDJACK_METRIC_DEVICE_RESPONSE].Record(Utils::NowUs() - startUs);
+
+	return result;
+#else
 	return OutputConnection->OutputMessage(&_ResponseMsg);
+#endif
 }
 
 
@@ -1311,6 +1480,11 @@ bool Device::SetNotify(Part* part, bool state)
 	// If 'state', send notifications when 'part' changes value.
 	part->Notifying = state;
 
+	int index = _PartIndex.Find(Parts, PartCount, part->Name);
+
+	if ((index >= 0) && (Parts[index] == part))
+		_PartIndex.SetCategory(index, ARDJACK_PART_CATEGORY_NOTIFYING, state);
+
 	if (Globals::Verbosity > 3)
 		Log::LogInfoF(PRM("SetNotify: '%s', Part '%s' -> state %d"), Name, part->Name, state);
 
@@ -1326,7 +1500,10 @@ bool Device::SetNotify(int partType, bool state)
 		Part* part = Parts[i];
 
 		if (part->Type == partType)
+		{
 			part->Notifying = state;
+			_PartIndex.SetCategory(i, ARDJACK_PART_CATEGORY_NOTIFYING, state);
+		}
 	}
 
 	if (Globals::Verbosity > 2)
@@ -1348,11 +1525,17 @@ bool Device::SignalChange_Configuration(Part* part)
 
 bool Device::SignalChange_Value(Part* part)
 {
-	// Send a notification that the value of 'part' has changed.
+	// Send a notification that the value of 'part' has changed (or, in a batching scan, add it to the batch).
+	// Newer values of 'part' supersede this one, so key it by Device and Part (see 'ARDJACK_OUTPUT_OVERFLOW_COALESCE').
 	char temp[ARDJACK_MAX_DYNAMIC_STRING_LENGTH];
 	part->Value.AsString(temp);
 
-	return SendResponse(ARDJACK_OPERATION_READ, part->Name, temp);
+	if (_Batching)
+		return AddToNotifyBatch(part, temp);
+
+	uint32_t key = Utils::HashText(Name) * 31 + Utils::HashText(part->Name);
+
+	return SendResponse(ARDJACK_OPERATION_READ, part->Name, temp, (key == 0) ? 1 : key);
 }
 
 
@@ -35,6 +35,7 @@
 #include "Globals.h"
 #include "IoTMessage.h"
 #include "IoTObject.h"
+#include "PartIndex.h"
 
 class Connection;
 class DeviceCodec1;
@@ -46,14 +47,31 @@ class StringList;
 
 
 
+// The Parts of a Part expression (see 'Device::FindParts'), visited in turn by 'Device::NextPart'.
+struct PartSelector
+{
+	uint8_t All;														// categories a Part must all be in (see 'PartIndex::Next')
+	uint8_t Any;														// categories a Part must be in one of
+	int Count;															// no.of Parts visited so far
+	int MaxCount;														// max.no.of Parts to visit (0 = no limit)
+	int Next;															// index in 'Parts' to carry on from
+	int PartType;														// the type of the Parts to visit, or ARDJACK_PART_TYPE_NONE
+	Part* Single;														// the only Part to visit, e.g. one named by the expression
+};
+
+
 
 class Device : public IoTObject
 {
 protected:
+	bool _BatchNotify;													// send the value changes from a scan as one notification?
+	bool _Batching;														// in a scan, gathering value changes into '_NotifyBatch'?
 	bool _IsOpen;
 	int _MessageFormat;
 	char _MessagePrefix[10];
 	char _MessageToPath[20];
+	char _NotifyBatch[ARDJACK_MAX_NOTIFY_BATCH_LENGTH + 1];				// 'name=value' items waiting to be notified
+	PartIndex _PartIndex;
 	IoTMessage _ResponseMsg;
 
 #ifdef ARDJACK_INCLUDE_SHIELDS
@@ -61,6 +79,7 @@ protected:
 #endif
 
 	virtual bool Activate() override;
+	virtual bool AddToNotifyBatch(Part* part, const char* value);
 	virtual bool ApplyConfig(bool quiet = false) override;
 	virtual bool CheckInput(Part* part, bool* change);
 	virtual bool CloseParts();
@@ -82,7 +101,7 @@ public:
 	Connection* InputConnection;
 	int InputTimeout;													// ms
 	Connection* OutputConnection;
-	uint8_t PartCount;
+	uint16_t PartCount;
 	Part* Parts[ARDJACK_MAX_PARTS];
 	int ReadEvents;
 	int WriteEvents;
@@ -103,13 +122,16 @@ public:
 	virtual bool CreateDefaultInventory();
 	virtual bool DoBeep(int index, int freqHz, int durMs);
 	virtual bool DoFlash(const char* name = "led0", int durMs = 20);
+	virtual bool FindParts(const char* expr, PartSelector* selector, bool quiet = false);
+	virtual bool FlushNotifyBatch();
 	virtual int GetCount(int partType);
-	virtual bool GetParts(const char* expr, Part* parts[], uint8_t* count, bool quiet = false);
-	virtual bool GetPartsOfType(int partType, Part* parts[], uint8_t* count);
-	static int LookupOperation(const char* name);
+	virtual bool GetParts(const char* expr, Part* parts[], uint16_t* count, bool quiet = false);
+	virtual bool GetPartsOfType(int partType, Part* parts[], uint16_t* count);
+	static int LookupOperation(const char* name, int length = -1);
 	virtual Part* LookupPart(const char* name, bool quiet = false);
 	virtual Part* LookupPart(const char* name, int type, int subtype, bool quiet = false);
-	virtual bool LookupParts(const char* names, Part* parts[], uint8_t* count);
+	virtual bool LookupParts(const char* names, Part* parts[], uint16_t* count);
+	virtual Part* NextPart(PartSelector* selector);
 	virtual bool Open();
 	virtual bool Poll() override;
 	virtual bool PrepareForCreateInventory();
@@ -117,6 +139,7 @@ public:
 #ifdef ARDJACK_INCLUDE_MULTI_PARTS
 	virtual bool ReadMulti(Part* part, char* value);
 #endif
+	virtual bool ReadParts(PartSelector* selector);
 	virtual bool RemoveOldParts();
 	virtual bool ScanInputs(bool* changes, int count, int delayMs);
 	virtual bool ScanInputsOnce(bool* changes, bool signal = false);
@@ -125,7 +148,7 @@ public:
 	virtual bool SendPartConfig(Part* part);
 	virtual bool SignalChange_Configuration(Part* part);
 	virtual bool SignalChange_Value(Part* part);
-	virtual bool SendResponse(int oper, const char* aName, const char* text);
+	virtual bool SendResponse(int oper, const char* aName, const char* text, uint32_t key = 0);
 	virtual bool SetNotify(Part* part, bool state);
 	virtual bool SetNotify(int partType, bool state);
 	virtual bool Update();
@@ -48,140 +48,34 @@ DeviceCodec1::DeviceCodec1()
 
 int DeviceCodec1::DecodeRequest(const char* line, char *aName, StringList* values)
 {
-	// Example formats:
-	//		?ai0
-	//		read ai0
-	//		!di0 1
-	//		write di0 1
-	//		configure x=y xx=yy
-	//		getcount di
-	//		?ai.count
-
-	int oper = ARDJACK_OPERATION_NONE;
-	strcpy(aName, "");
-	values->Clear();
-
-	char useLine[200];
-	strcpy(useLine, line);
-	Utils::Trim(useLine);
-
-	StringList fields;
-	int fieldCount = Utils::SplitText(useLine, ' ', &fields, ARDJACK_MAX_VALUES, ARDJACK_MAX_VALUE_LENGTH);
-
-	char firstChar = fields.Get(0)[0];
-	char field0[ARDJACK_MAX_VALUE_LENGTH];
-	strcpy(field0, &fields.Get(0)[1]);
-	_strlwr(field0);
-	int nextFieldIndex = 1;
-
-	switch (firstChar)
-	{
-	case ':':
-		oper = ARDJACK_OPERATION_CONFIGURE;
-		break;
-
-	case '^':
-		oper = ARDJACK_OPERATION_CONFIGUREPART;
-		break;
-
-	case '*':
-		oper = ARDJACK_OPERATION_ERROR;
-		break;
-
-	case '~':
-		oper = ARDJACK_OPERATION_GET_INVENTORY;
-		break;
-
-	case '?':
-		oper = ARDJACK_OPERATION_READ;
-		break;
-
-	case '>':
-		oper = ARDJACK_OPERATION_SUBSCRIBE;
-		break;
-
-	case '<':
-		oper = ARDJACK_OPERATION_UNSUBSCRIBE;
-		break;
-
-	case '!':
-		oper = ARDJACK_OPERATION_WRITE;
-		break;
+	// Decode 'line' (see 'Tokenize') into Part name, Part type etc. 'aName' and any 'values'.
+	DeviceRequestTokens tokens;
+	int oper = Tokenize(line, &tokens);
 
-	default:
-		strcpy(field0, fields.Get(0));
-		oper = Device::LookupOperation(field0);
+	int length = (tokens.NameLength < ARDJACK_MAX_NAME_LENGTH) ? tokens.NameLength : ARDJACK_MAX_NAME_LENGTH - 1;
+	strncpy(aName, tokens.Name, length);
+	aName[length] = NULL;
 
-		if (oper == ARDJACK_OPERATION_NONE)
-		{
-			Log::LogWarningF(PRM("DecodeRequest: Can't decode: '%s' - invalid operation"), useLine);
-			return oper;
-		}
+	if (tokens.Prefix != NULL)
+		_strlwr(aName);
 
-		field0[0] = NULL;
-
-		if (fieldCount >= 2)
-			strcpy(field0, fields.Get(1));
-
-		nextFieldIndex = 2;
-	}
-
-	// Is there a dot?
-	char *dot = strchr(field0, '.');
+	values->Clear();
+	char value[ARDJACK_MAX_VALUE_LENGTH];
 
-	if (NULL == dot)
+	for (int i = 0; i < tokens.ValueCount; i++)
 	{
-		// There's no dot, e.g.
-		//		configure x=y xx=yy
-		//		configurepart ai0 x=y xx=yy
-		//		getconfig di2
-		//		getcount di
-		//		getglobal verbosity
-		//		getpartconfig ai0
-		//		read ai0
-		//		?ai0
-		//		setglobal verbosity 4
-		//		write di0 1
-		//		!di0 1
-
-		switch (oper)
-		{
-		case ARDJACK_OPERATION_CONFIGURE:
-			strcpy(aName, "");
+		length = tokens.ValueLengths[i];
 
-			// Get any arguments.
-			for (int i = 1; i < fieldCount; i++)
-				values->Add(fields.Get(i));
-			break;
-
-		default:
-			strcpy(aName, field0);
+		if (length >= ARDJACK_MAX_VALUE_LENGTH)
+			length = ARDJACK_MAX_VALUE_LENGTH - 1;
 
-			// Get any arguments.
-			for (int i = nextFieldIndex; i < fieldCount; i++)
-				values->Add(fields.Get(i));
-			break;
-		}
+		strncpy(value, tokens.Values[i], length);
+		value[length] = NULL;
 
-		return oper;
+		values->Add(value);
 	}
 
-	// There's a dot, e.g.
-	//		?ai.count
-	int charCount = (int)(dot - field0);
-	strncpy(aName, field0, charCount);
-	aName[charCount] = NULL;
-	Utils::Trim(aName);
-
-	char *afterDot = dot + 1;
-	Utils::Trim(afterDot);
-
-	if (Utils::StringEquals(afterDot, "count"))
-		return ARDJACK_OPERATION_GET_COUNT;
-
-	Log::LogWarningF(PRM("DecodeRequest: Can't decode: '%s' - invalid 'dot' option"), useLine);
-
-	return ARDJACK_OPERATION_NONE;
+	return oper;
 }
 
 
@@ -236,6 +130,18 @@ bool DeviceCodec1::EncodeResponse(char *response, int oper, const char* aName, c
 			strcat(response, text);
 			break;
 
+		case ARDJACK_OPERATION_GET_METRICS:
+			strcat(response, "metric ");
+			strcat(response, aName);
+			strcat(response, " ");
+			strcat(response, text);
+			break;
+
+		case ARDJACK_OPERATION_NOTIFY_PARTS:
+			strcat(response, "parts ");
+			strcat(response, text);
+			break;
+
 		case ARDJACK_OPERATION_READ:
 			strcat(response, aName);
 			strcat(response, " ");
@@ -260,3 +166,190 @@ bool DeviceCodec1::EncodeResponse(char *response, int oper, const char* aName, c
 	return true;
 }
 
+
+bool DeviceCodec1::NextField(const char** text, const char** field, int* length)
+{
+	// Find the next field of '*text', skipping white space, and step '*text' past it.
+	// Like 'Utils::GetFirstField', a field may be delimited by matching double-quotes or single-quotes.
+	const char* ptr = *text;
+
+	while (Utils::IsWhite(*ptr))
+		ptr++;
+
+	if (*ptr == NULL)
+	{
+		*text = ptr;
+		return false;
+	}
+
+	const char* end;
+
+	if ((*ptr == '"') || (*ptr == '\''))
+	{
+		end = strchr(ptr + 1, *ptr);
+
+		if (NULL != end)
+		{
+			*field = ptr + 1;
+			*length = (int)(end - *field);
+			*text = end + 1;
+			return true;
+		}
+
+		// No closing quote, so the field is the rest of the text.
+		end = ptr + strlen(ptr);
+
+		while (Utils::IsWhite(end[-1]))
+			end--;
+	}
+	else
+	{
+		end = ptr;
+
+		while ((*end != NULL) && !Utils::IsWhite(*end))
+			end++;
+	}
+
+	*field = ptr;
+	*length = (int)(end - ptr);
+	*text = end;
+
+	return true;
+}
+
+
+int DeviceCodec1::Tokenize(const char* line, DeviceRequestTokens* tokens)
+{
+	// Find the operation, the Part name, Part type etc. and any values of 'line', in one pass and without copying,
+	// e.g.
+	//		?ai0
+	//		read ai0
+	//		?ai0 ai1 ai2
+	//		?allin
+	//		!di0 1
+	//		write di0 1
+	//		!do0=1 do1=0 do2=1
+	//		configure x=y xx=yy
+	//		getcount di
+	//		?ai.count
+	tokens->Name = "";
+	tokens->NameLength = 0;
+	tokens->Oper = ARDJACK_OPERATION_NONE;
+	tokens->Prefix = NULL;
+	tokens->ValueCount = 0;
+
+	const char* ptr = line;
+	const char* field;
+	int length;
+
+	if (!NextField(&ptr, &field, &length))
+	{
+		Log::LogWarningF(PRM("Tokenize: Can't decode: '%s' - no operation"), line);
+		return ARDJACK_OPERATION_NONE;
+	}
+
+	const char* name = field + 1;
+	int nameLength = length - 1;
+	tokens->Prefix = field[0];
+
+	switch (field[0])
+	{
+	case ':':
+		tokens->Oper = ARDJACK_OPERATION_CONFIGURE;
+		break;
+
+	case '^':
+		tokens->Oper = ARDJACK_OPERATION_CONFIGUREPART;
+		break;
+
+	case '*':
+		tokens->Oper = ARDJACK_OPERATION_ERROR;
+		break;
+
+	case '~':
+		tokens->Oper = ARDJACK_OPERATION_GET_INVENTORY;
+		break;
+
+	case '?':
+		tokens->Oper = ARDJACK_OPERATION_READ;
+		break;
+
+	case '>':
+		tokens->Oper = ARDJACK_OPERATION_SUBSCRIBE;
+		break;
+
+	case '<':
+		tokens->Oper = ARDJACK_OPERATION_UNSUBSCRIBE;
+		break;
+
+	case '!':
+		tokens->Oper = ARDJACK_OPERATION_WRITE;
+		break;
+
+	default:
+		// A verb, then the name.
+		tokens->Prefix = NULL;
+		tokens->Oper = Device::LookupOperation(field, length);
+
+		if (tokens->Oper == ARDJACK_OPERATION_NONE)
+		{
+			Log::LogWarningF(PRM("Tokenize: Can't decode: '%s' - invalid operation"), line);
+			return ARDJACK_OPERATION_NONE;
+		}
+
+		if (!NextField(&ptr, &name, &nameLength))
+			return tokens->Oper;
+	}
+
+	if ((tokens->Oper == ARDJACK_OPERATION_CONFIGURE) ||
+		((tokens->Oper == ARDJACK_OPERATION_WRITE) && (NULL != memchr(name, '=', nameLength))))
+	{
+		// There's no name, so the name field is the first value, e.g.
+		//		configure x=y xx=yy
+		//		!do0=1 do1=0 do2=1
+		if (nameLength > 0)
+		{
+			tokens->Values[0] = name;
+			tokens->ValueLengths[0] = nameLength;
+			tokens->ValueCount = 1;
+		}
+	}
+	else
+	{
+		tokens->Name = name;
+		tokens->NameLength = nameLength;
+
+		// Is there a dot, e.g.
+		//		?ai.count
+		const char* dot = (const char*)memchr(name, '.', nameLength);
+
+		if (NULL != dot)
+		{
+			tokens->NameLength = (int)(dot - name);
+
+			if (Utils::StringEqualsN(dot + 1, "count", nameLength - tokens->NameLength - 1))
+				return (tokens->Oper = ARDJACK_OPERATION_GET_COUNT);
+
+			Log::LogWarningF(PRM("Tokenize: Can't decode: '%s' - invalid 'dot' option"), line);
+
+			return (tokens->Oper = ARDJACK_OPERATION_NONE);
+		}
+	}
+
+	// Get any values, the last one taking the rest of the line.
+	while ((tokens->ValueCount < ARDJACK_MAX_REQUEST_FIELDS) && NextField(&ptr, &field, &length))
+	{
+		if (tokens->ValueCount == ARDJACK_MAX_REQUEST_FIELDS - 1)
+		{
+			length = strlen(field);
+
+			while ((length > 0) && Utils::IsWhite(field[length - 1]))
+				length--;
+		}
+
+		tokens->Values[tokens->ValueCount] = field;
+		tokens->ValueLengths[tokens->ValueCount++] = length;
+	}
+
+	return tokens->Oper;
+}
@@ -37,14 +37,29 @@ class StringList;
 
 
 
+// A tokenized Device request, whose spans point into (and don't terminate) the request text.
+struct DeviceRequestTokens
+{
+	const char* Name;													// e.g. a Part name or Part type
+	int NameLength;
+	int Oper;
+	char Prefix;														// the operation's prefix character, e.g. '?', or NULL
+	int ValueCount;
+	int ValueLengths[ARDJACK_MAX_REQUEST_FIELDS];
+	const char* Values[ARDJACK_MAX_REQUEST_FIELDS];
+};
+
+
 class DeviceCodec1
 {
 protected:
+	static bool NextField(const char** text, const char** field, int* length);
 
 public:
 	DeviceCodec1();
 
 	virtual int DecodeRequest(const char* line, char *aName, StringList* values);
 	virtual bool EncodeResponse(char *response, int oper, const char* aName, const char* text);
+	virtual int Tokenize(const char* line, DeviceRequestTokens* tokens);
 };
 
@@ -40,6 +40,7 @@
 #include "IoTManager.h"
 #include "IoTMessage.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Part.h"
 #include "PartManager.h"
 #include "Utils.h"
@@ -59,8 +60,16 @@ DeviceManager::DeviceManager()
 	{
 		Subtypes = new Enumeration(PRM("Subtypes"));
 		Subtypes->Add(PRM("Arduino"), ARDJACK_DEVICE_SUBTYPE_ARDUINO);
+#ifdef ARDJACK_LINUX
+		Subtypes->Add(PRM("Linux"), ARDJACK_DEVICE_SUBTYPE_LINUX);
+#else
 		Subtypes->Add(PRM("Windows"), ARDJACK_DEVICE_SUBTYPE_WINDOWS);
 		Subtypes->Add(PRM("VellemanK8055"), ARDJACK_DEVICE_SUBTYPE_VELLEMANK8055);
+#endif
+
+#ifdef ARDJACK_INCLUDE_SIM_DEVICE
+		Subtypes->Add(PRM("Sim"), ARDJACK_DEVICE_SUBTYPE_SIM);
+#endif
 	}
 }
 
@@ -289,6 +298,38 @@ bool DeviceManager::ExecuteDeviceOperation(Device* dev, const char* text, int op
 		return dev->SendInventory(true, includeZeroCounts);
 	}
 
+#ifdef ARDJACK_INCLUDE_METRICS
+	case ARDJACK_OPERATION_GET_METRICS:
+	{
+		// Send one response per Metric, or just for the Metric named.
+		char temp[100];
+
+		if (strlen(aName) > 0)
+		{
+			Metric* metric = Metrics::LookupMetric(aName);
+
+			if (NULL == metric)
+			{
+				sprintf(temp, PRM("%s GET_METRICS: No Metric '%s'"), dev->Name, aName);
+				dev->SendResponse(ARDJACK_OPERATION_ERROR, "", temp);
+				return false;
+			}
+
+			return dev->SendResponse(oper, metric->Name, metric->ToString(temp));
+		}
+
+		for (int i = 0; i < Metrics::Count; i++)
+		{
+			Metric* metric = &Metrics::Items[i];
+
+			if (!dev->SendResponse(oper, metric->Name, metric->ToString(temp)))
+				return false;
+		}
+
+		return true;
+	}
+#endif
+
 	case ARDJACK_OPERATION_GET_PART_CONFIG:
 	{
 		if (strlen(aName) == 0)
@@ -329,15 +370,16 @@ bool DeviceManager::ExecuteDeviceOperation(Device* dev, const char* text, int op
 
 	case ARDJACK_OPERATION_READ:
 	{
+		// A Part name is a single read (as before, anything after it that isn't a Part expression is ignored), e.g.
+		//		?ai0
+		// Otherwise it's a bulk read, e.g.
+		//		?ai0 ai1 ai2
+		//		?allin
 		Part* part = dev->LookupPart(aName, true);
+		PartSelector selector;
 
-		if (NULL == part)
-		{
-			char temp[80];
-			sprintf(temp, PRM("%s READ: Invalid Part expression '%s'"), dev->Name, aName);
-			dev->SendResponse(ARDJACK_OPERATION_ERROR, "", temp);
-			return false;
-		}
+		if ((NULL == part) || ((values->Count > 0) && dev->FindParts(values->Get(0), &selector, true)))
+			return ReadParts(dev, aName, values);
 
 		Dynamic value;
 		dev->Read(part, &value);
@@ -366,6 +408,11 @@ bool DeviceManager::ExecuteDeviceOperation(Device* dev, const char* text, int op
 
 	case ARDJACK_OPERATION_WRITE:
 	{
+		// No Part name means a bulk write of 'name=value' items, e.g.
+		//		!do0=1 do1=0 do2=1
+		if (strlen(aName) == 0)
+			return WriteParts(dev, values);
+
 		int partType;
 
 		Part* part = dev->LookupPart(aName, true);
@@ -450,7 +497,15 @@ bool DeviceManager::HandleDeviceRequest(Device* dev, const char* text)
 		return false;
 	}
 
+#ifdef ARDJACK_INCLUDE_METRICS
+	unsigned long startUs = Utils::NowUs();
+	bool result = ExecuteDeviceOperation(dev, text, oper, aName, &values);
+	Metrics::Items[ARDJACK_METRIC_DEVICE_OPERATION].Record(Utils::NowUs() - startUs);
+
+	return result;
+#else
 	return ExecuteDeviceOperation(dev, text, oper, aName, &values);
+#endif
 }
 
 
@@ -604,14 +659,54 @@ int DeviceManager::LookupSubtype(const char* name)
 }
 
 
+bool DeviceManager::ReadParts(Device* dev, const char* aName, StringList* values)
+{
+	// Read the Parts of expressions 'aName' and 'values' (each a PART name, a PART TYPE name or "ALL" / "*" / "ALLIN"
+	// etc.) as one operation, sending their values in as few 'parts' responses as fit, e.g. 'parts ai0=512 ai1=3'.
+	PartSelector selector;
+
+	// Check every expression before reading anything.
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = -1; i < values->Count; i++)
+		{
+			const char* expr = (i < 0) ? aName : values->Get(i);
+
+			if (!dev->FindParts(expr, &selector, true) || (NULL == dev->NextPart(&selector)))
+			{
+				char temp[100];
+				snprintf(temp, sizeof(temp), PRM("%s READ: Invalid Part expression '%s'"), dev->Name, expr);
+				dev->SendResponse(ARDJACK_OPERATION_ERROR, "", temp);
+
+				return false;
+			}
+
+			if (pass == 0)
+				continue;
+
+			// Visit the Parts again, from the start.
+			dev->FindParts(expr, &selector, true);
+
+			if (!dev->ReadParts(&selector))
+				return false;
+		}
+	}
+
+	return dev->FlushNotifyBatch();
+}
+
+
 
 bool DeviceManager::SubscribePart(Device* dev, char* expr, bool newState)
 {
 	// 'expr' can be a PART name, a PART TYPE name, or "ALL" / "*" / "ALLIN".
-	Part* parts[ARDJACK_MAX_PARTS];
-	uint8_t count;
+	PartSelector selector;
+	Part* part = NULL;
+
+	if (dev->FindParts(expr, &selector))
+		part = dev->NextPart(&selector);
 
-	if (!dev->GetParts(expr, parts, &count) || (count == 0))
+	if (NULL == part)
 	{
 		// 'expr' not recognised, or no such Parts.
 		char temp[100];
@@ -627,10 +722,8 @@ bool DeviceManager::SubscribePart(Device* dev, char* expr, bool newState)
 	}
 
 	// Subscribe/unsubscribe all Parts.
-	for (int i = 0; i < count; i++)
+	for (; NULL != part; part = dev->NextPart(&selector))
 	{
-		Part* part = parts[i];
-
 		// Only subscribe if the Part's an input.
 		if (part->IsInput())
 			dev->SetNotify(part, newState);
@@ -642,3 +735,68 @@ bool DeviceManager::SubscribePart(Device* dev, char* expr, bool newState)
 	return dev->SendResponse(oper, expr, "");
 }
 
+
+bool DeviceManager::WriteParts(Device* dev, StringList* values)
+{
+	// Write each 'name=value' item in 'values' as one operation, where 'name' is a PART name, a PART TYPE name or
+	// "ALL" / "*" / "ALLOUT" etc.
+	PartSelector selector;
+	char expr[ARDJACK_MAX_NAME_LENGTH];
+	Dynamic value;
+
+	if (values->Count == 0)
+	{
+		char temp[80];
+		sprintf(temp, PRM("%s WRITE: No Part name"), dev->Name);
+		dev->SendResponse(ARDJACK_OPERATION_ERROR, "", temp);
+
+		return false;
+	}
+
+	// Check every item before writing anything.
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = 0; i < values->Count; i++)
+		{
+			const char* item = values->Get(i);
+			const char* equals = strchr(item, '=');
+			int length = (NULL == equals) ? 0 : (int)(equals - item);
+			Part* part = NULL;
+
+			if ((length > 0) && (length < ARDJACK_MAX_NAME_LENGTH))
+			{
+				strncpy(expr, item, length);
+				expr[length] = NULL;
+
+				if (dev->FindParts(expr, &selector, true))
+					part = dev->NextPart(&selector);
+			}
+
+			if (NULL == part)
+			{
+				char temp[100];
+				snprintf(temp, sizeof(temp), PRM("%s WRITE: Invalid item '%s'"), dev->Name, item);
+				dev->SendResponse(ARDJACK_OPERATION_ERROR, "", temp);
+
+				return false;
+			}
+
+			if (pass == 0)
+				continue;
+
+			value.SetString(equals + 1);
+
+			for (; NULL != part; part = dev->NextPart(&selector))
+			{
+				if (!dev->Write(part, &value))
+				{
+					Log::LogErrorF(PRM("WriteParts: Failed to Write, Device '%s', Part '%s', value '%s'"),
+						dev->Name, part->Name, value.String());
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
@@ -37,7 +37,9 @@ class DeviceManager : public IoTManager
 protected:
 	virtual Part* AddPart(Device* dev, const char* text, const char* name, StringList* values);
 	virtual bool InteractAction(Device* dev, const char* text, bool* handled);
+	virtual bool ReadParts(Device* dev, const char* aName, StringList* values);
 	virtual bool SubscribePart(Device* dev, char* aName, bool newState);
+	virtual bool WriteParts(Device* dev, StringList* values);
 
 public:
 	DeviceManager();
@@ -52,14 +52,17 @@
 #include "Dynamic.h"
 #include "Enumeration.h"
 #include "FieldReplacer.h"
+#include "FifoBuffer.h"
 #include "Filter.h"
 #include "FilterManager.h"
 #include "Globals.h"
 #include "HttpConnection.h"
 #include "Route.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Part.h"
 #include "PartManager.h"
+#include "PollProfiler.h"
 #include "SerialConnection.h"
 #include "Shield.h"
 #include "StringList.h"
@@ -163,6 +166,45 @@ bool Displayer::DisplayActive(IoTObject* obj)
 #endif
 
 
+bool Displayer::DisplayBuffer(const char* name, FifoBuffer* buffer, BufferDrainStats* stats)
+{
+	Log::LogInfoF(PRM("  %-10s  depth %d, high water %d, overflows %ld"), name, buffer->Count(), buffer->HighWater,
+		buffer->Overflows);
+
+	if (NULL != stats)
+		DisplayDrainStats(stats);
+
+	return true;
+}
+
+
+bool Displayer::DisplayBuffers()
+{
+	DisplayHeader(PRM("BUFFERS"));
+
+	Log::LogInfoF(PRM("  Drain budget: %d items, %d ms, %d output bytes per tick (0 = no limit)"), Globals::DrainMaxItems,
+		Globals::DrainMaxMs, Globals::DrainMaxBytes);
+
+	DisplayBuffer(PRM("Commands"), Globals::CommandBuffer, &Globals::CommandDrainStats);
+	DisplayBuffer(PRM("Devices"), Globals::DeviceBuffer, &Globals::DeviceDrainStats);
+
+	// Each Connection has its own output queue, and they're drained together.
+	ConnectionManager* mgr = Globals::ConnectionMgr;
+
+	Log::LogInfoF(PRM("  %-10s  %d Connection queues"), PRM("Output"), mgr->OutputQueueCount);
+	DisplayDrainStats(&Globals::OutputDrainStats);
+
+	for (int i = 0; i < mgr->OutputQueueCount; i++)
+	{
+		Connection* conn = mgr->OutputQueues[i];
+		DisplayBuffer(conn->Name, conn->UseOutputQueue());
+		conn->ReleaseOutputQueue();
+	}
+
+	return true;
+}
+
+
 bool Displayer::DisplayConnection(Connection* conn)
 {
 	DisplayHeader(PRM("CONNECTION"), conn->Name);
@@ -170,8 +212,45 @@ bool Displayer::DisplayConnection(Connection* conn)
 	Log::LogInfo("Active: ", Utils::Bool2yesno(conn->Active()));
 
 	Log::LogInfoF(PRM("RX: %d events (%d chars)"), conn->RxEvents, conn->RxCount);
+
+	if (conn->RxPolls > 0)
+	{
+		Log::LogInfoF(PRM("RX batches: %d polls, mean %d.%02d, last %d, max %d"), conn->RxPolls,
+			conn->RxEvents / conn->RxPolls, (100 * (conn->RxEvents % conn->RxPolls)) / conn->RxPolls,
+			conn->RxBatchLast, conn->RxBatchMax);
+	}
 	Log::LogInfoF(PRM("TX: %d events (%d chars)"), conn->TxEvents, conn->TxCount);
 
+	if (conn->TxFlushes > 0)
+		Log::LogInfoF(PRM("TX batches: %d flushes, %d datagrams"), conn->TxFlushes, conn->TxDatagrams);
+
+	Log::LogInfoF(PRM("Routing: %d routed, %d unrouted, %d dropped"), conn->RoutedMessages, conn->UnroutedMessages,
+		conn->DroppedMessages);
+
+	const char* policy = PRM("DropNewest");
+
+	if (conn->OverflowPolicy == ARDJACK_OUTPUT_OVERFLOW_COALESCE)
+		policy = PRM("Coalesce");
+	else if (conn->OverflowPolicy == ARDJACK_OUTPUT_OVERFLOW_DROP_OLDEST)
+		policy = PRM("DropOldest");
+
+	Log::LogInfoF(PRM("Output overflow: %s, %d newest dropped, %d oldest dropped, %d coalesced"), policy,
+		conn->DroppedNewest, conn->DroppedOldest, conn->Coalesced);
+
+	FifoBuffer* queue = conn->UseOutputQueue();
+
+	if (NULL != queue)
+		Log::LogInfoF(PRM("Output queue: depth %d of %d, high water %d"), queue->Count(), queue->Capacity, queue->HighWater);
+
+	conn->ReleaseOutputQueue();
+
+	if (conn->OutputSent > 0)
+	{
+		Log::LogInfoF(PRM("Output latency: %ld sent, last %lu us, mean %lu us, max %lu us"), conn->OutputSent,
+			conn->OutputLatencyLastUs, (unsigned long)(conn->OutputLatencyTotalUs / conn->OutputSent),
+			conn->OutputLatencyMaxUs);
+	}
+
 	conn->Config->LogIt();
 
 	Log::LogInfo(PRM("ROUTES"));
@@ -352,6 +431,15 @@ bool Displayer::DisplayDevices()
 }
 
 
+bool Displayer::DisplayDrainStats(BufferDrainStats* stats)
+{
+	Log::LogInfoF(PRM("              items %ld, busy ticks %ld, items/tick last %d max %d, budget stops %ld"),
+		stats->Items, stats->Ticks, stats->LastTickItems, stats->MaxTickItems, stats->BudgetStops);
+
+	return true;
+}
+
+
 bool Displayer::DisplayFilter(Filter* filter)
 {
 	DisplayHeader(PRM("FILTER"), filter->Name);
@@ -433,6 +521,9 @@ bool Displayer::DisplayItem(const char* args)
 			DisplayBridges();
 #endif
 
+		else if (Utils::StringEquals(item, "BUFFERS"))
+			DisplayBuffers();
+
 		else if (Utils::StringEquals(item, "CONNECTIONS"))
 			DisplayConnections();
 
@@ -453,12 +544,22 @@ bool Displayer::DisplayItem(const char* args)
 		else if (Utils::StringEquals(item, "MEMORY"))
 			DisplayMemory();
 
+#ifdef ARDJACK_INCLUDE_METRICS
+		else if (Utils::StringEquals(item, "METRICS"))
+			DisplayMetrics();
+#endif
+
 		else if (Utils::StringEquals(item, "NET") || Utils::StringEquals(item, "NETWORK"))
 			DisplayNetwork();
 
 		else if (Utils::StringEquals(item, "OBJECTS"))
 			DisplayObjects(false);
 
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+		else if (Utils::StringEquals(item, "POLL"))
+			DisplayPoll();
+#endif
+
 		else if (Utils::StringEquals(item, "SIZES"))
 			DisplaySizes();
 
@@ -539,6 +640,75 @@ bool Displayer::DisplayMemory()
 }
 
 
+#ifdef ARDJACK_INCLUDE_METRICS
+	bool Displayer::DisplayMetrics()
+	{
+		DisplayHeader(PRM("METRICS"));
+
+		Table table;
+		table.AddColumn("Metric", 18);
+		table.AddColumn("Type", 10);
+		table.AddColumn("Value", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Count", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Mean us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("p50 us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("p99 us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Max", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+
+		char line[202];
+		Log::LogInfo(table.HorizontalLine(line));
+		Log::LogInfo(table.Header(line));
+		Log::LogInfo(table.HorizontalLine(line));
+
+		char count[24];
+		char max[24];
+		char mean[24];
+		char p50[24];
+		char p99[24];
+		char value[24];
+
+		for (int i = 0; i < Metrics::Count; i++)
+		{
+			Metric* metric = &Metrics::Items[i];
+
+			count[0] = NULL;
+			max[0] = NULL;
+			mean[0] = NULL;
+			p50[0] = NULL;
+			p99[0] = NULL;
+			value[0] = NULL;
+
+			switch (metric->Type)
+			{
+			case ARDJACK_METRIC_TYPE_GAUGE:
+				sprintf(value, "%ld", metric->Value);
+				sprintf(max, "%lu", metric->Max);
+				break;
+
+			case ARDJACK_METRIC_TYPE_HISTOGRAM:
+				sprintf(count, "%lu", metric->Count);
+				sprintf(mean, "%lu", metric->Mean());
+				sprintf(p50, "%lu", metric->Percentile(50));
+				sprintf(p99, "%lu", metric->Percentile(99));
+				sprintf(max, "%lu", metric->Max);
+				break;
+
+			default:
+				sprintf(value, "%ld", metric->Value);
+				break;
+			}
+
+			Log::LogInfo(table.Row(line, metric->Name, Metrics::TypeName(metric->Type), value, count, mean, p50, p99, max));
+		}
+
+		Log::LogInfo(table.HorizontalLine(line));
+		Log::LogInfo();
+
+		return true;
+	}
+#endif
+
+
 bool Displayer::DisplayNetwork()
 {
 	DisplayHeader(PRM("NETWORK"));
@@ -631,7 +801,7 @@ bool Displayer::DisplayObject(IoTObject* obj)
 }
 
 
-bool Displayer::DisplayObject2(char* text, bool quiet)
+bool Displayer::DisplayObject2(const char* text, bool quiet)
 {
 	// If 'text' is an Object name, or 'Device.Part' syntax, display the corresponding item.
 	char fields2[2][ARDJACK_MAX_VALUE_LENGTH];
@@ -775,6 +945,118 @@ bool Displayer::DisplayPart(Device* dev, Part* part)
 }
 
 
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	bool Displayer::DisplayPoll()
+	{
+		DisplayHeader(PRM("POLL"));
+
+		// List the polled objects, the most time-consuming first.
+		Register* reg = Globals::ObjectRegister;
+		int order[ARDJACK_MAX_OBJECTS];
+		int count = 0;
+		double grandTotalUs = 0.0;
+
+		for (int i = 0; i < reg->ObjectCount; i++)
+		{
+			PollStats* stats = &reg->Objects[i]->PollProfile;
+			if (stats->Polls == 0) continue;
+
+			grandTotalUs += stats->TotalUs;
+
+			int j = count++;
+
+			while ((j > 0) && (reg->Objects[order[j - 1]]->PollProfile.TotalUs < stats->TotalUs))
+			{
+				order[j] = order[j - 1];
+				j--;
+			}
+
+			order[j] = i;
+		}
+
+		Table table;
+		table.AddColumn("Object", 16);
+		table.AddColumn("Type", 12);
+		table.AddColumn("Polls", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Mean us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Max us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Last us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Total ms", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		table.AddColumn("Share %", 9, ARDJACK_HORZ_ALIGN_RIGHT);
+
+		char line[202];
+		Log::LogInfo(table.HorizontalLine(line));
+		Log::LogInfo(table.Header(line));
+		Log::LogInfo(table.HorizontalLine(line));
+
+		char last[24];
+		char max[24];
+		char mean[24];
+		char polls[24];
+		char share[24];
+		char total[24];
+
+		for (int i = 0; i < count; i++)
+		{
+			IoTObject* obj = reg->Objects[order[i]];
+			PollStats* stats = &obj->PollProfile;
+			unsigned long totalUs = (unsigned long)stats->TotalUs;
+
+			sprintf(polls, "%ld", stats->Polls);
+			sprintf(mean, "%lu", totalUs / stats->Polls);
+			sprintf(max, "%lu", stats->MaxUs);
+			sprintf(last, "%lu", stats->LastUs);
+			sprintf(total, "%lu.%lu", totalUs / 1000, (totalUs / 100) % 10);
+			sprintf(share, "%d", (grandTotalUs > 0.0) ? (int)(100.0 * stats->TotalUs / grandTotalUs + 0.5) : 0);
+
+			Log::LogInfo(table.Row(line, obj->Name, reg->ObjectTypeName(obj->Type), polls, mean, max, last, total, share));
+		}
+
+		Log::LogInfo(table.HorizontalLine(line));
+		Log::LogInfo();
+
+		// The host's timers - a tick is skipped if the previous one is still running, and overruns if it takes
+		// longer than the timer's period.
+		Table timerTable;
+		timerTable.AddColumn("Timer", 16);
+		timerTable.AddColumn("Period ms", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		timerTable.AddColumn("Ticks", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		timerTable.AddColumn("Skipped", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		timerTable.AddColumn("Overruns", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		timerTable.AddColumn("Mean us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+		timerTable.AddColumn("Max us", 10, ARDJACK_HORZ_ALIGN_RIGHT);
+
+		Log::LogInfo(timerTable.HorizontalLine(line));
+		Log::LogInfo(timerTable.Header(line));
+		Log::LogInfo(timerTable.HorizontalLine(line));
+
+		char overruns[24];
+		char period[24];
+		char skipped[24];
+
+		for (int i = 0; i < PollProfiler::TimerCount; i++)
+		{
+			PollTimer* timer = &PollProfiler::Timers[i];
+			PollStats* stats = &timer->Stats;
+
+			sprintf(period, "%d", timer->PeriodMs);
+			sprintf(polls, "%ld", stats->Polls);
+			sprintf(skipped, "%ld", stats->Skipped);
+			sprintf(overruns, "%ld", stats->Overruns);
+			sprintf(mean, "%lu", (stats->Polls > 0) ? (unsigned long)(stats->TotalUs / stats->Polls) : 0UL);
+			sprintf(max, "%lu", stats->MaxUs);
+
+			Log::LogInfo(timerTable.Row(line, timer->Name, period, polls, skipped, overruns, mean, max));
+		}
+
+		Log::LogInfo(timerTable.HorizontalLine(line));
+		Log::LogInfo();
+
+		return true;
+	}
+#endif
+
+
 bool Displayer::DisplaySize(const char* caption, int size)
 {
 	char temp[10];
@@ -54,6 +54,8 @@ public:
 	static bool DisplayBridge(Bridge* bridge);
 	static bool DisplayBridges();
 #endif
+	static bool DisplayBuffer(const char* name, FifoBuffer* buffer, BufferDrainStats* stats = NULL);
+	static bool DisplayBuffers();
 	static bool DisplayConnection(Connection* conn);
 	static bool DisplayConnections();
 #ifdef ARDJACK_INCLUDE_DATALOGGERS
@@ -62,19 +64,26 @@ public:
 #endif
 	static bool DisplayDevice(Device* dev);
 	static bool DisplayDevices();
+	static bool DisplayDrainStats(BufferDrainStats* stats);
 	static bool DisplayFilter(Filter* filter);
 	static bool DisplayFilters();
 	static bool DisplayItem(const char* args);
 	static bool DisplayMacros();
 	static bool DisplayMemory();
+#ifdef ARDJACK_INCLUDE_METRICS
+	static bool DisplayMetrics();
+#endif
 	static bool DisplayNetwork();
 #ifdef ARDJACK_NETWORK_AVAILABLE
 	static bool DisplayNetworkInterface(NetworkInterface* net);
 #endif
 	static bool DisplayObject(IoTObject* obj);
-	static bool DisplayObject2(char* text, bool quiet = false);
+	static bool DisplayObject2(const char* text, bool quiet = false);
 	static bool DisplayObjects(bool activeOnly);
 	static bool DisplayPart(Device* dev, Part* part);
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	static bool DisplayPoll();
+#endif
 	static bool DisplaySize(const char* caption, int size);
 	static bool DisplaySizes();
 	static bool DisplayStatus();
@@ -143,6 +143,7 @@ char* Dynamic::AsString(char* value)
 
 	case ARDJACK_DATATYPE_STRING:
 		strcpy(value, _StringVal);
+		break;
 
 	default:
 		strcpy(value, "");
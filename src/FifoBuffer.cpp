@@ -25,7 +25,10 @@
 
 #include "pch.h"
 
-#ifdef ARDUINO
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	#include "stdafx.h"
+	#include "LockFreeQueue.h"
+#elif defined(ARDUINO) || defined(ARDJACK_LINUX)
 	#include "cppQueue.h"
 #else
 	#include "stdafx.h"
@@ -43,7 +46,13 @@ FifoBuffer::FifoBuffer(int size, int count)
 	if (Globals::Verbosity > 7)
 		Log::LogInfoF(PRM("FifoBuffer ctor: %p, size %d, count %d"), this, size, count);
 
-#ifdef ARDUINO
+	Capacity = count;
+	HighWater = 0;
+	Overflows = 0;
+
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	_Queue = new LockFreeQueue(size, count);
+#elif defined(ARDUINO) || defined(ARDJACK_LINUX)
 	_Queue = new Queue(size, count, FIFO, false);
 #else
 	_RingBuf = RingBuf_new(size, count);
@@ -56,7 +65,7 @@ FifoBuffer::~FifoBuffer()
 	if (Globals::Verbosity > 7)
 		Log::LogInfoF(PRM("FifoBuffer ~: %p"), this);
 
-#ifdef ARDUINO
+#if defined(ARDUINO) || defined(ARDJACK_LINUX) || defined(ARDJACK_INCLUDE_LOCKFREE_QUEUES)
 	if (NULL != _Queue)
 		delete _Queue;
 #else
@@ -66,9 +75,23 @@ FifoBuffer::~FifoBuffer()
 }
 
 
+int FifoBuffer::Count()
+{
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	return _Queue->Count();
+#elif defined(ARDUINO) || defined(ARDJACK_LINUX)
+	return _Queue->getCount();
+#else
+	return _RingBuf->numElements(_RingBuf);
+#endif
+}
+
+
 bool FifoBuffer::IsEmpty()
 {
-#ifdef ARDUINO
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	return _Queue->Count() == 0;
+#elif defined(ARDUINO) || defined(ARDJACK_LINUX)
 	return _Queue->isEmpty();
 #else
 	return _RingBuf->isEmpty(_RingBuf);
@@ -78,7 +101,9 @@ bool FifoBuffer::IsEmpty()
 
 bool FifoBuffer::IsFull()
 {
-#ifdef ARDUINO
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	return _Queue->Count() >= _Queue->Capacity();
+#elif defined(ARDUINO) || defined(ARDJACK_LINUX)
 	return _Queue->isFull();
 #else
 	return _RingBuf->isFull(_RingBuf);
@@ -86,38 +111,63 @@ bool FifoBuffer::IsFull()
 }
 
 
-bool FifoBuffer::Pop(void* obj)
+bool FifoBuffer::Pop(void* obj, bool quiet)
 {
-	if (IsEmpty())
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	// Test and take the item in one step, as other threads may be pushing or popping.
+	bool result = _Queue->Pop(obj);
+#else
+	bool result = !IsEmpty();
+
+	if (result)
 	{
-		Log::LogWarningF(PRM("FifoBuffer::Pop: %p, buffer empty"), this);
-		return false;
+	#if defined(ARDUINO) || defined(ARDJACK_LINUX)
+		(void *) _Queue->pull(obj);
+	#else
+		(void *) _RingBuf->pull(_RingBuf, obj);
+	#endif
 	}
-
-#ifdef ARDUINO
-	(void *) _Queue->pull(obj);
-#else
-	(void *) _RingBuf->pull(_RingBuf, obj);
 #endif
 
-	return true;
+	if (!result && !quiet)
+		Log::LogWarningF(PRM("FifoBuffer::Pop: %p, buffer empty"), this);
+
+	return result;
 }
 
 
-bool FifoBuffer::Push(const void* obj)
+bool FifoBuffer::Push(const void* obj, bool quiet)
 {
-	if (IsFull())
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	// Test and add the item in one step, as other threads may be pushing or popping.
+	bool result = _Queue->Push(obj);
+#else
+	bool result = !IsFull();
+
+	if (result)
+	{
+	#if defined(ARDUINO) || defined(ARDJACK_LINUX)
+		_Queue->push(obj);
+	#else
+		_RingBuf->add(_RingBuf, obj);
+	#endif
+	}
+#endif
+
+	if (!result)
 	{
-		Log::LogWarningF(PRM("FifoBuffer::Push: %p, buffer full"), this);
+		Overflows++;
+
+		if (!quiet)
+			Log::LogWarningF(PRM("FifoBuffer::Push: %p, buffer full"), this);
+
 		return false;
 	}
 
-#ifdef ARDUINO
-	_Queue->push(obj);
-#else
-	_RingBuf->add(_RingBuf, obj);
-#endif
+	int count = Count();
+
+	if (count > HighWater)
+		HighWater = count;
 
 	return true;
 }
-
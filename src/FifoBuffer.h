@@ -28,6 +28,16 @@
 #ifdef ARDUINO
 	#include <arduino.h>
 
+	class Queue;
+#elif defined(ARDJACK_INCLUDE_LOCKFREE_QUEUES)
+	#include "stdafx.h"
+
+	// Hosts use a 'LockFreeQueue', as their buffers are shared between threads.
+	class LockFreeQueue;
+#elif defined(ARDJACK_LINUX)
+	#include "stdafx.h"
+
+	// The Linux host uses 'cppQueue', as on Arduino.
 	class Queue;
 #else
 	#include "stdafx.h"
@@ -39,18 +49,25 @@
 class FifoBuffer
 {
 protected:
-#ifdef ARDUINO
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	LockFreeQueue* _Queue;
+#elif defined(ARDUINO) || defined(ARDJACK_LINUX)
 	Queue* _Queue;
 #else
 	RingBuf* _RingBuf;
 #endif
 
 public:
+	int Capacity;											// max.no.of items
+	int HighWater;											// max.no.of items held at once (approximate with several producers)
+	long Overflows;											// no.of items rejected because the buffer was full (ditto)
+
 	FifoBuffer(int size, int count);
 	~FifoBuffer();
 
+	int Count();
 	bool IsEmpty();
 	bool IsFull();
-	bool Pop(void* obj);
-	bool Push(const void* obj);
+	bool Pop(void* obj, bool quiet = false);
+	bool Push(const void* obj, bool quiet = false);
 };
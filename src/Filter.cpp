@@ -43,8 +43,6 @@
 Filter::Filter(const char* name)
 	: IoTObject(name)
 {
-	Config = new Configuration();
-
 	_MaxInterval = 1000;
 	_MinDiff = 2.5;
 	_MinInterval = 100;
@@ -53,7 +51,6 @@ Filter::Filter(const char* name)
 
 Filter::~Filter()
 {
-	delete Config;
 }
 
 
@@ -90,9 +87,13 @@ bool Filter::AddConfig()
 
 bool Filter::ApplyConfig(bool quiet)
 {
-	Config->GetAsInteger("MaxInt", &_MaxInterval);
-	Config->GetAsReal("MinDiff", &_MinDiff);
-	Config->GetAsInteger("MinInt", &_MinInterval);
+	static ConfigHandle maxIntHandle = { "MaxInt" };
+	static ConfigHandle minDiffHandle = { "MinDiff" };
+	static ConfigHandle minIntHandle = { "MinInt" };
+
+	Config->GetAsInteger(&maxIntHandle, &_MaxInterval);
+	Config->GetAsReal(&minDiffHandle, &_MinDiff);
+	Config->GetAsInteger(&minIntHandle, &_MinInterval);
 
 	return true;
 }
@@ -52,6 +52,7 @@
 #include "HttpConnection.h"
 #include "Route.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Part.h"
 #include "PartManager.h"
 #include "Register.h"
@@ -66,6 +67,8 @@
 	#else
 		#include "ArduinoClock.h"
 	#endif
+#elif defined(ARDJACK_LINUX)
+	#include "LinuxClock.h"
 #else
 	#include "ClipboardConnection.h"
 	#include "WinClock.h"
@@ -87,6 +90,7 @@ char Globals::AppName[] = "";
 //bool Globals::AutoClearCommandLine = false;
 IoTClock* Globals::Clock = NULL;
 FifoBuffer* Globals::CommandBuffer = NULL;
+BufferDrainStats Globals::CommandDrainStats;
 char Globals::CommandPrefix[] = "";
 char Globals::CommandSeparator[] = "";
 CommandSet* Globals::CommandSet0 = NULL;
@@ -97,7 +101,11 @@ char Globals::ComputerName[] = "";
 ConnectionManager* Globals::ConnectionMgr = NULL;
 FifoBuffer* Globals::DeviceBuffer = NULL;
 DeviceCodec1* Globals::DeviceCodec = NULL;
+BufferDrainStats Globals::DeviceDrainStats;
 DeviceManager* Globals::DeviceMgr = NULL;
+int Globals::DrainMaxBytes = ARDJACK_DRAIN_MAX_BYTES;
+int Globals::DrainMaxItems = ARDJACK_DRAIN_MAX_ITEMS;
+int Globals::DrainMaxMs = ARDJACK_DRAIN_MAX_MS;
 char Globals::EmptyString[] = "";
 bool Globals::EnableSound = false;
 char Globals::ExecPrefix[] = "";
@@ -123,6 +131,7 @@ bool Globals::NetworkAvailable = false;
 IoTManager* Globals::ObjectMgr = NULL;
 Register* Globals::ObjectRegister = NULL;
 char Globals::OneCommandPrefix[] = "";
+BufferDrainStats Globals::OutputDrainStats;
 PartManager* Globals::PartMgr = NULL;
 //FifoBuffer *Globals::RequestBuffer = NULL;
 bool Globals::RtcAvailable = false;
@@ -291,42 +300,89 @@ IoTObject* Globals::AddObject(int type, int subtype, const char* name)
 
 bool Globals::CheckCommandBuffer()
 {
+	// Execute queued commands until the buffer is empty or the drain budget is used up.
+	// Commands queued while draining wait for the next tick.
 	if (CommandBuffer->IsEmpty())
 		return true;
 
+	int maxCount = CommandBuffer->Count();
+	if ((DrainMaxItems > 0) && (DrainMaxItems < maxCount))
+		maxCount = DrainMaxItems;
+
 	CommandBufferItem item;
+	int count = 0;
+	bool result = true;
+	long startMs = Utils::NowMs();
 
-	if (!CommandBuffer->Pop(&item))
-		return true;
+	while (DrainBudgetLeft(count, maxCount, startMs) && !CommandBuffer->IsEmpty())
+	{
+		if (!CommandBuffer->Pop(&item))
+			break;
+
+		count++;
+
+		if (Globals::Verbosity > 7)
+			Log::LogInfoF(PRM("Globals::CheckCommandBuffer: '%s'"), item.Text);
+
+		if (!Interpreter->Execute(item.Text))
+			result = false;
+	}
 
-	if (Globals::Verbosity > 7)
-		Log::LogInfoF(PRM("Globals::CheckCommandBuffer: '%s'"), item.Text);
+	UpdateDrainStats(&CommandDrainStats, count, !CommandBuffer->IsEmpty());
 
-	return Interpreter->Execute(item.Text);
+	return result;
 }
 
 
 bool Globals::CheckDeviceBuffer()
 {
+	// Handle queued Device requests until the buffer is empty or the drain budget is used up.
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Items[ARDJACK_METRIC_DEVICE_QUEUED].SetLevel(DeviceBuffer->Count());
+#endif
+
 	if (DeviceBuffer->IsEmpty())
 		return true;
 
-	CommandBufferItem item;
+	int maxCount = DeviceBuffer->Count();
+	if ((DrainMaxItems > 0) && (DrainMaxItems < maxCount))
+		maxCount = DrainMaxItems;
 
-	if (!DeviceBuffer->Pop(&item))
-		return true;
+	CommandBufferItem item;
+	int count = 0;
+	bool result = true;
+	long startMs = Utils::NowMs();
 
-	if (NULL == item.Dev)
+	while (DrainBudgetLeft(count, maxCount, startMs) && !DeviceBuffer->IsEmpty())
 	{
+		if (!DeviceBuffer->Pop(&item))
+			break;
+
+		count++;
+
+#ifdef ARDJACK_INCLUDE_METRICS
+		Metrics::Items[ARDJACK_METRIC_DEVICE_QUEUE].Record(Utils::NowUs() - item.QueuedUs);
+#endif
+
+		if (NULL == item.Dev)
+		{
+			if (Globals::Verbosity > 7)
+				Log::LogWarning(PRM("CheckDeviceBuffer: '"), item.Text, "' - NO DEVICE");
+
+			result = false;
+			continue;
+		}
+
 		if (Globals::Verbosity > 7)
-			Log::LogWarning(PRM("CheckDeviceBuffer: '"), item.Text, "' - NO DEVICE");
-		return false;
+			Log::LogInfo(PRM("CheckDeviceBuffer: Device '"), item.Dev->Name, "', '", item.Text, "'");
+
+		if (!Globals::HandleDeviceRequest(item.Dev, item.Text))
+			result = false;
 	}
 
-	if (Globals::Verbosity > 7)
-		Log::LogInfo(PRM("CheckDeviceBuffer: Device '"), item.Dev->Name, "', '", item.Text, "'");
+	UpdateDrainStats(&DeviceDrainStats, count, !DeviceBuffer->IsEmpty());
 
-	return Globals::HandleDeviceRequest(item.Dev, item.Text);
+	return result;
 }
 
 
@@ -387,6 +443,19 @@ bool Globals::DeleteSingleObject(IoTObject* obj)
 }
 
 
+bool Globals::DrainBudgetLeft(int count, int maxCount, long startMs)
+{
+	// Can a buffer drain which started at 'startMs' and has handled 'count' items continue?
+	if (count >= maxCount)
+		return false;
+
+	if ((DrainMaxMs > 0) && (count > 0) && (Utils::NowMs() - startMs >= DrainMaxMs))
+		return false;
+
+	return true;
+}
+
+
 bool Globals::HandleDeviceRequest(Device* dev, const char* line)
 {
 	// Create a request message to assist development.
@@ -406,6 +475,14 @@ bool Globals::Init()
 	strcpy(AppName, PRM("ArdJack"));
 	strcpy(ComputerName, ARDJACK_BOARD_TYPE);
 	_strlwr(ComputerName);
+#elif defined(ARDJACK_LINUX)
+	strcpy(AppName, PRM("ArdJackL"));
+	Utils::GetAppDocsFolder(AppDocsFolder, MAX_PATH);
+	gethostname(ComputerName, ARDJACK_MAX_NAME_LENGTH - 3);
+	ComputerName[ARDJACK_MAX_NAME_LENGTH - 3] = NULL;
+
+	// Modify the name to distinguish this program when used with IoTJack.
+	strcat(ComputerName, PRM("_A"));
 #else
 	strcpy(AppName, PRM("ArdJackW"));
 	Utils::GetAppDocsFolder(AppDocsFolder, MAX_PATH);
@@ -449,6 +526,10 @@ bool Globals::Init()
 	DataLoggerMgr = new DataLoggerManager();
 #endif
 
+#ifdef ARDJACK_INCLUDE_METRICS
+	Metrics::Init();
+#endif
+
 #ifdef ARDJACK_INCLUDE_PERSISTENCE
 	PersistentFileMgr = new PersistentFileManager();
 #endif
@@ -527,6 +608,8 @@ bool Globals::Init()
 	#else
 		Clock = new ArduinoClock();
 	#endif
+#elif defined(ARDJACK_LINUX)
+	Clock = new LinuxClock();
 #else
 	Clock = new WinClock();
 #endif
@@ -607,6 +690,36 @@ bool Globals::Set(const char* name, const char* value, bool* handled)
 		return true;
 	}
 
+	if (Utils::StringEquals(useName, PRM("DRAINBYTES"), false))
+	{
+		Globals::DrainMaxBytes = Utils::String2Int(value, Globals::DrainMaxBytes);
+
+		if (Globals::Verbosity > 2)
+			Log::LogInfoF(PRM("DRAINBYTES set to %d"), Globals::DrainMaxBytes);
+
+		return true;
+	}
+
+	if (Utils::StringEquals(useName, PRM("DRAINITEMS"), false))
+	{
+		Globals::DrainMaxItems = Utils::String2Int(value, Globals::DrainMaxItems);
+
+		if (Globals::Verbosity > 2)
+			Log::LogInfoF(PRM("DRAINITEMS set to %d"), Globals::DrainMaxItems);
+
+		return true;
+	}
+
+	if (Utils::StringEquals(useName, PRM("DRAINMS"), false))
+	{
+		Globals::DrainMaxMs = Utils::String2Int(value, Globals::DrainMaxMs);
+
+		if (Globals::Verbosity > 2)
+			Log::LogInfoF(PRM("DRAINMS set to %d"), Globals::DrainMaxMs);
+
+		return true;
+	}
+
 	// Used?
 	//if (Utils::StringEquals(useName, PRM("EXECPREFIX"), false))
 	//{
@@ -727,6 +840,24 @@ bool Globals::SetupStandardRoutes(Connection* pConn)
 }
 
 
+void Globals::UpdateDrainStats(BufferDrainStats* stats, int count, bool itemsLeft)
+{
+	// Update 'stats' after a tick which processed 'count' items, leaving more queued if 'itemsLeft'.
+	if (count == 0)
+		return;
+
+	stats->Items += count;
+	stats->LastTickItems = count;
+	stats->Ticks++;
+
+	if (count > stats->MaxTickItems)
+		stats->MaxTickItems = count;
+
+	if (itemsLeft)
+		stats->BudgetStops++;
+}
+
+
 #ifdef ARDJACK_INCLUDE_PERSISTENCE
 
 bool Globals::LoadIniFile(const char* filename)
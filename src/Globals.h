@@ -48,12 +48,22 @@
 #undef ARDJACK_INCLUDE_ARDUINO_NEOPIXEL
 #undef ARDJACK_INCLUDE_BEACONS
 #undef ARDJACK_INCLUDE_BRIDGES
+#undef ARDJACK_INCLUDE_CONFIG_INDEX
 #undef ARDJACK_INCLUDE_DATALOGGERS
+#undef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+#undef ARDJACK_INCLUDE_METRICS
 #undef ARDJACK_INCLUDE_MULTI_PARTS
+#undef ARDJACK_INCLUDE_PART_INDEX
 #undef ARDJACK_INCLUDE_PERSISTENCE
+#undef ARDJACK_INCLUDE_POLL_PROFILER
+#undef ARDJACK_INCLUDE_REGISTER_INDEX
+#undef ARDJACK_INCLUDE_ROUTE_TABLE
+#undef ARDJACK_INCLUDE_SCRIPTS
 #undef ARDJACK_INCLUDE_SHIELDS
+#undef ARDJACK_INCLUDE_SIM_DEVICE
 #undef ARDJACK_INCLUDE_TESTS
 #undef ARDJACK_INCLUDE_THINKER_SHIELD
+#undef ARDJACK_INCLUDE_VERB_INDEX
 #undef ARDJACK_INCLUDE_WINDISK
 #undef ARDJACK_INCLUDE_WINMEMORY
 
@@ -64,23 +74,47 @@
 	//#define ARDJACK_INCLUDE_ARDUINO_NEOPIXEL
 	#define ARDJACK_INCLUDE_BEACONS
 	#define ARDJACK_INCLUDE_BRIDGES
+	//#define ARDJACK_INCLUDE_CONFIG_INDEX
 	#define ARDJACK_INCLUDE_DATALOGGERS
+	//#define ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	//#define ARDJACK_INCLUDE_METRICS
 	//#define ARDJACK_INCLUDE_MULTI_PARTS
+	//#define ARDJACK_INCLUDE_PART_INDEX
 	//#define ARDJACK_INCLUDE_PERSISTENCE
+	//#define ARDJACK_INCLUDE_POLL_PROFILER
+	//#define ARDJACK_INCLUDE_REGISTER_INDEX
+	//#define ARDJACK_INCLUDE_ROUTE_TABLE
+	//#define ARDJACK_INCLUDE_SCRIPTS
 	#define ARDJACK_INCLUDE_SHIELDS
+	//#define ARDJACK_INCLUDE_SIM_DEVICE
 	//#define ARDJACK_INCLUDE_TESTS
 	#define ARDJACK_INCLUDE_THINKER_SHIELD
+	//#define ARDJACK_INCLUDE_VERB_INDEX
 #else
 	#define ARDJACK_INCLUDE_BEACONS
 	#define ARDJACK_INCLUDE_BRIDGES
+	#define ARDJACK_INCLUDE_CONFIG_INDEX
 	#define ARDJACK_INCLUDE_DATALOGGERS
+	#define ARDJACK_INCLUDE_LOCKFREE_QUEUES
+	#define ARDJACK_INCLUDE_METRICS
 	//#define ARDJACK_INCLUDE_MULTI_PARTS
+	#define ARDJACK_INCLUDE_PART_INDEX
 	#define ARDJACK_INCLUDE_PERSISTENCE
+	#define ARDJACK_INCLUDE_POLL_PROFILER
+	#define ARDJACK_INCLUDE_REGISTER_INDEX
+	#define ARDJACK_INCLUDE_ROUTE_TABLE
+	#define ARDJACK_INCLUDE_SCRIPTS
 	#define ARDJACK_INCLUDE_SHIELDS
 	#define ARDJACK_INCLUDE_TESTS
 	#define ARDJACK_INCLUDE_THINKER_SHIELD
-	#define ARDJACK_INCLUDE_WINDISK
-	#define ARDJACK_INCLUDE_WINMEMORY
+	#define ARDJACK_INCLUDE_VERB_INDEX
+
+	#ifdef ARDJACK_LINUX
+		#define ARDJACK_INCLUDE_SIM_DEVICE
+	#else
+		#define ARDJACK_INCLUDE_WINDISK
+		#define ARDJACK_INCLUDE_WINMEMORY
+	#endif
 
 	#define ARDJACK_NETWORK_AVAILABLE
 #endif
@@ -88,6 +122,7 @@
 
 // Global limits / constants.
 
+#define ARDJACK_MAX_COALESCE_KEYS 16									// max.notification keys tracked by a coalescing Connection
 #define ARDJACK_MAX_COMMAND_BUFFER_ITEM_LENGTH 100						// max.no.of characters in a command
 #define ARDJACK_MAX_COMMAND_BUFFER_ITEMS 10								// max.items in a command buffer
 #define ARDJACK_MAX_COMMAND_LENGTH 110									// max.characters in a command
@@ -95,8 +130,8 @@
 #define ARDJACK_MAX_COMMANDS 24											// max.no.of commands
 #define ARDJACK_MAX_CONFIG_PROPERTIES 30								// max.no.of items in a Configuration
 #define ARDJACK_MAX_CONFIG_VALUE_LENGTH 40								// max.characters in a ConfigProp string
-#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEM_LENGTH 200			// max.characters in a Connection o/p buffer item
-#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS 10					// max.items in the Connection o/p buffer
+#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEM_LENGTH 200			// max.characters in a Connection o/p queue item
+#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS 10					// default items in a Connection's o/p queue ('OutputQueue')
 #define ARDJACK_MAX_DATALOGGER_PARTS 10
 #define ARDJACK_MAX_DESCRIPTION_LENGTH 60								// max.characters in a description
 #define ARDJACK_MAX_DEVICE_BUFFER_ITEMS 10								// max.items in a device buffer
@@ -113,27 +148,47 @@
 #define ARDJACK_MAX_MACRO_LENGTH 100									// max.characters in a Macro
 #define ARDJACK_MAX_MACROS 30											// max.no.of Macros
 #define ARDJACK_MAX_MESSAGE_PATH_LENGTH 30								// max.characters in an IoTMessage path
+#define ARDJACK_MAX_MESSAGE_PATHS 16									// max.paths interned by format 2 IoTMessages, each way per peer
+#define ARDJACK_MAX_MESSAGE_PEERS 4										// max.peers per Connection with interned format 2 paths
 #define ARDJACK_MAX_MESSAGE_TEXT_LENGTH 160								// max.characters in IoTMessage 'Text'
 #define ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH 220							// max.characters in IoTMessage 'WireText'
+#define ARDJACK_MAX_METRICS 16											// max.no.of Metrics in the registry
 #define ARDJACK_MAX_MULTI_PART_ITEMS 1									// max.no.of Items in a 'Multi' Part
 #define ARDJACK_MAX_NAME_LENGTH 32										// max.characters in a name
+#define ARDJACK_MAX_NOTIFY_BATCH_LENGTH 100								// max.characters of 'name=value' items in a batched notification
 #define ARDJACK_MAX_OBJECTS 20											// max.no.of Objects in Register
+#define ARDJACK_MAX_OUTPUT_QUEUES 16									// max.Connections with an o/p queue
 #define ARDJACK_MAX_PART_VALUE_LENGTH 10								// max.characters in a Part's value
 #define ARDJACK_MAX_PARTS 34											// max.no.of Parts
 #define ARDJACK_MAX_PERSISTED_FILES 2
 #define ARDJACK_MAX_PERSISTED_LINES 40
+#define ARDJACK_MAX_POLL_TIMERS 4										// max.timers profiled by 'PollProfiler'
+#define ARDJACK_MAX_REQUEST_FIELDS 40									// max.fields in a Device request, e.g. Parts in a bulk read
 #define ARDJACK_MAX_TABLE_COLUMNS 10
+#define ARDJACK_MAX_UDP_DATAGRAM_LENGTH 1472							// max.bytes in a packed UDP datagram
+#define ARDJACK_MAX_UDP_RX_BATCH 16										// max.datagrams received by one UDP poll
+#define ARDJACK_MAX_UDP_TX_BATCH 16										// max.datagrams sent by one UDP flush
 #define ARDJACK_MAX_VALUE_LENGTH 120
 #define ARDJACK_MAX_VALUES 10
 #define ARDJACK_MAX_VERB_LENGTH 12
 
+#define ARDJACK_PART_INDEX_SIZE 128										// slots in a Device's Part name index (a power of 2, >= 2 x ARDJACK_MAX_PARTS)
 #define ARDJACK_PERSISTED_LINE_LENGTH 256
+#define ARDJACK_REGISTER_INDEX_SIZE 64									// slots in the Register's name index (a power of 2, >= 2 x ARDJACK_MAX_OBJECTS)
+#define ARDJACK_VERB_INDEX_SIZE 256										// slots in the Interpreter's verb index (a power of 2, >= 4 x its verbs)
+
+#define ARDJACK_DRAIN_MAX_BYTES 4096									// default max.bytes of queued output sent per tick (0 = no limit)
+#define ARDJACK_DRAIN_MAX_ITEMS 0										// default max.buffer items per tick (0 = all those queued)
+#define ARDJACK_DRAIN_MAX_MS 10											// default max.ms spent draining a buffer per tick (0 = no limit)
+#define ARDJACK_MESSAGE_PATH_REFRESH 16									// format 2 sends an interned path in full every N uses
 
 #ifdef ARDUINO
+	#define ARDJACK_DRAIN_MAX_BYTES 1024								// default max.bytes of queued output sent per tick (0 = no limit)
 	#define ARDJACK_MAX_COMMAND_BUFFER_ITEMS 4							// max.items in a command buffer
-	#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEM_LENGTH 200		// max.characters in a Connection o/p buffer item
-	#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS 4				// max.items in the Connection o/p buffer
+	#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEM_LENGTH 200		// max.characters in a Connection o/p queue item
+	#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS 4				// default items in a Connection's o/p queue
 	#define ARDJACK_MAX_DEVICE_BUFFER_ITEMS 4							// max.items in a device buffer
+	#define ARDJACK_MAX_OUTPUT_QUEUES 4									// max.Connections with an o/p queue
 
 	#ifdef __arm__
 		#define ARDJACK_MAX_DATALOGGER_PARTS 8
@@ -141,6 +196,7 @@
 		#define ARDJACK_MAX_NAME_LENGTH 24
 	#else
 		#define ARDJACK_MAX_CONFIG_PROPERTIES 30
+		#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS 2			// default items in a Connection's o/p queue
 		//#define ARDJACK_MAX_CONFIG_VALUE_LENGTH 24
 		#define ARDJACK_MAX_DATALOGGER_PARTS 6
 		#define ARDJACK_MAX_DESCRIPTION_LENGTH 60
@@ -148,14 +204,42 @@
 		#define ARDJACK_MAX_ENUMERATION_ITEMS 34
 		#define ARDJACK_MAX_MACRO_LENGTH 80
 		#define ARDJACK_MAX_MACROS 6
+		#define ARDJACK_MAX_MESSAGE_PATHS 4
+		#define ARDJACK_MAX_MESSAGE_PEERS 1
 		//#define ARDJACK_MAX_MESSAGE_TEXT_LENGTH 160
 		//#define ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH 160
 		#define ARDJACK_MAX_MULTI_PART_ITEMS 1
 		#define ARDJACK_MAX_NAME_LENGTH 24
 		#define ARDJACK_MAX_OBJECTS 12
+		#define ARDJACK_MAX_REQUEST_FIELDS 10
 		#define ARDJACK_MAX_VALUE_LENGTH 60
 		#define ARDJACK_MAX_VALUES 10
 	#endif
+#elif defined(ARDJACK_LINUX)
+	// The host has room for more, e.g. a full batch of UDP input per poll - replace the defaults above.
+	#undef ARDJACK_DRAIN_MAX_BYTES
+	#undef ARDJACK_MAX_COMMAND_BUFFER_ITEMS
+	#undef ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS
+	#undef ARDJACK_MAX_DEVICE_BUFFER_ITEMS
+	#undef ARDJACK_MAX_INPUT_ROUTES
+	#undef ARDJACK_MAX_MESSAGE_PEERS
+	#undef ARDJACK_MAX_OBJECTS
+	#undef ARDJACK_MAX_OUTPUT_QUEUES
+	#undef ARDJACK_MAX_PARTS
+	#undef ARDJACK_PART_INDEX_SIZE
+	#undef ARDJACK_REGISTER_INDEX_SIZE
+
+	#define ARDJACK_DRAIN_MAX_BYTES 65536								// default max.bytes of queued output sent per tick
+	#define ARDJACK_MAX_COMMAND_BUFFER_ITEMS 64							// max.items in a command buffer
+	#define ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEMS 64				// default items in a Connection's o/p queue
+	#define ARDJACK_MAX_DEVICE_BUFFER_ITEMS 64							// max.items in a device buffer
+	#define ARDJACK_MAX_INPUT_ROUTES 64									// one per Device on a Connection (RouteTable limit: 64)
+	#define ARDJACK_MAX_MESSAGE_PEERS 64								// max.peers per Connection with interned format 2 paths
+	#define ARDJACK_MAX_OBJECTS 4096									// max.no.of Objects in Register
+	#define ARDJACK_MAX_OUTPUT_QUEUES 256								// max.Connections with an o/p queue
+	#define ARDJACK_MAX_PARTS 4096										// max.no.of Parts, e.g. in a 'Sim' Device
+	#define ARDJACK_PART_INDEX_SIZE 8192								// slots in a Device's Part name index
+	#define ARDJACK_REGISTER_INDEX_SIZE 8192							// slots in the Register's name index
 #endif
 
 #define ARDJACK_BYTES_PER_KB 1024
@@ -266,6 +350,8 @@ const static int ARDJACK_DATATYPE_STRING = 5;
 const static int ARDJACK_DEVICE_SUBTYPE_ARDUINO = 0;
 const static int ARDJACK_DEVICE_SUBTYPE_VELLEMANK8055 = 1;
 const static int ARDJACK_DEVICE_SUBTYPE_WINDOWS = 2;
+const static int ARDJACK_DEVICE_SUBTYPE_LINUX = 3;
+const static int ARDJACK_DEVICE_SUBTYPE_SIM = 4;
 
 // Horizontal Alignment types.
 const static int ARDJACK_HORZ_ALIGN_CENTRE = 0;
@@ -280,6 +366,7 @@ const static int ARDJACK_INFO_DEVICE_VERSION = 2;
 // Message Format type.
 const static int ARDJACK_MESSAGE_FORMAT_0 = 0;
 const static int ARDJACK_MESSAGE_FORMAT_1 = 1;
+const static int ARDJACK_MESSAGE_FORMAT_2 = 2;
 
 // Message Path type.
 const static int ARDJACK_MESSAGE_PATH_DEVICE = 0;
@@ -294,6 +381,24 @@ const static int ARDJACK_MESSAGE_TYPE_NOTIFICATION = 4;
 const static int ARDJACK_MESSAGE_TYPE_REQUEST = 5;
 const static int ARDJACK_MESSAGE_TYPE_RESPONSE = 6;
 
+// Metric IDs (the built-in Metrics, see 'Metrics::Init').
+const static int ARDJACK_METRIC_CONNECTION_ROUTE = 0;				// us from decoding an input message to routing it
+const static int ARDJACK_METRIC_CONNECTION_RX = 1;					// input messages processed
+const static int ARDJACK_METRIC_CONNECTION_TX = 2;					// queued output items transmitted
+const static int ARDJACK_METRIC_DEVICE_OPERATION = 3;				// us executing a Device Operation
+const static int ARDJACK_METRIC_DEVICE_QUEUE = 4;					// us a request spends in 'Globals::DeviceBuffer'
+const static int ARDJACK_METRIC_DEVICE_QUEUED = 5;					// requests in 'Globals::DeviceBuffer'
+const static int ARDJACK_METRIC_DEVICE_RESPONSE = 6;				// us encoding a Device response and handing it to its Connection
+const static int ARDJACK_METRIC_OUTPUT_DROPPED = 7;					// output items discarded by full Connection output queues
+const static int ARDJACK_METRIC_OUTPUT_QUEUE = 8;					// us an output item spends in a Connection's output queue
+const static int ARDJACK_METRIC_OUTPUT_QUEUED = 9;					// items in the Connections' output queues
+const static int ARDJACK_METRIC_BUILTIN_COUNT = 10;
+
+// Metric types.
+const static int ARDJACK_METRIC_TYPE_COUNTER = 0;					// a running total
+const static int ARDJACK_METRIC_TYPE_GAUGE = 1;						// a level, with its high water mark
+const static int ARDJACK_METRIC_TYPE_HISTOGRAM = 2;					// a distribution of durations (us)
+
 // Time constants.
 const static int ARDJACK_MILLISECONDS_PER_SECOND = 1000;
 const static int ARDJACK_SECONDS_PER_MINUTE = 60;
@@ -338,17 +443,34 @@ const static int ARDJACK_OPERATION_GET_COUNT = 10;					// get the count of a Par
 const static int ARDJACK_OPERATION_GET_GLOBAL = 11;					// get a global setting (of the computer)
 const static int ARDJACK_OPERATION_GET_INFO = 12;					// get Device info
 const static int ARDJACK_OPERATION_GET_INVENTORY = 13;				// get the Device inventory
-const static int ARDJACK_OPERATION_GET_PART_CONFIG = 14;			// get all of the configuration of a Part on the Device
-const static int ARDJACK_OPERATION_NONE = 15;
-const static int ARDJACK_OPERATION_REACTIVATE = 16;					// reactivate = deactivate + activate
-const static int ARDJACK_OPERATION_READ = 17;						// read a Part on the Device
-const static int ARDJACK_OPERATION_SET_GLOBAL = 18;					// set a global setting (of the computer)
-const static int ARDJACK_OPERATION_SUBSCRIBE = 19;					// subscribe to change notifications from the Device
-const static int ARDJACK_OPERATION_SUBSCRIBED = 20;					// the Device signals that a Part or Part type is 'subscribed' to
-const static int ARDJACK_OPERATION_UNSUBSCRIBE = 21;				// unsubscribe to change notifications from the Device
-const static int ARDJACK_OPERATION_UNSUBSCRIBED = 22;				// the Device signals that a Part or Part type is 'unsubscribed'
-const static int ARDJACK_OPERATION_UPDATE = 23;						// update the Device
-const static int ARDJACK_OPERATION_WRITE = 24;						// write to a Part on the Device
+const static int ARDJACK_OPERATION_GET_METRICS = 14;				// get the Metrics (see 'Metrics')
+const static int ARDJACK_OPERATION_GET_PART_CONFIG = 15;			// get all of the configuration of a Part on the Device
+const static int ARDJACK_OPERATION_NONE = 16;
+const static int ARDJACK_OPERATION_NOTIFY_PARTS = 17;				// the Device sends the values of several Parts
+const static int ARDJACK_OPERATION_REACTIVATE = 18;					// reactivate = deactivate + activate
+const static int ARDJACK_OPERATION_READ = 19;						// read a Part on the Device
+const static int ARDJACK_OPERATION_SET_GLOBAL = 20;					// set a global setting (of the computer)
+const static int ARDJACK_OPERATION_SUBSCRIBE = 21;					// subscribe to change notifications from the Device
+const static int ARDJACK_OPERATION_SUBSCRIBED = 22;					// the Device signals that a Part or Part type is 'subscribed' to
+const static int ARDJACK_OPERATION_UNSUBSCRIBE = 23;				// unsubscribe to change notifications from the Device
+const static int ARDJACK_OPERATION_UNSUBSCRIBED = 24;				// the Device signals that a Part or Part type is 'unsubscribed'
+const static int ARDJACK_OPERATION_UPDATE = 25;						// update the Device
+const static int ARDJACK_OPERATION_WRITE = 26;						// write to a Part on the Device
+
+// Connection output overflow policies (what 'ConnectionManager::QueueOutput' does when the output buffer is full).
+const static int ARDJACK_OUTPUT_OVERFLOW_COALESCE = 0;				// as 'DropOldest', and send only the latest notification per Part
+const static int ARDJACK_OUTPUT_OVERFLOW_DROP_NEWEST = 1;			// discard the new item
+const static int ARDJACK_OUTPUT_OVERFLOW_DROP_OLDEST = 2;			// discard the oldest queued items to make room
+
+// Part categories (bit numbers for 'PartIndex' selections).
+const static int ARDJACK_PART_CATEGORY_ANALOG = 0;
+const static int ARDJACK_PART_CATEGORY_DIGITAL = 1;
+const static int ARDJACK_PART_CATEGORY_INPUT = 2;
+const static int ARDJACK_PART_CATEGORY_NOTIFYING = 3;
+const static int ARDJACK_PART_CATEGORY_OUTPUT = 4;
+const static int ARDJACK_PART_CATEGORY_TEXTUAL = 5;
+
+const static int ARDJACK_PART_CATEGORIES = 6;
 
 // Part types.
 const static int ARDJACK_PART_TYPE_ACCELEROMETER = 0;
@@ -398,6 +520,12 @@ const static int ARDJACK_ROUTE_TYPE_RESPONSE = 3;
 const static int ARDJACK_SHIELD_SUBTYPE_ARDUINO_MF_SHIELD = 0;
 const static int ARDJACK_SHIELD_SUBTYPE_THINKERSHIELD = 1;
 
+// Sim Device value generators.
+const static int ARDJACK_SIM_GENERATOR_RANDOM_WALK = 0;
+const static int ARDJACK_SIM_GENERATOR_SINE = 1;
+const static int ARDJACK_SIM_GENERATOR_SQUARE = 2;
+const static int ARDJACK_SIM_GENERATOR_STEP = 3;
+
 // String Comparison type.
 const static int ARDJACK_STRING_COMPARE_CONTAINS = 0;
 const static int ARDJACK_STRING_COMPARE_ENDS_WITH = 1;
@@ -419,6 +547,12 @@ const static int ARDJACK_USERPART_SUBTYPE_ARDUINO_NEOPIXEL = 2;
 const static int ARDJACK_USERPART_SUBTYPE_WINDISK = 3;
 const static int ARDJACK_USERPART_SUBTYPE_WINMEMORY = 4;
 
+// Verb index entry kinds.
+const static int ARDJACK_VERB_KIND_NONE = 0;											// an empty slot
+const static int ARDJACK_VERB_KIND_COMMAND = 1;
+const static int ARDJACK_VERB_KIND_MACRO = 2;
+const static int ARDJACK_VERB_KIND_UNKNOWN = 3;											// neither a command nor a Macro
+
 // WiFi connect types.
 const static int ARDJACK_WIFI_CONNECT_OPEN = 0;
 const static int ARDJACK_WIFI_CONNECT_WEP = 1;
@@ -440,15 +574,27 @@ const static int ARDJACK_WINMEMORY_TOTAL_PHYSICAL = 1;
 const static int ARDJACK_WINMEMORY_FREE_VIRTUAL = 2;
 
 
+struct BufferDrainStats
+{
+	long BudgetStops = 0;											// ticks which stopped with items still queued
+	long Items = 0;													// total items processed
+	int LastTickItems = 0;											// items processed by the latest busy tick
+	int MaxTickItems = 0;											// max.items processed in a single tick
+	long Ticks = 0;													// ticks which processed at least one item
+};
+
 struct CommandBufferItem
 {
 	Device* Dev = NULL;
+	unsigned long QueuedUs = 0;										// when queued (see 'Utils::NowUs')
 	char Text[ARDJACK_MAX_COMMAND_BUFFER_ITEM_LENGTH] = "";
 };
 
 struct ConnectionOutputBufferItem
 {
-	Connection* Conn = NULL;
+	uint32_t Key = 0;												// coalescing key (0 = none)
+	unsigned long QueuedUs = 0;										// when queued (see 'Utils::NowUs')
+	uint32_t Sequence = 0;											// order of the Connection's items with a coalescing key
 	char Text[ARDJACK_MAX_CONNECTION_OUTPUT_BUFFER_ITEM_LENGTH] = "";
 };
 
@@ -458,6 +604,16 @@ struct MacroDef
 	char Name[ARDJACK_MAX_NAME_LENGTH] = "";
 };
 
+struct PollStats
+{
+	unsigned long LastUs = 0;										// duration of the latest poll
+	unsigned long MaxUs = 0;										// duration of the longest poll
+	long Overruns = 0;												// (timers) ticks which took longer than the timer period
+	long Polls = 0;													// polls (or timer ticks) run
+	long Skipped = 0;												// (timers) ticks skipped because the previous tick was still running
+	double TotalUs = 0.0;											// total duration of all polls
+};
+
 
 
 class Globals
@@ -475,6 +631,7 @@ public:
 #endif
 	static IoTClock* Clock;
 	static FifoBuffer* CommandBuffer;
+	static BufferDrainStats CommandDrainStats;
 	static char CommandPrefix[12];
 	static char CommandSeparator[6];
 	static CommandSet* CommandSet0;
@@ -488,7 +645,11 @@ public:
 #endif
 	static FifoBuffer* DeviceBuffer;								// shared by Devices
 	static DeviceCodec1* DeviceCodec;
+	static BufferDrainStats DeviceDrainStats;
 	static DeviceManager* DeviceMgr;
+	static int DrainMaxBytes;										// max.bytes of queued output sent per tick (0 = no limit)
+	static int DrainMaxItems;										// max.buffer items per tick (0 = all those queued)
+	static int DrainMaxMs;											// max.ms spent draining a buffer per tick (0 = no limit)
 	static char EmptyString[2];
 	static bool EnableSound;
 	static char ExecPrefix[4];										// prefix for executing a command file
@@ -517,6 +678,7 @@ public:
 	static IoTManager* ObjectMgr;
 	static Register* ObjectRegister;
 	static char OneCommandPrefix[4];
+	static BufferDrainStats OutputDrainStats;						// for the Connections' output queues
 	static PartManager* PartMgr;
 #ifdef ARDJACK_INCLUDE_PERSISTENCE
 	static PersistentFileManager* PersistentFileMgr;
@@ -546,12 +708,14 @@ public:
 	static bool CheckDeviceBuffer();
 	static bool DeleteObjects(const char* args);
 	static bool DeleteSingleObject(IoTObject* obj);
+	static bool DrainBudgetLeft(int count, int maxCount, long startMs);
 	static bool HandleDeviceRequest(Device *dev, const char* line);
 	static bool Init();
 	static bool QueueCommand(const char* line);
 	static bool ReactivateObjects(const char* args);
 	static bool Set(const char* name, const char* value, bool* handled);
 	static bool SetupStandardRoutes(Connection *pConn);
+	static void UpdateDrainStats(BufferDrainStats* stats, int count, bool itemsLeft);
 
 #ifdef ARDJACK_INCLUDE_PERSISTENCE
 	static bool LoadIniFile(const char* name);
@@ -100,6 +100,13 @@ long IoTClock::NowMs()
 }
 
 
+unsigned long IoTClock::NowUs()
+{
+	// Microseconds for measuring intervals (wrapping, as for 'micros()').
+	return (unsigned long)NowMs() * 1000UL;
+}
+
+
 bool IoTClock::NowUtc(DateTime* dt)
 {
 	return false;
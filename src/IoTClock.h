@@ -48,6 +48,7 @@ public:
 	virtual bool GetTime(int* hours, int* minutes, int* seconds, int* milliseconds, bool utc = false);
 	virtual bool Now(DateTime* dt);
 	virtual long NowMs();
+	virtual unsigned long NowUs();
 	virtual bool NowUtc(DateTime* dt);
 	virtual void Poll();
 	virtual bool SetDate(int day, int month, int year, bool utc = false);
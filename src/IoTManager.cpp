@@ -30,6 +30,8 @@
 #include "IoTManager.h"
 #include "IoTObject.h"
 #include "Log.h"
+#include "PollProfiler.h"
+#include "Utils.h"
 
 
 
@@ -92,7 +94,15 @@ void IoTManager::PollObjectsOfType(int type)
 		IoTObject* obj = Globals::ObjectRegister->Objects[i];
 
 		if ((obj->Type == type) && obj->Active())
+		{
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+			unsigned long startUs = Utils::NowUs();
 			obj->Poll();
+			PollProfiler::Record(&obj->PollProfile, startUs);
+#else
+			obj->Poll();
+#endif
+		}
 	}
 }
 
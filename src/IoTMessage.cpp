@@ -33,11 +33,48 @@
 #include "Globals.h"
 #include "IoTMessage.h"
 #include "Log.h"
+#include "MessagePathTable.h"
 #include "StringList.h"
 #include "Utils.h"
 
 
 
+// Format 2 is a tagged, length-prefixed encoding that stays within printable ASCII, so that it passes through the
+// line-based Connections unchanged:
+//		'~' <length> <field>... <check>
+// Integers (lengths, IDs, values) are base-47 varints: each digit but the last is in 'P'..'~', the last in '!'..'O'.
+// Strings are a length followed by the characters.
+// <check> is the sum of the field chars, modulo 94, plus '!'.
+static const char FORMAT2_MARKER = '~';
+static const char FORMAT2_LAST = '!';									// first char of a final varint digit
+static const char FORMAT2_MORE = 'P';									// first char of a continuation varint digit
+static const int FORMAT2_RADIX = 47;
+static const int FORMAT2_MAX_LENGTH = ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH - 2;
+
+// Decoded fields go into fixed slots in '_Fields': from, return, text, to, type.
+static const int FORMAT2_TEXT_SLOT = 2 * ARDJACK_MAX_MESSAGE_PATH_LENGTH;
+static const int FORMAT2_FIELDS_SIZE = ARDJACK_MAX_MESSAGE_TEXT_LENGTH + 4 * ARDJACK_MAX_MESSAGE_PATH_LENGTH;
+
+// Field tags. Lower-case path tags are followed by an interned path ID, upper-case ones by the full path.
+static const char FORMAT2_TAG_ACK = 'k';								// the hash of a path learned from the recipient
+static const char FORMAT2_TAG_FROM_ID = 'f';
+static const char FORMAT2_TAG_FROM_PATH = 'F';
+static const char FORMAT2_TAG_INTEGER = 'i';							// a text token which is an integer
+static const char FORMAT2_TAG_RETURN_ID = 'r';
+static const char FORMAT2_TAG_RETURN_PATH = 'R';
+static const char FORMAT2_TAG_STRING = 's';								// any other text token
+static const char FORMAT2_TAG_TEXT = 'x';								// the whole text, if it can't be tokenised
+static const char FORMAT2_TAG_TO_ID = 'd';
+static const char FORMAT2_TAG_TO_PATH = 'D';
+static const char FORMAT2_TAG_TYPE = 'y';								// ARDJACK_MESSAGE_TYPE_COMMAND etc.
+static const char FORMAT2_TAG_TYPE_NAME = 'Y';
+
+// Indexed by ARDJACK_MESSAGE_TYPE_COMMAND etc.
+static const char* MessageTypeNames[] = { "command", "data", "heartbeat", "none", "notification", "request", "response" };
+static const int MessageTypeCount = sizeof(MessageTypeNames) / sizeof(MessageTypeNames[0]);
+
+
+
 
 IoTMessage::IoTMessage()
 {
@@ -46,6 +83,13 @@ IoTMessage::IoTMessage()
 
 	_Items = new StringList(40);
 
+	_Decoded = false;
+	_Fields = NULL;
+	_ViewBase = NULL;
+	_Wire = NULL;
+	_WireLength = 0;
+	_WireTextReady = false;
+
 	Format = ARDJACK_MESSAGE_FORMAT_0;
 	Clear();
 }
@@ -58,18 +102,130 @@ IoTMessage::~IoTMessage()
 
 	if (NULL != _Items)
 		delete _Items;
+
+	if (NULL != _Fields)
+		Utils::MemFree(_Fields);
+
+	if (NULL != _Wire)
+		Utils::MemFree(_Wire);
+}
+
+
+bool IoTMessage::AppendPath(char* out, int* pos, char idTag, char literalTag, const char* path, MessagePeerPaths* peer)
+{
+	// Append 'path' (if any) to 'out' as either its interned ID, if 'peer' has acknowledged it, or in full.
+	// An acknowledged path is still sent in full every ARDJACK_MESSAGE_PATH_REFRESH uses, in case the peer restarted.
+	int length = (int)strlen(path);
+
+	if (length == 0)
+		return true;
+
+	if (*pos >= FORMAT2_MAX_LENGTH)
+		return false;
+
+	MessagePathEntry* entry = (NULL != peer) ? peer->Intern(path, length) : NULL;
+
+	if ((NULL != entry) && entry->Acknowledged)
+	{
+		if (entry->Uses < ARDJACK_MESSAGE_PATH_REFRESH)
+		{
+			entry->Uses++;
+			out[(*pos)++] = idTag;
+
+			return AppendVarint(out, pos, MessagePeerPaths::Id(entry->Hash));
+		}
+
+		entry->Uses = 0;
+	}
+
+	out[(*pos)++] = literalTag;
+
+	return AppendString(out, pos, path, length);
+}
+
+
+bool IoTMessage::AppendString(char* out, int* pos, const char* text, int length)
+{
+	if (!AppendVarint(out, pos, length))
+		return false;
+
+	if (*pos + length > FORMAT2_MAX_LENGTH)
+		return false;
+
+	memcpy(out + *pos, text, length);
+	*pos += length;
+
+	return true;
+}
+
+
+bool IoTMessage::AppendVarint(char* out, int* pos, uint32_t value)
+{
+	if (value < FORMAT2_RADIX)
+	{
+		if (*pos >= FORMAT2_MAX_LENGTH)
+			return false;
+
+		out[(*pos)++] = FORMAT2_LAST + value;
+		return true;
+	}
+
+	// Most significant digit first.
+	uint8_t digits[8];
+	int count = 0;
+
+	do
+	{
+		digits[count++] = value % FORMAT2_RADIX;
+		value /= FORMAT2_RADIX;
+	} while (value > 0);
+
+	if (*pos + count > FORMAT2_MAX_LENGTH)
+		return false;
+
+	for (int i = count - 1; i > 0; i--)
+		out[(*pos)++] = FORMAT2_MORE + digits[i];
+
+	out[(*pos)++] = FORMAT2_LAST + digits[0];
+
+	return true;
+}
+
+
+bool IoTMessage::CheckFormat2()
+{
+	// Is '_Wire' a format 2 message, i.e. are its length and check char right?
+	int pos = 1;
+	uint32_t length;
+
+	if (!ReadVarint(_Wire, _WireLength, &pos, &length) || (pos + (int)length + 1 != _WireLength))
+		return false;
+
+	int end = pos + length;
+	int sum = 0;
+
+	for (int i = pos; i < end; i++)
+		sum += (uint8_t)_Wire[i];
+
+	return (_Wire[end] == FORMAT2_LAST + sum % 94);
 }
 
 
 void IoTMessage::Clear()
 {
 	_Items->Clear();
+
+	_Decoded = false;
+	_WireTextReady = false;
+
+	Key = 0;
 }
 
 
 bool IoTMessage::CreateMessageToSend(const char* type, int format, const char* text, IoTMessage* msg, const char* fromPath,
-	const char* toPath, const char* returnPath)
+	const char* toPath, const char* returnPath, MessagePathTable* paths, uint32_t peer)
 {
+	// 'paths' (if any) are the format 2 paths of the Connection which will send 'msg', and 'peer' the recipient.
 	msg->Clear();
 
 	msg->SetType(type);
@@ -79,31 +235,89 @@ bool IoTMessage::CreateMessageToSend(const char* type, int format, const char* t
 	msg->SetToPath(toPath);
 	msg->SetReturnPath(returnPath);
 
-	msg->Encode();
-
-	return true;
+	return msg->Encode(paths, peer);
 }
 
 
-bool IoTMessage::Decode(const char* line)
+bool IoTMessage::Decode(const char* line, MessagePathTable* paths, uint32_t peer)
 {
+	// Copy 'line' (trimmed) into '_Wire' and parse it in place.
+	// The fields are views into '_Wire', so reading them costs no further copies.
+	// 'paths' (if any) are the format 2 paths of the Connection which received 'line', and 'peer' the sender.
 	Clear();
 
-	char temp[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
-	strcpy(temp, line);
-	Utils::Trim(temp);
+	if (NULL == _Wire)
+	{
+		_Wire = (char*)Utils::MemMalloc(ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH);
+
+		if (NULL == _Wire)
+		{
+			Log::LogError(PRM("IoTMessage::Decode: Failed to allocate the wire buffer"));
+			return false;
+		}
+	}
+
+	// Skip any leading white space.
+	while ((*line != NULL) && Utils::IsWhite(*line))
+		line++;
+
+	int length = 0;
+
+	while ((line[length] != NULL) && (length < ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH - 1))
+	{
+		_Wire[length] = line[length];
+		length++;
+	}
+
+	// Remove any trailing white space.
+	while ((length > 0) && Utils::IsWhite(_Wire[length - 1]))
+		length--;
+
+	_Wire[length] = NULL;
+	_WireLength = length;
+
+	for (int i = 0; i < MESSAGE_WIRETEXT; i++)
+		_Views[i] = MessageFieldView();
+
+	_Decoded = true;
+
+	if ((_Wire[0] == FORMAT2_MARKER) && CheckFormat2())
+	{
+		Format = ARDJACK_MESSAGE_FORMAT_2;
+
+		if (DecodeFormat2(paths, peer))
+			return true;
+
+		// E.g. it has a path ID that 'peer' hasn't taught us.
+		Clear();
+		return false;
+	}
 
-	SetWireText(temp);
+	_ViewBase = _Wire;
 
-	if (temp[0] == '[')
+	if (_Wire[0] == '[')
 	{
 		// There's a '[' header.
 		Format = ARDJACK_MESSAGE_FORMAT_1;
-		return DecodeFormat1(temp);
+		DecodeFormat1();
+	}
+	else
+	{
+		Format = ARDJACK_MESSAGE_FORMAT_0;
+		SetView(MESSAGE_TEXT, 0, length);
 	}
 
-	Format = ARDJACK_MESSAGE_FORMAT_0;
-	SetText(temp);
+	// NULL-terminate the fields in place, keeping the original chars for 'WireText'.
+	for (int i = 0; i < MESSAGE_WIRETEXT; i++)
+	{
+		MessageFieldView* view = &_Views[i];
+
+		if (view->Length > 0)
+		{
+			view->Terminator = _Wire[view->Offset + view->Length];
+			_Wire[view->Offset + view->Length] = NULL;
+		}
+	}
 
 	return true;
 }
@@ -143,65 +357,238 @@ bool IoTMessage::Decode(const char* line)
 //}
 
 
-bool IoTMessage::DecodeFormat1(const char* line)
+bool IoTMessage::DecodeFormat1()
 {
-	// 'line' contains a [header] followed by zero or more spaces and the message text (if any).
+	// '_Wire' contains a [header] followed by zero or more spaces and the message text (if any).
 	// e.g. "[from=\\comp1\dev1 to=\\comp2\dev2] some text"
+	// This makes a single pass over the header, setting a view for each known 'key=value'.
 
-	const char* headerEnd = strchr(line, ']');
+	const char* headerEnd = strchr(_Wire, ']');
 
 	if (NULL == headerEnd)
 	{
 		// Assume there's no header.
-		SetText(line);
+		SetView(MESSAGE_TEXT, 0, _WireLength);
 		return true;
 	}
 
-	// Get the header and text (if any).
-	char header[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
-	int count = (int)(headerEnd - line) - 1;
-	strncpy(header, line + 1, count);
-	header[count] = NULL;
+	int end = (int)(headerEnd - _Wire);
+	int pos = 1;
+
+	while (pos < end)
+	{
+		// Skip spaces.
+		while ((pos < end) && (_Wire[pos] == ' '))
+			pos++;
+
+		if (pos >= end)
+			break;
+
+		int keyStart = pos;
+
+		while ((pos < end) && (_Wire[pos] != ' ') && (_Wire[pos] != '='))
+			pos++;
+
+		int keyLength = pos - keyStart;
+		int valueStart = pos;
+		int valueLength = 0;
+
+		if ((pos < end) && (_Wire[pos] == '='))
+		{
+			valueStart = ++pos;
+
+			while ((pos < end) && (_Wire[pos] != ' '))
+				pos++;
+
+			valueLength = pos - valueStart;
+		}
+
+		int index = LookupHeaderKey(_Wire + keyStart, keyLength);
+
+		if (index >= 0)
+			SetView(index, valueStart, valueLength);
+	}
+
+	// The text follows the header, after any spaces.
+	pos = end + 1;
+
+	while ((pos < _WireLength) && (_Wire[pos] == ' '))
+		pos++;
+
+	SetView(MESSAGE_TEXT, pos, _WireLength - pos);
+
+	return true;
+}
+
+
+bool IoTMessage::DecodeFormat2(MessagePathTable* paths, uint32_t peer)
+{
+	// Decode the fields of the format 2 message in '_Wire' (see 'CheckFormat2') into '_Fields', and set their views.
+	int pos = 1;
+	uint32_t length;
+	ReadVarint(_Wire, _WireLength, &pos, &length);
+
+	int end = pos + length;
+
+	if (NULL == _Fields)
+	{
+		_Fields = (char*)Utils::MemMalloc(FORMAT2_FIELDS_SIZE);
+
+		if (NULL == _Fields)
+		{
+			Log::LogError(PRM("IoTMessage::DecodeFormat2: Failed to allocate the fields buffer"));
+			return false;
+		}
+	}
+
+	_ViewBase = _Fields;
 
-	char temp[ARDJACK_MAX_MESSAGE_TEXT_LENGTH];
-	strcpy(temp, headerEnd + 1);
-	Utils::Trim(temp);
-	SetText(temp);
+	char* text = _Fields + FORMAT2_TEXT_SLOT;
+	int textLength = 0;
+	bool valid = true;
 
-	// Parse the header.
-	StringList fields;
-	count = Utils::SplitText(header, ' ', &fields, ARDJACK_MAX_VALUES, ARDJACK_MAX_VALUE_LENGTH);
+	MessagePeerPaths* sender = NULL;
+	bool unknownPath = false;
 
-	char parts[2][ARDJACK_MAX_VALUE_LENGTH];
-	char key[10];
-	char value[30];
+	if (NULL != paths)
+	{
+		paths->Lock();
+		sender = paths->GetPeer(peer);
+	}
 
-	for (int i = 0; i < count; i++)
+	while (valid && (pos < end))
 	{
-		int partCount = Utils::SplitText2Array(fields.Get(i), '=', parts, 2, ARDJACK_MAX_VALUE_LENGTH);
+		char tag = _Wire[pos++];
+		uint8_t index = MESSAGE_TYPE;
+		const char* str = NULL;
+		int strLength = 0;
+		uint32_t value;
+
+		switch (tag)
+		{
+		case FORMAT2_TAG_FROM_ID:
+		case FORMAT2_TAG_RETURN_ID:
+		case FORMAT2_TAG_TO_ID:
+			valid = ReadVarint(_Wire, end, &pos, &value);
+
+			if (!valid)
+				break;
+
+			index = (tag == FORMAT2_TAG_FROM_ID) ? MESSAGE_FROM_PATH :
+				((tag == FORMAT2_TAG_TO_ID) ? MESSAGE_TO_PATH : MESSAGE_RETURN_PATH);
+
+			if ((NULL != sender) && (value <= 0xFFFF))
+				str = sender->Lookup((uint16_t)value);
+
+			if (NULL == str)
+			{
+				unknownPath = true;
+				valid = false;
+				break;
+			}
+
+			strLength = (int)strlen(str);
+			break;
+
+		case FORMAT2_TAG_ACK:
+			valid = ReadVarint(_Wire, end, &pos, &value);
+
+			if (!valid)
+				break;
+
+			if (NULL != sender)
+				sender->Acknowledge(value);
+			continue;
+
+		case FORMAT2_TAG_FROM_PATH:
+		case FORMAT2_TAG_RETURN_PATH:
+		case FORMAT2_TAG_TO_PATH:
+			valid = ReadString(_Wire, end, &pos, &str, &strLength) && (strLength < ARDJACK_MAX_MESSAGE_PATH_LENGTH);
+
+			if (!valid)
+				break;
+
+			index = (tag == FORMAT2_TAG_FROM_PATH) ? MESSAGE_FROM_PATH :
+				((tag == FORMAT2_TAG_TO_PATH) ? MESSAGE_TO_PATH : MESSAGE_RETURN_PATH);
+
+			if (NULL != sender)
+				sender->Learn(str, strLength);
+			break;
+
+		case FORMAT2_TAG_INTEGER:
+			valid = ReadVarint(_Wire, end, &pos, &value) && (textLength + 13 <= ARDJACK_MAX_MESSAGE_TEXT_LENGTH);
+
+			if (!valid)
+				break;
+
+			if (textLength > 0)
+				text[textLength++] = ' ';
+
+			textLength += FormatInteger(text + textLength, (int32_t)(value >> 1) ^ -(int32_t)(value & 1));
+			continue;
+
+		case FORMAT2_TAG_STRING:
+		case FORMAT2_TAG_TEXT:
+			valid = ReadString(_Wire, end, &pos, &str, &strLength) &&
+				(textLength + strLength + 2 <= ARDJACK_MAX_MESSAGE_TEXT_LENGTH);
 
-		strcpy(key, parts[0]);
-		Utils::Trim(key);
-		_strlwr(key);
+			if (!valid)
+				break;
 
-		value[0] = NULL;
+			if ((textLength > 0) && (tag == FORMAT2_TAG_STRING))
+				text[textLength++] = ' ';
 
-		if (partCount == 2)
-			strcpy(value, parts[1]);
+			memcpy(text + textLength, str, strLength);
+			textLength += strLength;
+			continue;
 
-		if (strcmp(key, "from") == 0)
-			SetFromPath(value);
+		case FORMAT2_TAG_TYPE:
+			valid = ReadVarint(_Wire, end, &pos, &value) && (value < (uint32_t)MessageTypeCount);
 
-		else if (strcmp(key, "return") == 0)
-			SetReturnPath(value);
+			if (valid)
+			{
+				str = MessageTypeNames[value];
+				strLength = (int)strlen(str);
+			}
+			break;
 
-		else if (strcmp(key, "to") == 0)
-			SetToPath(value);
+		case FORMAT2_TAG_TYPE_NAME:
+			valid = ReadString(_Wire, end, &pos, &str, &strLength) && (strLength < ARDJACK_MAX_MESSAGE_PATH_LENGTH);
+			break;
 
-		else if (strcmp(key, "type") == 0)
-			SetType(value);
+		default:
+			valid = false;
+			break;
+		}
+
+		if (valid && (NULL != str))
+		{
+			// Copy a path or type into its slot.
+			int slot = (index < MESSAGE_TEXT) ? index * ARDJACK_MAX_MESSAGE_PATH_LENGTH :
+				FORMAT2_TEXT_SLOT + ARDJACK_MAX_MESSAGE_TEXT_LENGTH + (index - MESSAGE_TO_PATH) * ARDJACK_MAX_MESSAGE_PATH_LENGTH;
+
+			memcpy(_Fields + slot, str, strLength);
+			_Fields[slot + strLength] = NULL;
+			SetView(index, slot, strLength);
+		}
+	}
+
+	if (NULL != paths)
+		paths->Unlock();
+
+	if (!valid)
+	{
+		if (unknownPath)
+			Log::LogWarning(PRM("IoTMessage::DecodeFormat2: Unknown path ID in message: '"), _Wire, "'");
+		else
+			Log::LogError(PRM("IoTMessage::DecodeFormat2: Invalid message: '"), _Wire, "'");
+
+		return false;
 	}
 
+	text[textLength] = NULL;
+	SetView(MESSAGE_TEXT, FORMAT2_TEXT_SLOT, textLength);
+
 	return true;
 }
 
@@ -267,7 +654,7 @@ bool IoTMessage::DecodeFormat1(const char* line)
 //}
 
 
-bool IoTMessage::Encode()
+bool IoTMessage::Encode(MessagePathTable* paths, uint32_t peer)
 {
 	switch (Format)
 	{
@@ -278,6 +665,67 @@ bool IoTMessage::Encode()
 	case ARDJACK_MESSAGE_FORMAT_1:
 		EncodeFormat1();
 		break;
+
+	case ARDJACK_MESSAGE_FORMAT_2:
+		return EncodeFormat2(paths, peer);
+	}
+
+	return true;
+}
+
+
+bool IoTMessage::EncodeBody2(char* out, int* pos)
+{
+	// Append the text as a sequence of integer and string tokens or, if it isn't single-space separated, whole.
+	const char* text = Text();
+	int length = (int)strlen(text);
+
+	if (length == 0)
+		return true;
+
+	bool simple = (text[0] != ' ') && (text[length - 1] != ' ') && (NULL == strstr(text, "  "));
+
+	if (!simple)
+	{
+		if (*pos >= FORMAT2_MAX_LENGTH)
+			return false;
+
+		out[(*pos)++] = FORMAT2_TAG_TEXT;
+
+		return AppendString(out, pos, text, length);
+	}
+
+	const char* token = text;
+
+	while (*token != NULL)
+	{
+		const char* tokenEnd = strchr(token, ' ');
+		int tokenLength = (NULL == tokenEnd) ? (int)strlen(token) : (int)(tokenEnd - token);
+		int32_t value;
+
+		if (*pos >= FORMAT2_MAX_LENGTH)
+			return false;
+
+		if (ParseInteger(token, tokenLength, &value))
+		{
+			// Zig-zag encode, so that small negative values stay short.
+			out[(*pos)++] = FORMAT2_TAG_INTEGER;
+
+			if (!AppendVarint(out, pos, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31)))
+				return false;
+		}
+		else
+		{
+			out[(*pos)++] = FORMAT2_TAG_STRING;
+
+			if (!AppendString(out, pos, token, tokenLength))
+				return false;
+		}
+
+		token += tokenLength;
+
+		if (*token == ' ')
+			token++;
 	}
 
 	return true;
@@ -342,9 +790,181 @@ bool IoTMessage::EncodeFormat1()
 }
 
 
+bool IoTMessage::EncodeFormat2(MessagePathTable* paths, uint32_t peer)
+{
+	// The result is '~', the length of the fields, the fields and a check char.
+	//  e.g. '~:y'ficLdmgLs$ai0i{:s$di0i#~' is type 'response', from and to path IDs, and text 'ai0 1023 di0 1'.
+	char fields[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+	int pos = 0;
+	bool ok = true;
+
+	// Encode the type.
+	const char* type = Type();
+
+	if (strlen(type) > 0)
+	{
+		int typeIndex = 0;
+
+		while ((typeIndex < MessageTypeCount) && ((tolower(type[0]) != MessageTypeNames[typeIndex][0]) ||
+			!Utils::StringEquals(type, MessageTypeNames[typeIndex], true)))
+			typeIndex++;
+
+		if (typeIndex < MessageTypeCount)
+		{
+			fields[pos++] = FORMAT2_TAG_TYPE;
+			ok = AppendVarint(fields, &pos, typeIndex);
+		}
+		else
+		{
+			fields[pos++] = FORMAT2_TAG_TYPE_NAME;
+			ok = AppendString(fields, &pos, type, (int)strlen(type));
+		}
+	}
+
+	// Encode the paths.
+	MessagePeerPaths* recipient = NULL;
+
+	if (NULL != paths)
+	{
+		paths->Lock();
+		recipient = paths->GetPeer(peer);
+	}
+
+	ok = ok && AppendPath(fields, &pos, FORMAT2_TAG_FROM_ID, FORMAT2_TAG_FROM_PATH, FromPath(), recipient);
+	ok = ok && AppendPath(fields, &pos, FORMAT2_TAG_TO_ID, FORMAT2_TAG_TO_PATH, ToPath(), recipient);
+
+	if (!Utils::StringEquals(ReturnPath(), FromPath()))
+		ok = ok && AppendPath(fields, &pos, FORMAT2_TAG_RETURN_ID, FORMAT2_TAG_RETURN_PATH, ReturnPath(), recipient);
+
+	// Add the text.
+	ok = ok && EncodeBody2(fields, &pos);
+
+	// Acknowledge as many paths learned from the recipient as there's room for, leaving the rest for later.
+	if (ok && (NULL != recipient))
+	{
+		int acks = 0;
+
+		while (acks < recipient->AckCount)
+		{
+			int save = pos;
+			fields[pos++] = FORMAT2_TAG_ACK;
+
+			if (!AppendVarint(fields, &pos, recipient->Acks[acks]) || (pos + 4 > FORMAT2_MAX_LENGTH))
+			{
+				pos = save;
+				break;
+			}
+
+			acks++;
+		}
+
+		for (int i = acks; i < recipient->AckCount; i++)
+			recipient->Acks[i - acks] = recipient->Acks[i];
+
+		recipient->AckCount -= acks;
+	}
+
+	if (NULL != paths)
+		paths->Unlock();
+
+	char work[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+	int length = 0;
+
+	work[length++] = FORMAT2_MARKER;
+	ok = ok && AppendVarint(work, &length, pos);
+
+	if (!ok || (length + pos > FORMAT2_MAX_LENGTH))
+	{
+		Log::LogError(PRM("IoTMessage::EncodeFormat2: Message too long: '"), Text(), "'");
+		return false;
+	}
+
+	int sum = 0;
+
+	for (int i = 0; i < pos; i++)
+		sum += (uint8_t)fields[i];
+
+	memcpy(work + length, fields, pos);
+	length += pos;
+	work[length++] = FORMAT2_LAST + sum % 94;
+	work[length] = NULL;
+
+	SetWireText(work);
+
+	return true;
+}
+
+
+int IoTMessage::FormatInteger(char* out, int32_t value)
+{
+	// Write 'value' to 'out' in decimal, without a NULL, and return the no.of chars.
+	char digits[12];
+	int count = 0;
+	uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+
+	do
+	{
+		digits[count++] = '0' + magnitude % 10;
+		magnitude /= 10;
+	} while (magnitude > 0);
+
+	int length = 0;
+
+	if (value < 0)
+		out[length++] = '-';
+
+	while (count > 0)
+		out[length++] = digits[--count];
+
+	return length;
+}
+
+
 const char* IoTMessage::FromPath()
 {
-	return _Items->Get(MESSAGE_FROM_PATH);
+	return GetItem(MESSAGE_FROM_PATH);
+}
+
+
+const char* IoTMessage::GetItem(uint8_t index)
+{
+	if (!_Decoded)
+		return _Items->Get(index);
+
+	if (index < MESSAGE_WIRETEXT)
+	{
+		MessageFieldView* view = &_Views[index];
+
+		if (view->Length == 0)
+			return Globals::EmptyString;
+
+		return _ViewBase + view->Offset;
+	}
+
+	if (!_WireTextReady && (_ViewBase != _Wire))
+	{
+		// Format 2 leaves '_Wire' unchanged.
+		_Items->Put(MESSAGE_WIRETEXT, _Wire);
+		_WireTextReady = true;
+	}
+
+	if (!_WireTextReady)
+	{
+		// Rebuild the wire text (on first use only), by restoring the chars replaced by NULLs.
+		char temp[ARDJACK_MAX_MESSAGE_WIRETEXT_LENGTH];
+		memcpy(temp, _Wire, _WireLength + 1);
+
+		for (int i = 0; i < MESSAGE_WIRETEXT; i++)
+		{
+			if (_Views[i].Length > 0)
+				temp[_Views[i].Offset + _Views[i].Length] = _Views[i].Terminator;
+		}
+
+		_Items->Put(MESSAGE_WIRETEXT, temp);
+		_WireTextReady = true;
+	}
+
+	return _Items->Get(MESSAGE_WIRETEXT);
 }
 
 
@@ -395,57 +1015,176 @@ void IoTMessage::LogIt()
 }
 
 
+int IoTMessage::LookupHeaderKey(const char* key, int length)
+{
+	// Get the '_Items' index for header key 'key' ('length' chars, not NULL-terminated), or -1.
+	static const char* names[] = { "from", "return", NULL, "to", "type" };
+
+	for (int i = 0; i < MESSAGE_WIRETEXT; i++)
+	{
+		if ((NULL == names[i]) || ((int)strlen(names[i]) != length))
+			continue;
+
+		int j = 0;
+
+		while ((j < length) && (tolower(key[j]) == names[i][j]))
+			j++;
+
+		if (j == length)
+			return i;
+	}
+
+	return -1;
+}
+
+
+bool IoTMessage::Materialise()
+{
+	// Copy a decoded message's fields into '_Items', so that they can be changed.
+	if (!_Decoded)
+		return true;
+
+	GetItem(MESSAGE_WIRETEXT);
+
+	for (int i = 0; i < MESSAGE_WIRETEXT; i++)
+		_Items->Put(i, GetItem(i));
+
+	_Decoded = false;
+
+	return true;
+}
+
+
+bool IoTMessage::ParseInteger(const char* text, int length, int32_t* value)
+{
+	// Is 'text' ('length' chars) an integer that decodes back to the same text, i.e. without a '+' or leading zeros?
+	int pos = (length > 0) && (text[0] == '-') ? 1 : 0;
+	int digits = length - pos;
+
+	if ((digits < 1) || (digits > 9) || ((text[pos] == '0') && ((digits > 1) || (pos > 0))))
+		return false;
+
+	int32_t result = 0;
+
+	for (int i = pos; i < length; i++)
+	{
+		if ((text[i] < '0') || (text[i] > '9'))
+			return false;
+
+		result = result * 10 + (text[i] - '0');
+	}
+
+	*value = (pos > 0) ? -result : result;
+
+	return true;
+}
+
+
+bool IoTMessage::PutItem(uint8_t index, const char* text)
+{
+	Materialise();
+
+	return _Items->Put(index, text);
+}
+
+
+bool IoTMessage::ReadString(const char* in, int end, int* pos, const char** text, int* length)
+{
+	uint32_t count;
+
+	if (!ReadVarint(in, end, pos, &count) || (*pos + (int)count > end))
+		return false;
+
+	*text = in + *pos;
+	*length = count;
+	*pos += count;
+
+	return true;
+}
+
+
+bool IoTMessage::ReadVarint(const char* in, int end, int* pos, uint32_t* value)
+{
+	uint32_t result = 0;
+
+	for (int digits = 0; (digits < 6) && (*pos < end); digits++)
+	{
+		char c = in[(*pos)++];
+
+		if ((c >= FORMAT2_MORE) && (c < FORMAT2_MORE + FORMAT2_RADIX))
+			result = result * FORMAT2_RADIX + (c - FORMAT2_MORE);
+		else if ((c >= FORMAT2_LAST) && (c < FORMAT2_LAST + FORMAT2_RADIX))
+		{
+			*value = result * FORMAT2_RADIX + (c - FORMAT2_LAST);
+			return true;
+		}
+		else
+			return false;
+	}
+
+	return false;
+}
+
+
 const char* IoTMessage::ReturnPath()
 {
-	return _Items->Get(MESSAGE_RETURN_PATH);
+	return GetItem(MESSAGE_RETURN_PATH);
 }
 
 
 bool IoTMessage::SetFromPath(const char* text)
 {
-	return _Items->Put(MESSAGE_FROM_PATH, text);
+	return PutItem(MESSAGE_FROM_PATH, text);
 }
 
 
 bool IoTMessage::SetReturnPath(const char* text)
 {
-	return _Items->Put(MESSAGE_RETURN_PATH, text);
+	return PutItem(MESSAGE_RETURN_PATH, text);
 }
 
 
 bool IoTMessage::SetText(const char* text)
 {
-	return _Items->Put(MESSAGE_TEXT, text);
+	return PutItem(MESSAGE_TEXT, text);
 }
 
 
 bool IoTMessage::SetToPath(const char* text)
 {
-	return _Items->Put(MESSAGE_TO_PATH, text);
+	return PutItem(MESSAGE_TO_PATH, text);
 }
 
 
 bool IoTMessage::SetType(const char* text)
 {
-	return _Items->Put(MESSAGE_TYPE, text);
+	return PutItem(MESSAGE_TYPE, text);
+}
+
+
+void IoTMessage::SetView(uint8_t index, int offset, int length)
+{
+	// Field 'index' is 'length' chars of '_ViewBase', starting at 'offset'.
+	_Views[index].Offset = offset;
+	_Views[index].Length = length;
 }
 
 
 bool IoTMessage::SetWireText(const char* text)
 {
-	return _Items->Put(MESSAGE_WIRETEXT, text);
+	return PutItem(MESSAGE_WIRETEXT, text);
 }
 
 
 const char* IoTMessage::Text()
 {
-	return _Items->Get(MESSAGE_TEXT);
+	return GetItem(MESSAGE_TEXT);
 }
 
 
 const char* IoTMessage::ToPath()
 {
-	return _Items->Get(MESSAGE_TO_PATH);
+	return GetItem(MESSAGE_TO_PATH);
 }
 
 
@@ -503,12 +1242,12 @@ const char* IoTMessage::ToString(char* out)
 
 const char* IoTMessage::Type()
 {
-	return _Items->Get(MESSAGE_TYPE);
+	return GetItem(MESSAGE_TYPE);
 }
 
 
 const char* IoTMessage::WireText()
 {
-	return _Items->Get(MESSAGE_WIRETEXT);
+	return GetItem(MESSAGE_WIRETEXT);
 }
 
@@ -33,40 +33,81 @@
 
 #include "Globals.h"
 
+class MessagePathTable;
+class MessagePeerPaths;
 class StringList;
 
 
 
+struct MessageFieldView
+{
+	uint16_t Offset = 0;												// start of the field in the wire buffer
+	uint16_t Length = 0;												// no.of characters
+	char Terminator = NULL;												// original char at 'Offset + Length'
+};
+
+
+
+
 class IoTMessage
 {
 protected:
 	// Indexes in '_Items'.
-	static const uint8_t MESSAGE_FROM_PATH = 0;							// source path (format 1 only)
-	static const uint8_t MESSAGE_RETURN_PATH = 1;						// return path (format 1 only, and only
+	static const uint8_t MESSAGE_FROM_PATH = 0;							// source path (formats 1 and 2)
+	static const uint8_t MESSAGE_RETURN_PATH = 1;						// return path (formats 1 and 2, and only
 																		// if not equal to the 'From' path)
 	static const uint8_t MESSAGE_TEXT = 2;								// the text, e.g. a command, request or response
-	static const uint8_t MESSAGE_TO_PATH = 3;							// destination path (format 1 only)
+	static const uint8_t MESSAGE_TO_PATH = 3;							// destination path (formats 1 and 2)
 	static const uint8_t MESSAGE_TYPE = 4;								// the message type
 	static const uint8_t MESSAGE_WIRETEXT = 5;							// full transmitted/received text,
-																		// e.g. text (format 0), header + text (format 1)
+																		// e.g. text (format 0), header + text (format 1),
+																		// tagged fields (format 2)
 	StringList* _Items;
 
+	// A decoded message keeps its fields as views into '_Wire', until one is changed.
+	bool _Decoded;
+	char* _Fields;														// format 2 fields, decoded into fixed slots
+	char* _ViewBase;													// '_Wire' or '_Fields'
+	MessageFieldView _Views[MESSAGE_WIRETEXT];
+	char* _Wire;														// the received text, with each field NULL-terminated
+	bool _WireTextReady;												// has '_Items' got the wire text?
+	uint16_t _WireLength;
+
+	// Format 2 paths are interned per Connection and peer (see 'MessagePathTable').
+	static bool AppendPath(char* out, int* pos, char idTag, char literalTag, const char* path, MessagePeerPaths* peer);
+	static bool AppendString(char* out, int* pos, const char* text, int length);
+	static bool AppendVarint(char* out, int* pos, uint32_t value);
+	static int FormatInteger(char* out, int32_t value);
+	static bool ParseInteger(const char* text, int length, int32_t* value);
+	static bool ReadString(const char* in, int end, int* pos, const char** text, int* length);
+	static bool ReadVarint(const char* in, int end, int* pos, uint32_t* value);
+
+	virtual bool CheckFormat2();
 	virtual void Clear();
 	//virtual bool DecodeFormat0(const char* line);
-	virtual bool DecodeFormat1(const char* line);
+	virtual bool DecodeFormat1();
+	virtual bool DecodeFormat2(MessagePathTable* paths, uint32_t peer);
+	virtual bool EncodeBody2(char* out, int* pos);
 	virtual bool EncodeFormat0();
 	virtual bool EncodeFormat1();
+	virtual bool EncodeFormat2(MessagePathTable* paths, uint32_t peer);
+	virtual const char* GetItem(uint8_t index);
+	virtual int LookupHeaderKey(const char* key, int length);
+	virtual bool Materialise();
+	virtual bool PutItem(uint8_t index, const char* text);
+	virtual void SetView(uint8_t index, int offset, int length);
 
 public:
 	uint8_t Format;														// enumeration: ARDJACK_MESSAGE_FORMAT_0 etc.
+	uint32_t Key;														// coalescing key, e.g. for a Part's value notifications (0 = none)
 
 	IoTMessage();
 	~IoTMessage();
 
 	static bool CreateMessageToSend(const char* type, int format, const char* text, IoTMessage* msg, const char* fromPath = "",
-		const char* toPath = "", const char* returnPath = "");
-	virtual bool Decode(const char* line);
-	virtual bool Encode();
+		const char* toPath = "", const char* returnPath = "", MessagePathTable* paths = NULL, uint32_t peer = 0);
+	virtual bool Decode(const char* line, MessagePathTable* paths = NULL, uint32_t peer = 0);
+	virtual bool Encode(MessagePathTable* paths = NULL, uint32_t peer = 0);
 	virtual const char* FromPath();
 	virtual void LogIt();
 	virtual const char* ReturnPath();
@@ -49,6 +49,9 @@ protected:
 public:
 	Configuration* Config;
 	char Name[ARDJACK_MAX_NAME_LENGTH];
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+	PollStats PollProfile;														// how long 'Poll' takes (see 'PollProfiler')
+#endif
 	uint8_t Subtype;															// enumeration, e.g. ARDJACK_CONNECTION_SUBTYPE_SERIAL
 	uint8_t Type;																// enumeration, e.g. ARDJACK_OBJECT_TYPE_BRIDGE
 
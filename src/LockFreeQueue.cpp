@@ -0,0 +1,164 @@
+/*
+	LockFreeQueue.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+
+#include "LockFreeQueue.h"
+#include "Utils.h"
+
+#include <new>
+
+
+
+LockFreeQueue::LockFreeQueue(int itemSize, int count)
+{
+	_Count = count;
+	_ItemSize = itemSize;
+
+	// Each cell holds its sequence number, then the item, and starts on a 'size_t' boundary.
+	_CellSize = sizeof(std::atomic<size_t>) + itemSize;
+	_CellSize = (_CellSize + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+
+	_Cells = (uint8_t*)Utils::MemMalloc(_CellSize * count);
+
+	for (int i = 0; i < count; i++)
+		new (CellSequence(i)) std::atomic<size_t>(i);
+
+	_Head.store(0, std::memory_order_relaxed);
+	_Tail.store(0, std::memory_order_relaxed);
+}
+
+
+LockFreeQueue::~LockFreeQueue()
+{
+	Utils::MemFree(_Cells);
+}
+
+
+int LockFreeQueue::Capacity()
+{
+	return _Count;
+}
+
+
+std::atomic<size_t>* LockFreeQueue::CellSequence(size_t position)
+{
+	return (std::atomic<size_t>*)(_Cells + (position % _Count) * _CellSize);
+}
+
+
+int LockFreeQueue::Count()
+{
+	// A snapshot - exact only when no other thread is pushing or popping.
+	size_t head = _Head.load(std::memory_order_acquire);
+	size_t tail = _Tail.load(std::memory_order_acquire);
+
+	if (tail <= head)
+		return 0;
+
+	return (tail - head > (size_t)_Count) ? _Count : (int)(tail - head);
+}
+
+
+bool LockFreeQueue::Pop(void* item)
+{
+	size_t head = _Head.load(std::memory_order_relaxed);
+	std::atomic<size_t>* sequence;
+
+	while (true)
+	{
+		sequence = CellSequence(head);
+		intptr_t diff = (intptr_t)sequence->load(std::memory_order_acquire) - (intptr_t)(head + 1);
+
+		if (diff == 0)
+		{
+			// Its producer has finished with the cell - try to claim it.
+			if (_Head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// The cell hasn't been filled on this lap, so the queue is empty.
+			return false;
+		}
+		else
+		{
+			// Another consumer claimed the cell first.
+			head = _Head.load(std::memory_order_relaxed);
+		}
+	}
+
+	memcpy(item, (uint8_t*)sequence + sizeof(std::atomic<size_t>), _ItemSize);
+	sequence->store(head + _Count, std::memory_order_release);					// free for the next lap
+
+	return true;
+}
+
+
+bool LockFreeQueue::Push(const void* item)
+{
+	size_t tail = _Tail.load(std::memory_order_relaxed);
+	std::atomic<size_t>* sequence;
+
+	while (true)
+	{
+		sequence = CellSequence(tail);
+		intptr_t diff = (intptr_t)sequence->load(std::memory_order_acquire) - (intptr_t)tail;
+
+		if (diff == 0)
+		{
+			// The cell is free - try to claim it.
+			if (_Tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// The cell still holds an item from the previous lap, so the queue is full.
+			return false;
+		}
+		else
+		{
+			// Another producer claimed the cell first.
+			tail = _Tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	memcpy((uint8_t*)sequence + sizeof(std::atomic<size_t>), item, _ItemSize);
+	sequence->store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+#endif
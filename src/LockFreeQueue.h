@@ -0,0 +1,76 @@
+/*
+	LockFreeQueue.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_LOCKFREE_QUEUES
+
+#include <atomic>
+
+#define ARDJACK_CACHE_LINE_SIZE 64
+
+
+
+// A bounded FIFO queue of fixed-size items, safe without locks for several producer and consumer threads.
+//
+// It uses a sequence number per cell (D.Vyukov's bounded queue): a producer claims a cell by advancing '_Tail', a
+// consumer claims one by advancing '_Head', and neither touches a cell until its sequence shows the other side has
+// finished with it. Producers may therefore also pop, e.g. to discard the oldest item when full.
+class LockFreeQueue
+{
+protected:
+	char _Pad0[ARDJACK_CACHE_LINE_SIZE];
+	std::atomic<size_t> _Head;														// next position to pop (written by consumers)
+	char _Pad1[ARDJACK_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> _Tail;														// next position to push (written by producers)
+	char _Pad2[ARDJACK_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+	uint8_t* _Cells;
+	size_t _CellSize;																// sequence number + item, rounded up
+	int _Count;																		// capacity (items)
+	int _ItemSize;
+
+	std::atomic<size_t>* CellSequence(size_t position);
+
+public:
+	LockFreeQueue(int itemSize, int count);
+	~LockFreeQueue();
+
+	virtual int Capacity();
+	virtual int Count();
+	virtual bool Pop(void* item);
+	virtual bool Push(const void* item);
+};
+
+#endif
@@ -27,6 +27,8 @@
 
 #ifdef ARDUINO
 	#include <stdarg.h>
+#elif defined(ARDJACK_LINUX)
+	#include <iostream>
 #else
 	#include <iostream>
 	#include <windows.h>
@@ -47,7 +47,17 @@ bool MessageFilter::CleanMessage(IoTMessage* msg, MessageFilterItem* filterItem)
 {
 	// Clean 'msg.Text' by removing whatever made it pass 'filterItem'.
 	char temp[ARDJACK_MAX_MESSAGE_TEXT_LENGTH];
-	Utils::StringReplace(msg->Text(), filterItem->Text, "", filterItem->IgnoreCase, temp, 202);
+
+	if (filterItem->Operation == ARDJACK_STRING_COMPARE_STARTS_WITH)
+	{
+		// Remove just the prefix (which may differ in case).
+		const char* text = msg->Text();
+		int length = (int)strlen(filterItem->Text);
+
+		strcpy(temp, ((int)strlen(text) > length) ? text + length : "");
+	}
+	else
+		Utils::StringReplace(msg->Text(), filterItem->Text, "", filterItem->IgnoreCase, temp, 202);
 	Utils::Trim(temp);
 
 	msg->SetText(temp);
@@ -39,7 +39,6 @@
 class MessageFilter
 {
 protected:
-	virtual bool CleanMessage(IoTMessage* msg, MessageFilterItem* filterItem);
 
 public:
 	MessageFilterItem BodyFilter;
@@ -52,6 +51,7 @@ public:
 
 	MessageFilter();
 
+	virtual bool CleanMessage(IoTMessage* msg, MessageFilterItem* filterItem);
 	virtual bool EvaluateMessage(IoTMessage* msg);
 	virtual MessageFilterItem* GetFilterItem(const char* name, bool quiet = false);
 };
@@ -0,0 +1,268 @@
+/*
+	MessagePathTable.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+#include "Log.h"
+#include "MessagePathTable.h"
+
+
+
+MessagePeerPaths::MessagePeerPaths(uint32_t address)
+{
+	_SentNext = 0;
+
+	AckCount = 0;
+	Address = address;
+	ReceivedCount = 0;
+	SentCount = 0;
+}
+
+
+void MessagePeerPaths::Acknowledge(uint32_t hash)
+{
+	// The peer has learned the path with 'hash', so it can be sent as its ID from now on.
+	for (int i = 0; i < SentCount; i++)
+	{
+		if (Sent[i].Hash == hash)
+		{
+			Sent[i].Acknowledged = true;
+			Sent[i].Uses = 0;
+			break;
+		}
+	}
+}
+
+
+uint32_t MessagePeerPaths::Hash(const char* path, int length)
+{
+	// 32-bit FNV-1a.
+	uint32_t hash = 2166136261u;
+
+	for (int i = 0; i < length; i++)
+	{
+		hash ^= (uint8_t)path[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
+uint16_t MessagePeerPaths::Id(uint32_t hash)
+{
+	return (uint16_t)((hash >> 16) ^ (hash & 0xFFFF));
+}
+
+
+MessagePathEntry* MessagePeerPaths::Intern(const char* path, int length)
+{
+	// Get the 'Sent' entry for 'path' ('length' chars, not NULL-terminated), adding it if necessary.
+	// Returns NULL if 'path' must always be sent in full, i.e. it's too long, or another path has its ID.
+	if (length >= ARDJACK_MAX_MESSAGE_PATH_LENGTH)
+		return NULL;
+
+	uint32_t hash = Hash(path, length);
+	uint16_t id = Id(hash);
+
+	for (int i = 0; i < SentCount; i++)
+	{
+		if (Id(Sent[i].Hash) == id)
+		{
+			if ((Sent[i].Hash == hash) && (strncmp(Sent[i].Path, path, length) == 0) && (Sent[i].Path[length] == NULL))
+				return &Sent[i];
+
+			return NULL;
+		}
+	}
+
+	// The peer forgets nothing it has learned, so replacing an entry here can't make the two sides disagree.
+	MessagePathEntry* entry;
+
+	if (SentCount < ARDJACK_MAX_MESSAGE_PATHS)
+		entry = &Sent[SentCount++];
+	else
+	{
+		entry = &Sent[_SentNext];
+		_SentNext = (_SentNext + 1) % ARDJACK_MAX_MESSAGE_PATHS;
+	}
+
+	entry->Acknowledged = false;
+	entry->Hash = hash;
+	entry->Uses = 0;
+	memcpy(entry->Path, path, length);
+	entry->Path[length] = NULL;
+
+	return entry;
+}
+
+
+bool MessagePeerPaths::Learn(const char* path, int length)
+{
+	// The peer has sent 'path' ('length' chars, not NULL-terminated) in full - remember it, so that the peer can send
+	// its ID instead, and queue an acknowledgement.
+	// Entries are never replaced (so an ID the peer has been told it can use always stays valid), and a path whose ID
+	// is taken by another isn't learned - either way, the peer just keeps sending it in full.
+	if (length >= ARDJACK_MAX_MESSAGE_PATH_LENGTH)
+		return false;
+
+	uint32_t hash = Hash(path, length);
+	uint16_t id = Id(hash);
+	bool known = false;
+
+	for (int i = 0; i < ReceivedCount; i++)
+	{
+		if (Id(Received[i].Hash) == id)
+		{
+			if ((Received[i].Hash != hash) || (strncmp(Received[i].Path, path, length) != 0) ||
+				(Received[i].Path[length] != NULL))
+				return false;
+
+			known = true;
+			break;
+		}
+	}
+
+	if (!known)
+	{
+		if (ReceivedCount >= ARDJACK_MAX_MESSAGE_PATHS)
+			return false;
+
+		MessagePathEntry* entry = &Received[ReceivedCount++];
+		entry->Hash = hash;
+		memcpy(entry->Path, path, length);
+		entry->Path[length] = NULL;
+	}
+
+	for (int i = 0; i < AckCount; i++)
+	{
+		if (Acks[i] == hash)
+			return true;
+	}
+
+	if (AckCount < ARDJACK_MAX_MESSAGE_PATHS)
+		Acks[AckCount++] = hash;
+
+	return true;
+}
+
+
+const char* MessagePeerPaths::Lookup(uint16_t id)
+{
+	// Get the path the peer has sent with ID 'id' or, if there isn't one, NULL.
+	for (int i = 0; i < ReceivedCount; i++)
+	{
+		if (Id(Received[i].Hash) == id)
+			return Received[i].Path;
+	}
+
+	return NULL;
+}
+
+
+
+
+MessagePathTable::MessagePathTable()
+{
+	_PeerCount = 0;
+
+	for (int i = 0; i < ARDJACK_MAX_MESSAGE_PEERS; i++)
+		_Peers[i] = NULL;
+}
+
+
+MessagePathTable::~MessagePathTable()
+{
+	Clear();
+}
+
+
+void MessagePathTable::Clear()
+{
+	// Forget all peers, e.g. when a Connection is reactivated.
+	Lock();
+
+	for (int i = 0; i < _PeerCount; i++)
+	{
+		delete _Peers[i];
+		_Peers[i] = NULL;
+	}
+
+	_PeerCount = 0;
+
+	Unlock();
+}
+
+
+MessagePeerPaths* MessagePathTable::GetPeer(uint32_t address)
+{
+	// Get the paths for the peer at 'address', adding them if necessary (call within 'Lock' / 'Unlock').
+	// Returns NULL if there are already ARDJACK_MAX_MESSAGE_PEERS peers - paths to and from any others are sent in full.
+	for (int i = 0; i < _PeerCount; i++)
+	{
+		if (_Peers[i]->Address == address)
+			return _Peers[i];
+	}
+
+	if (_PeerCount >= ARDJACK_MAX_MESSAGE_PEERS)
+		return NULL;
+
+	MessagePeerPaths* peer = new MessagePeerPaths(address);
+
+	if (NULL == peer)
+	{
+		Log::LogError(PRM("MessagePathTable::GetPeer: Failed to allocate a peer"));
+		return NULL;
+	}
+
+	_Peers[_PeerCount++] = peer;
+
+	return peer;
+}
+
+
+void MessagePathTable::Lock()
+{
+#ifdef ARDUINO
+#else
+	while (_Lock.test_and_set(std::memory_order_acquire))
+		;
+#endif
+}
+
+
+void MessagePathTable::Unlock()
+{
+#ifdef ARDUINO
+#else
+	_Lock.clear(std::memory_order_release);
+#endif
+}
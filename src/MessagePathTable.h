@@ -0,0 +1,99 @@
+/*
+	MessagePathTable.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+
+	#include <atomic>
+#endif
+
+#include "Globals.h"
+
+
+
+// A format 2 IoTMessage path, interned for one peer.
+struct MessagePathEntry
+{
+	bool Acknowledged = false;											// (sent) has the peer learned 'Path'?
+	uint32_t Hash = 0;													// of 'Path' - its ID is this, folded to 16 bits
+	uint8_t Uses = 0;													// (sent) no.of encodes since 'Path' was last sent in full
+	char Path[ARDJACK_MAX_MESSAGE_PATH_LENGTH] = "";
+};
+
+
+// The format 2 paths exchanged with one peer.
+// A path is sent in full until the peer acknowledges it, and only then as its ID (plus in full every
+// ARDJACK_MESSAGE_PATH_REFRESH uses). A peer acknowledges a path it has learned in its next message back.
+class MessagePeerPaths
+{
+protected:
+	uint8_t _SentNext;													// next entry in 'Sent' to replace when it's full
+
+public:
+	uint32_t Acks[ARDJACK_MAX_MESSAGE_PATHS];							// hashes of paths learned, to be acknowledged
+	uint8_t AckCount;
+	uint32_t Address;													// the peer, e.g. its IPv4 address (0 = the only peer)
+	MessagePathEntry Received[ARDJACK_MAX_MESSAGE_PATHS];				// paths learned from the peer, never replaced
+	uint8_t ReceivedCount;
+	MessagePathEntry Sent[ARDJACK_MAX_MESSAGE_PATHS];					// paths sent to the peer
+	uint8_t SentCount;
+
+	MessagePeerPaths(uint32_t address);
+
+	static uint16_t Id(uint32_t hash);
+	static uint32_t Hash(const char* path, int length);
+
+	virtual void Acknowledge(uint32_t hash);
+	virtual MessagePathEntry* Intern(const char* path, int length);
+	virtual bool Learn(const char* path, int length);
+	virtual const char* Lookup(uint16_t id);
+};
+
+
+// A Connection's format 2 paths, per peer.
+class MessagePathTable
+{
+protected:
+#ifdef ARDUINO
+#else
+	std::atomic_flag _Lock = ATOMIC_FLAG_INIT;							// Connections encode and decode on different threads
+#endif
+	uint8_t _PeerCount;
+	MessagePeerPaths* _Peers[ARDJACK_MAX_MESSAGE_PEERS];
+
+public:
+	MessagePathTable();
+	~MessagePathTable();
+
+	virtual void Clear();
+	virtual MessagePeerPaths* GetPeer(uint32_t address);
+	virtual void Lock();
+	virtual void Unlock();
+};
+
@@ -0,0 +1,256 @@
+/*
+	Metrics.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_METRICS
+
+#include "Log.h"
+#include "Metrics.h"
+#include "Utils.h"
+
+
+
+Metric::Metric()
+{
+	Name[0] = NULL;
+	Type = ARDJACK_METRIC_TYPE_COUNTER;
+
+	Reset();
+}
+
+
+void Metric::Add(long delta)
+{
+	Value += delta;
+}
+
+
+int Metric::BucketIndex(unsigned long value)
+{
+	// Values below 8 have a bucket each, then each power of 2 is split into 4 buckets, so a bucket is never
+	// wider than a quarter of its start value.
+	if (value > 0xFFFFFFFFUL)
+		value = 0xFFFFFFFFUL;
+
+	if (value < 8)
+		return (int)value;
+
+	int shift = 0;
+
+	while (value >= 8)
+	{
+		value >>= 1;
+		shift++;
+	}
+
+	return 4 * (shift + 1) + (int)value - 4;
+}
+
+
+unsigned long Metric::BucketStart(int index)
+{
+	// The smallest value in bucket 'index'.
+	if (index < 8)
+		return index;
+
+	return (unsigned long)(4 + index % 4) << (index / 4 - 1);
+}
+
+
+unsigned long Metric::Mean()
+{
+	return (Count > 0) ? (unsigned long)(Total / Count) : 0;
+}
+
+
+unsigned long Metric::Percentile(int percent)
+{
+	// Get the 'percent' percentile, as the end of the bucket it falls in (but no more than 'Max').
+	if (Count == 0)
+		return 0;
+
+	unsigned long target = (unsigned long)(((double)Count * percent + 99) / 100);
+	if (target < 1)
+		target = 1;
+
+	unsigned long total = 0;
+
+	for (int i = 0; i < ARDJACK_METRIC_BUCKETS - 1; i++)
+	{
+		total += _Buckets[i];
+
+		if (total >= target)
+		{
+			unsigned long result = BucketStart(i + 1) - 1;
+			return (result < Max) ? result : Max;
+		}
+	}
+
+	return Max;
+}
+
+
+void Metric::Record(unsigned long value)
+{
+	// Add a sample (e.g. a duration in us) to the histogram.
+	_Buckets[BucketIndex(value)]++;
+	Count++;
+	Total += value;
+
+	if (value > Max)
+		Max = value;
+}
+
+
+void Metric::Reset()
+{
+	for (int i = 0; i < ARDJACK_METRIC_BUCKETS; i++)
+		_Buckets[i] = 0;
+
+	Count = 0;
+	Max = 0;
+	Total = 0.0;
+	Value = 0;
+}
+
+
+void Metric::SetLevel(long value)
+{
+	// Set a gauge's level.
+	Value = value;
+
+	if ((value > 0) && ((unsigned long)value > Max))
+		Max = value;
+}
+
+
+char* Metric::ToString(char* text)
+{
+	switch (Type)
+	{
+	case ARDJACK_METRIC_TYPE_GAUGE:
+		sprintf(text, PRM("value %ld max %lu"), Value, Max);
+		break;
+
+	case ARDJACK_METRIC_TYPE_HISTOGRAM:
+		sprintf(text, PRM("count %lu p50 %lu p99 %lu max %lu mean %lu"), Count, Percentile(50), Percentile(99), Max, Mean());
+		break;
+
+	default:
+		sprintf(text, PRM("count %ld"), Value);
+		break;
+	}
+
+	return text;
+}
+
+
+
+int Metrics::Count = 0;
+Metric Metrics::Items[ARDJACK_MAX_METRICS];
+
+
+int Metrics::AddMetric(const char* name, int type)
+{
+	// Add a Metric, returning its ID (its index in 'Items') or -1.
+	if (Count >= ARDJACK_MAX_METRICS)
+	{
+		Log::LogErrorF(PRM("Metrics::AddMetric: Can't add '%s' - too many Metrics"), name);
+		return -1;
+	}
+
+	Metric* metric = &Items[Count];
+	strcpy(metric->Name, name);
+	metric->Type = type;
+	metric->Reset();
+
+	return Count++;
+}
+
+
+bool Metrics::Init()
+{
+	// Add the built-in Metrics, in 'ARDJACK_METRIC_...' order.
+	Count = 0;
+
+	AddMetric(PRM("conn_route"), ARDJACK_METRIC_TYPE_HISTOGRAM);
+	AddMetric(PRM("conn_rx"), ARDJACK_METRIC_TYPE_COUNTER);
+	AddMetric(PRM("conn_tx"), ARDJACK_METRIC_TYPE_COUNTER);
+	AddMetric(PRM("device_operation"), ARDJACK_METRIC_TYPE_HISTOGRAM);
+	AddMetric(PRM("device_queue"), ARDJACK_METRIC_TYPE_HISTOGRAM);
+	AddMetric(PRM("device_queued"), ARDJACK_METRIC_TYPE_GAUGE);
+	AddMetric(PRM("device_response"), ARDJACK_METRIC_TYPE_HISTOGRAM);
+	AddMetric(PRM("output_dropped"), ARDJACK_METRIC_TYPE_COUNTER);
+	AddMetric(PRM("output_queue"), ARDJACK_METRIC_TYPE_HISTOGRAM);
+	AddMetric(PRM("output_queued"), ARDJACK_METRIC_TYPE_GAUGE);
+
+	return true;
+}
+
+
+Metric* Metrics::LookupMetric(const char* name)
+{
+	for (int i = 0; i < Count; i++)
+	{
+		if (Utils::StringEquals(Items[i].Name, name))
+			return &Items[i];
+	}
+
+	return NULL;
+}
+
+
+void Metrics::Reset()
+{
+	for (int i = 0; i < Count; i++)
+		Items[i].Reset();
+}
+
+
+const char* Metrics::TypeName(int type)
+{
+	switch (type)
+	{
+	case ARDJACK_METRIC_TYPE_GAUGE:
+		return PRM("gauge");
+
+	case ARDJACK_METRIC_TYPE_HISTOGRAM:
+		return PRM("histogram");
+
+	default:
+		return PRM("counter");
+	}
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+	Metrics.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_METRICS
+
+#define ARDJACK_METRIC_BUCKETS 124										// log-linear buckets covering 32-bit values (4 per power of 2)
+
+
+
+// A counter, a gauge or a latency histogram.
+class Metric
+{
+protected:
+	uint32_t _Buckets[ARDJACK_METRIC_BUCKETS];							// histogram sample counts
+
+public:
+	unsigned long Count;												// histogram samples
+	unsigned long Max;													// max.histogram sample, or gauge high water mark
+	char Name[ARDJACK_MAX_NAME_LENGTH];
+	double Total;														// sum of histogram samples
+	uint8_t Type;														// ARDJACK_METRIC_TYPE_...
+	long Value;															// counter total, or gauge level
+
+	Metric();
+
+	static int BucketIndex(unsigned long value);
+	static unsigned long BucketStart(int index);
+
+	virtual void Add(long delta = 1);
+	virtual unsigned long Mean();
+	virtual unsigned long Percentile(int percent);
+	virtual void Record(unsigned long value);
+	virtual void Reset();
+	virtual void SetLevel(long value);
+	virtual char* ToString(char* text);
+};
+
+
+// The Metrics registry - the built-in Metrics (see 'ARDJACK_METRIC_...') followed by any others added.
+// Metrics are updated without locking, so on hosts with several threads the figures are approximate.
+class Metrics
+{
+public:
+	static int Count;
+	static Metric Items[ARDJACK_MAX_METRICS];
+
+	static int AddMetric(const char* name, int type);
+	static bool Init();
+	static Metric* LookupMetric(const char* name);
+	static void Reset();
+	static const char* TypeName(int type);
+};
+
+#endif
@@ -0,0 +1,186 @@
+/*
+	PartIndex.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+#include "Part.h"
+#include "PartIndex.h"
+#include "Utils.h"
+
+
+
+PartIndex::PartIndex()
+{
+	Clear();
+}
+
+
+void PartIndex::Add(Part* parts[], int index)
+{
+	// Index 'parts[index]', which must be new.
+	Part* part = parts[index];
+
+	SetCategory(index, ARDJACK_PART_CATEGORY_ANALOG, part->IsAnalog());
+	SetCategory(index, ARDJACK_PART_CATEGORY_DIGITAL, part->IsDigital());
+	SetCategory(index, ARDJACK_PART_CATEGORY_INPUT, part->IsInput());
+	SetCategory(index, ARDJACK_PART_CATEGORY_NOTIFYING, part->Notifying);
+	SetCategory(index, ARDJACK_PART_CATEGORY_OUTPUT, part->IsOutput());
+	SetCategory(index, ARDJACK_PART_CATEGORY_TEXTUAL, part->IsTextual());
+
+#ifdef ARDJACK_INCLUDE_PART_INDEX
+	// Linear probing - the index is never more than half full.
+	uint32_t hash = Utils::HashText(part->Name);
+	int i = hash & (ARDJACK_PART_INDEX_SIZE - 1);
+
+	while (_Names[i] >= 0)
+		i = (i + 1) & (ARDJACK_PART_INDEX_SIZE - 1);
+
+	_Hashes[index] = hash;
+	_Names[i] = index;
+#endif
+}
+
+
+void PartIndex::Clear()
+{
+	for (int category = 0; category < ARDJACK_PART_CATEGORIES; category++)
+	{
+		for (int word = 0; word < ARDJACK_PART_INDEX_WORDS; word++)
+			_Bits[category][word] = 0;
+	}
+
+#ifdef ARDJACK_INCLUDE_PART_INDEX
+	for (int i = 0; i < ARDJACK_PART_INDEX_SIZE; i++)
+		_Names[i] = -1;
+#endif
+}
+
+
+int PartIndex::Find(Part* parts[], int count, const char* name)
+{
+	// Returns the index of the Part called 'name' (case-insensitive), or -1.
+#ifdef ARDJACK_INCLUDE_PART_INDEX
+	uint32_t hash = Utils::HashText(name);
+	int i = hash & (ARDJACK_PART_INDEX_SIZE - 1);
+
+	while (_Names[i] >= 0)
+	{
+		int index = _Names[i];
+
+		if ((_Hashes[index] == hash) && Utils::StringEquals(parts[index]->Name, name))
+			return index;
+
+		i = (i + 1) & (ARDJACK_PART_INDEX_SIZE - 1);
+	}
+#else
+	for (int index = 0; index < count; index++)
+	{
+		if (Utils::StringEquals(parts[index]->Name, name))
+			return index;
+	}
+#endif
+
+	return -1;
+}
+
+
+uint32_t PartIndex::GetWord(int word, uint8_t all, uint8_t any)
+{
+	// Combine the category bitsets for 'word': in every category in 'all', and (if 'any' isn't 0) in one of 'any'.
+	uint32_t result = 0xFFFFFFFF;
+	uint32_t anyBits = 0;
+
+	for (int category = 0; category < ARDJACK_PART_CATEGORIES; category++)
+	{
+		uint8_t mask = 1 << category;
+
+		if ((all & mask) != 0)
+			result &= _Bits[category][word];
+
+		if ((any & mask) != 0)
+			anyBits |= _Bits[category][word];
+	}
+
+	if (any != 0)
+		result &= anyBits;
+
+	return result;
+}
+
+
+int PartIndex::Next(int count, uint8_t all, uint8_t any, int index)
+{
+	// Returns the index of the first Part at or after 'index' that's in the categories 'all' and 'any' (see 'GetWord'),
+	// or -1.
+	while (index < count)
+	{
+		int word = index / 32;
+		uint32_t bits = GetWord(word, all, any) >> (index % 32);
+
+		if (bits == 0)
+		{
+			// Skip the rest of this word.
+			index = (word + 1) * 32;
+			continue;
+		}
+
+		while ((bits & 1) == 0)
+		{
+			bits >>= 1;
+			index++;
+		}
+
+		return (index < count) ? index : -1;
+	}
+
+	return -1;
+}
+
+
+void PartIndex::Rebuild(Part* parts[], int count)
+{
+	Clear();
+
+	for (int i = 0; i < count; i++)
+		Add(parts, i);
+}
+
+
+void PartIndex::SetCategory(int index, int category, bool state)
+{
+	uint32_t bit = (uint32_t)1 << (index % 32);
+
+	if (state)
+		_Bits[category][index / 32] |= bit;
+	else
+		_Bits[category][index / 32] &= ~bit;
+}
@@ -0,0 +1,65 @@
+/*
+	PartIndex.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+class Part;
+
+#define ARDJACK_PART_INDEX_WORDS ((ARDJACK_MAX_PARTS + 31) / 32)
+
+
+
+// A Device's Part lookup structures: one bitset per Part category (bit 'i' is 'Parts[i]') and, on hosts, a name index.
+class PartIndex
+{
+protected:
+	uint32_t _Bits[ARDJACK_PART_CATEGORIES][ARDJACK_PART_INDEX_WORDS];
+
+#ifdef ARDJACK_INCLUDE_PART_INDEX
+	uint32_t _Hashes[ARDJACK_MAX_PARTS];
+	int16_t _Names[ARDJACK_PART_INDEX_SIZE];										// open-addressed name index of Parts (-1 = empty)
+#endif
+
+	virtual uint32_t GetWord(int word, uint8_t all, uint8_t any);
+
+public:
+	PartIndex();
+
+	virtual void Add(Part* parts[], int index);
+	virtual void Clear();
+	virtual int Find(Part* parts[], int count, const char* name);
+	virtual int Next(int count, uint8_t all, uint8_t any, int index);
+	virtual void Rebuild(Part* parts[], int count);
+	virtual void SetCategory(int index, int category, bool state);
+};
@@ -0,0 +1,115 @@
+/*
+	PollProfiler.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+
+#include "IoTObject.h"
+#include "Log.h"
+#include "PollProfiler.h"
+#include "Register.h"
+#include "Utils.h"
+
+
+
+int PollProfiler::TimerCount = 0;
+PollTimer PollProfiler::Timers[ARDJACK_MAX_POLL_TIMERS];
+
+
+int PollProfiler::AddTimer(const char* name, int periodMs)
+{
+	// Add a timer to profile, returning its index in 'Timers' or -1.
+	if (TimerCount >= ARDJACK_MAX_POLL_TIMERS)
+	{
+		Log::LogErrorF(PRM("PollProfiler::AddTimer: Can't add '%s' - too many timers"), name);
+		return -1;
+	}
+
+	PollTimer* timer = &Timers[TimerCount];
+	strcpy(timer->Name, name);
+	timer->PeriodMs = periodMs;
+	timer->Stats = PollStats();
+
+	return TimerCount++;
+}
+
+
+unsigned long PollProfiler::Record(PollStats* stats, unsigned long startUs)
+{
+	// Note a poll which started at 'startUs' and has just finished.
+	unsigned long duration = Utils::NowUs() - startUs;
+
+	stats->LastUs = duration;
+	stats->Polls++;
+	stats->TotalUs += duration;
+
+	if (duration > stats->MaxUs)
+		stats->MaxUs = duration;
+
+	return duration;
+}
+
+
+void PollProfiler::Reset()
+{
+	for (int i = 0; i < TimerCount; i++)
+		Timers[i].Stats = PollStats();
+
+	for (int i = 0; i < Globals::ObjectRegister->ObjectCount; i++)
+		Globals::ObjectRegister->Objects[i]->PollProfile = PollStats();
+}
+
+
+void PollProfiler::TimerSkipped(int timer, long count)
+{
+	// Note 'count' ticks of 'timer' which didn't run, e.g. because the previous tick was still busy.
+	if ((timer >= 0) && (timer < TimerCount))
+		Timers[timer].Stats.Skipped += count;
+}
+
+
+void PollProfiler::TimerTicked(int timer, unsigned long startUs)
+{
+	// Note a tick of 'timer' which started at 'startUs' and has just finished.
+	if ((timer < 0) || (timer >= TimerCount))
+		return;
+
+	PollTimer* item = &Timers[timer];
+	unsigned long duration = Record(&item->Stats, startUs);
+
+	if ((item->PeriodMs > 0) && (duration > (unsigned long)item->PeriodMs * 1000))
+		item->Stats.Overruns++;
+}
+
+#endif
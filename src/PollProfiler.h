@@ -0,0 +1,63 @@
+/*
+	PollProfiler.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_POLL_PROFILER
+
+
+
+struct PollTimer
+{
+	char Name[ARDJACK_MAX_NAME_LENGTH] = "";
+	int PeriodMs = 0;												// tick period (0 = none, so no overruns)
+	PollStats Stats;
+};
+
+
+// Notes how long each IoTObject's 'Poll' takes (in 'IoTObject::PollProfile'), and how the host's timer ticks fare.
+class PollProfiler
+{
+public:
+	static int TimerCount;
+	static PollTimer Timers[ARDJACK_MAX_POLL_TIMERS];
+
+	static int AddTimer(const char* name, int periodMs);
+	static unsigned long Record(PollStats* stats, unsigned long startUs);
+	static void Reset();
+	static void TimerSkipped(int timer, long count = 1);
+	static void TimerTicked(int timer, unsigned long startUs);
+};
+
+#endif
@@ -51,6 +51,7 @@
 #include "Register.h"
 #include "SerialConnection.h"
 #include "ShieldManager.h"
+#include "SimDevice.h"
 #include "Utils.h"
 
 #ifdef ARDUINO
@@ -61,6 +62,8 @@
 	#ifdef ARDJACK_WIFI_AVAILABLE
 		#include "WiFiInterface.h"
 	#endif
+#elif defined(ARDJACK_LINUX)
+	#include "LinuxDevice.h"
 #else
 	#include "ClipboardConnection.h"
 	#include "VellemanK8055Device.h"
@@ -83,7 +86,19 @@ Register::Register()
 		Log::LogInfo(PRM("Register ctor"));
 
 	for (int i = 0; i < ARDJACK_MAX_OBJECTS; i++)
+	{
+		_Generations[i] = 1;
+		_NextFreeSlots[i] = (i < ARDJACK_MAX_OBJECTS - 1) ? i + 1 : -1;
+		_Slots[i] = NULL;
 		Objects[i] = NULL;
+	}
+
+	_FreeSlot = 0;
+
+#ifdef ARDJACK_INCLUDE_REGISTER_INDEX
+	for (int i = 0; i < ARDJACK_REGISTER_INDEX_SIZE; i++)
+		_Index[i] = -1;
+#endif
 
 	ObjectCount = 0;
 
@@ -145,13 +160,14 @@ Register::~Register()
 
 bool Register::AddObject(IoTObject *addObj)
 {
+	// Is there already an object called 'addObj->Name'?
+	int slot = FindSlot(addObj->Name);
+	IoTObject* obj = (slot >= 0) ? _Slots[slot] : NULL;
+
 	// Do we already have 'addObj'?
-	if (LookupObject(addObj) >= 0)
+	if (obj == addObj)
 		return true;
 
-	// Is there already an object called 'addObj->Name'?
-	IoTObject* obj = LookupName(addObj->Name);
-
 	if (NULL != obj)
 	{
 		// An object called 'addObj->Name' is already present.
@@ -170,6 +186,11 @@ bool Register::AddObject(IoTObject *addObj)
 		int i = LookupObject(obj);
 		Objects[i] = addObj;
 
+		// Handles to the old object are now stale.
+		_Slots[slot] = addObj;
+		if (++_Generations[slot] == 0)
+			_Generations[slot] = 1;
+
 		return true;
 	}
 
@@ -186,8 +207,19 @@ bool Register::AddObject(IoTObject *addObj)
 	// Add this object.
 	Objects[ObjectCount++] = addObj;
 
-	Log::LogInfoF(PRM("Register::AddObject: Added '%s' (type '%s', subtype '%s')  (%d objects)"),
-		addObj->Name, ObjectTypeName(addObj->Type), ObjectSubtypeName(addObj->Type, addObj->Subtype), ObjectCount);
+	slot = _FreeSlot;
+	_FreeSlot = _NextFreeSlots[slot];
+	_Slots[slot] = addObj;
+
+#ifdef ARDJACK_INCLUDE_REGISTER_INDEX
+	IndexAdd(slot);
+#endif
+
+	if (Globals::Verbosity > 2)
+	{
+		Log::LogInfoF(PRM("Register::AddObject: Added '%s' (type '%s', subtype '%s')  (%d objects)"),
+			addObj->Name, ObjectTypeName(addObj->Type), ObjectSubtypeName(addObj->Type, addObj->Subtype), ObjectCount);
+	}
 
 	return true;
 }
@@ -219,6 +251,7 @@ IoTObject* Register::CreateObject(int type, int subtype, const char* name)
 		switch (subtype)
 		{
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
 #else
 		case ARDJACK_CONNECTION_SUBTYPE_CLIPBOARD:
 			result = new ClipboardConnection(name);
@@ -269,6 +302,10 @@ IoTObject* Register::CreateObject(int type, int subtype, const char* name)
 		case ARDJACK_DEVICE_SUBTYPE_ARDUINO:
 			result = new ArduinoDevice(name);
 			break;
+#elif defined(ARDJACK_LINUX)
+		case ARDJACK_DEVICE_SUBTYPE_LINUX:
+			result = new LinuxDevice(name);
+			break;
 #else
 		case ARDJACK_DEVICE_SUBTYPE_VELLEMANK8055:
 			result = new VellemanK8055Device(name);
@@ -278,6 +315,12 @@ IoTObject* Register::CreateObject(int type, int subtype, const char* name)
 			result = new WinDevice(name);
 			break;
 #endif
+
+#ifdef ARDJACK_INCLUDE_SIM_DEVICE
+		case ARDJACK_DEVICE_SUBTYPE_SIM:
+			result = new SimDevice(name);
+			break;
+#endif
 		}
 		break;
 
@@ -361,6 +404,11 @@ bool Register::DeleteObject(IoTObject* obj)
 	ArrayHelpers::RemoveElement((void**)Objects, ObjectCount, i);
 	ObjectCount--;
 
+	int slot = FindSlot(objName);
+
+	if ((slot >= 0) && (_Slots[slot] == obj))
+		FreeSlot(slot);
+
 	delete obj;
 
 	if (Globals::Verbosity > 3)
@@ -370,15 +418,153 @@ bool Register::DeleteObject(IoTObject* obj)
 }
 
 
-IoTObject *Register::LookupName(const char* name, bool quiet)
+int Register::FindSlot(const char* name)
 {
-	for (int i = 0; i < ObjectCount; i++)
+#ifdef ARDJACK_INCLUDE_REGISTER_INDEX
+	uint32_t hash = Utils::HashText(name);
+	int i = hash & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+
+	while (_Index[i] >= 0)
 	{
-		IoTObject* obj = Objects[i];
+		int slot = _Index[i];
 
-		if (Utils::StringEquals(obj->Name, name))
-			return obj;
+		if ((_SlotHashes[slot] == hash) && Utils::StringEquals(_Slots[slot]->Name, name))
+			return slot;
+
+		i = (i + 1) & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+	}
+#else
+	for (int slot = 0; slot < ARDJACK_MAX_OBJECTS; slot++)
+	{
+		if ((NULL != _Slots[slot]) && Utils::StringEquals(_Slots[slot]->Name, name))
+			return slot;
 	}
+#endif
+
+	return -1;
+}
+
+
+void Register::FreeSlot(int slot)
+{
+#ifdef ARDJACK_INCLUDE_REGISTER_INDEX
+	IndexRemove(slot);
+#endif
+
+	// Handles to the slot's object are now stale.
+	if (++_Generations[slot] == 0)
+		_Generations[slot] = 1;
+
+	_NextFreeSlots[slot] = _FreeSlot;
+	_FreeSlot = slot;
+	_Slots[slot] = NULL;
+}
+
+
+ObjectHandle Register::GetHandle(IoTObject* obj)
+{
+	ObjectHandle result;
+	result.Generation = 0;
+	result.Slot = 0;
+
+	if (NULL == obj)
+		return result;
+
+	int slot = FindSlot(obj->Name);
+
+	if ((slot >= 0) && (_Slots[slot] == obj))
+	{
+		result.Generation = _Generations[slot];
+		result.Slot = slot;
+	}
+
+	return result;
+}
+
+
+#ifdef ARDJACK_INCLUDE_REGISTER_INDEX
+
+void Register::IndexAdd(int slot)
+{
+	// Linear probing - the index is never more than half full.
+	uint32_t hash = Utils::HashText(_Slots[slot]->Name);
+	int i = hash & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+
+	while (_Index[i] >= 0)
+		i = (i + 1) & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+
+	_Index[i] = slot;
+	_SlotHashes[slot] = hash;
+}
+
+
+void Register::IndexRemove(int slot)
+{
+	int i = _SlotHashes[slot] & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+
+	while (_Index[i] != slot)
+	{
+		if (_Index[i] < 0)
+			return;
+
+		i = (i + 1) & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+	}
+
+	// Shift later entries of the probe run back, so lookups never stop early at the gap.
+	int j = i;
+
+	while (true)
+	{
+		_Index[i] = -1;
+
+		while (true)
+		{
+			j = (j + 1) & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+
+			if (_Index[j] < 0)
+				return;
+
+			// Can the entry at 'j' move back to 'i', i.e. is its home outside the cyclic range (i, j]?
+			int home = _SlotHashes[_Index[j]] & (ARDJACK_REGISTER_INDEX_SIZE - 1);
+
+			if ((i <= j) ? ((home <= i) || (home > j)) : ((home <= i) && (home > j)))
+				break;
+		}
+
+		_Index[i] = _Index[j];
+		i = j;
+	}
+}
+
+#endif
+
+
+ObjectHandle Register::LookupHandle(const char* name, bool quiet)
+{
+	ObjectHandle result;
+	result.Generation = 0;
+	result.Slot = 0;
+
+	int slot = FindSlot(name);
+
+	if (slot >= 0)
+	{
+		result.Generation = _Generations[slot];
+		result.Slot = slot;
+	}
+	else if (!quiet)
+		Log::LogError(PRM("Register: No such object: '"), name, "'");
+
+	return result;
+}
+
+
+IoTObject *Register::LookupName(const char* name, bool quiet)
+{
+	int slot = FindSlot(name);
+
+	if (slot >= 0)
+		return _Slots[slot];
 
 	if (!quiet)
 		Log::LogError(PRM("Register: No such object: '"), name, "'");
@@ -441,3 +627,11 @@ const char* Register::ObjectTypeName(int type, const char* defaultName)
 	return ObjectTypes->LookupValue(type, defaultName);
 }
 
+
+IoTObject* Register::Resolve(ObjectHandle handle)
+{
+	if ((handle.Generation == 0) || (handle.Slot >= ARDJACK_MAX_OBJECTS) || (handle.Generation != _Generations[handle.Slot]))
+		return NULL;
+
+	return _Slots[handle.Slot];
+}
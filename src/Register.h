@@ -36,9 +36,34 @@ class IoTObject;
 
 
 
+// A reference to a registered object that can be cached - 'Register::Resolve' returns NULL once the object has
+// been deleted or replaced.
+struct ObjectHandle
+{
+	uint16_t Slot;
+	uint16_t Generation;															// 0 = no object
+};
+
+
+
 class Register
 {
 protected:
+	int16_t _FreeSlot;																// first free slot (-1 = none)
+	uint16_t _Generations[ARDJACK_MAX_OBJECTS];										// bumped whenever a slot's object changes
+	int16_t _NextFreeSlots[ARDJACK_MAX_OBJECTS];
+	IoTObject* _Slots[ARDJACK_MAX_OBJECTS];
+
+#ifdef ARDJACK_INCLUDE_REGISTER_INDEX
+	int16_t _Index[ARDJACK_REGISTER_INDEX_SIZE];									// open-addressed name index of slots (-1 = empty)
+	uint32_t _SlotHashes[ARDJACK_MAX_OBJECTS];
+
+	virtual void IndexAdd(int slot);
+	virtual void IndexRemove(int slot);
+#endif
+
+	virtual int FindSlot(const char* name);
+	virtual void FreeSlot(int slot);
 
 public:
 	static Enumeration* ObjectTypes;
@@ -52,10 +77,13 @@ public:
 	virtual bool AddObject(IoTObject *object);
 	virtual IoTObject* CreateObject(int type, int subtype, const char* name);
 	virtual bool DeleteObject(IoTObject* object);
+	virtual ObjectHandle GetHandle(IoTObject* object);
+	virtual ObjectHandle LookupHandle(const char* name, bool quiet = true);
 	virtual IoTObject* LookupName(const char* name, bool quiet = true);
 	virtual int LookupObject(IoTObject *object, bool quiet = true);
 	virtual int LookupObjectType(const char* name, int defaultValue = -1, bool quiet = true);
 	static const char* ObjectSubtypeName(int type, int subtype, const char* defaultName = "-");
 	static const char* ObjectTypeName(int type, const char* defaultName = "-");
+	virtual IoTObject* Resolve(ObjectHandle handle);
 };
 
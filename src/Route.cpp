@@ -31,6 +31,7 @@
 #endif
 
 #include "Log.h"
+#include "Metrics.h"
 #include "Route.h"
 #include "Utils.h"
 
@@ -80,6 +81,9 @@ bool Route::Handle(IoTMessage* msg)
 	{
 		CommandBufferItem item;
 		item.Dev = Target;
+#ifdef ARDJACK_INCLUDE_METRICS
+		item.QueuedUs = Utils::NowUs();
+#endif
 		strcpy(item.Text, msg->Text());
 		Buffer->Push(&item);
 	}
@@ -0,0 +1,308 @@
+/*
+	RouteTable.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_ROUTE_TABLE
+
+#include "IoTMessage.h"
+#include "Log.h"
+#include "MessageFilter.h"
+#include "Route.h"
+#include "RouteTable.h"
+#include "Utils.h"
+
+
+
+RouteTrie::RouteTrie()
+{
+	_Count = 0;
+	_Nodes = NULL;
+	_Size = 0;
+}
+
+
+RouteTrie::~RouteTrie()
+{
+	if (NULL != _Nodes)
+		Utils::MemFree(_Nodes);
+}
+
+
+bool RouteTrie::Add(const char* key, bool reverse, RouteMask routes)
+{
+	// Add 'key' (lower case, and reversed if 'reverse'), marking its last node with 'routes'.
+	int length = (int)strlen(key);
+	uint16_t node = 0;
+
+	for (int i = 0; i < length; i++)
+	{
+		char c = tolower(key[reverse ? length - 1 - i : i]);
+		uint16_t child = _Nodes[node].Child;
+
+		while ((child != 0) && (_Nodes[child].Char != c))
+			child = _Nodes[child].Next;
+
+		if (child == 0)
+		{
+			if (_Count >= _Size)
+				return false;
+
+			child = _Count++;
+			_Nodes[child].Char = c;
+			_Nodes[child].Child = 0;
+			_Nodes[child].Next = _Nodes[node].Child;
+			_Nodes[child].Routes = 0;
+			_Nodes[node].Child = child;
+		}
+
+		node = child;
+	}
+
+	_Nodes[node].Routes |= routes;
+
+	return true;
+}
+
+
+void RouteTrie::Clear(int size)
+{
+	// Make room for 'size' nodes (plus the root).
+	if (size + 1 > _Size)
+	{
+		if (NULL != _Nodes)
+			Utils::MemFree(_Nodes);
+
+		_Nodes = (RouteTrieNode*)Utils::MemMalloc((size + 1) * sizeof(RouteTrieNode));
+		_Size = (NULL == _Nodes) ? 0 : size + 1;
+	}
+
+	_Count = (_Size > 0) ? 1 : 0;
+
+	if (_Size > 0)
+	{
+		_Nodes[0].Char = NULL;
+		_Nodes[0].Child = 0;
+		_Nodes[0].Next = 0;
+		_Nodes[0].Routes = 0;
+	}
+}
+
+
+RouteMask RouteTrie::Match(const char* text, bool reverse)
+{
+	// Get the Routes of every key which 'text' starts with (or ends with, if 'reverse').
+	if (_Count <= 1)
+		return 0;
+
+	RouteMask result = 0;
+	int length = (int)strlen(text);
+	uint16_t node = 0;
+
+	for (int i = 0; i < length; i++)
+	{
+		char c = tolower(text[reverse ? length - 1 - i : i]);
+		uint16_t child = _Nodes[node].Child;
+
+		while ((child != 0) && (_Nodes[child].Char != c))
+			child = _Nodes[child].Next;
+
+		if (child == 0)
+			break;
+
+		node = child;
+		result |= _Nodes[node].Routes;
+	}
+
+	return result;
+}
+
+
+
+RouteTable::RouteTable()
+{
+	_Compiled = 0;
+	_Generic = 0;
+	_NoTextFilter = 0;
+	_NoToFilter = 0;
+	_NoTypeFilter = 0;
+	_TypeCount = 0;
+}
+
+
+bool RouteTable::Compile(Route* routes[], int count)
+{
+	// Build the lookups for 'routes' (excluding 'AlwaysUse' ones).
+	// Routes with filters that can't be looked up (e.g. 'contains', or case-sensitive) are marked as generic, so that
+	// the caller evaluates them as before.
+	_Compiled = 0;
+	_Generic = 0;
+	_NoTextFilter = 0;
+	_NoToFilter = 0;
+	_NoTypeFilter = 0;
+	_TypeCount = 0;
+
+	int genericCount = 0;
+	int textChars = 0;
+	int toChars = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		textChars += (int)strlen(routes[i]->Filter.TextFilter.Text);
+		toChars += (int)strlen(routes[i]->Filter.ToFilter.Text);
+	}
+
+	_TextPrefixes.Clear(textChars);
+	_ToSuffixes.Clear(toChars);
+
+	for (int i = 0; i < count; i++)
+	{
+		Route* route = routes[i];
+		MessageFilter* filter = &route->Filter;
+		RouteMask bit = (RouteMask)1 << i;
+
+		if (route->AlwaysUse)
+			continue;
+
+		bool compiled = IsPass(&filter->BodyFilter) && IsPass(&filter->FromFilter) && IsPass(&filter->ReturnFilter);
+
+		compiled = compiled && (IsPass(&filter->TextFilter) ||
+			((filter->TextFilter.Operation == ARDJACK_STRING_COMPARE_STARTS_WITH) && filter->TextFilter.IgnoreCase));
+		compiled = compiled && (IsPass(&filter->ToFilter) ||
+			((filter->ToFilter.Operation == ARDJACK_STRING_COMPARE_ENDS_WITH) && filter->ToFilter.IgnoreCase));
+		compiled = compiled && (IsPass(&filter->TypeFilter) ||
+			((filter->TypeFilter.Operation == ARDJACK_STRING_COMPARE_EQUALS) && filter->TypeFilter.IgnoreCase));
+
+		if (compiled && !IsPass(&filter->TextFilter))
+			compiled = _TextPrefixes.Add(filter->TextFilter.Text, false, bit);
+
+		if (compiled && !IsPass(&filter->ToFilter))
+			compiled = _ToSuffixes.Add(filter->ToFilter.Text, true, bit);
+
+		if (!compiled)
+		{
+			_Generic |= bit;
+			genericCount++;
+			continue;
+		}
+
+		_Compiled |= bit;
+
+		if (IsPass(&filter->TextFilter))
+			_NoTextFilter |= bit;
+
+		if (IsPass(&filter->ToFilter))
+			_NoToFilter |= bit;
+
+		if (IsPass(&filter->TypeFilter))
+		{
+			_NoTypeFilter |= bit;
+			continue;
+		}
+
+		// Add to the 'Type' entries.
+		uint32_t hash = Utils::HashText(filter->TypeFilter.Text);
+		int j = 0;
+
+		while ((j < _TypeCount) && !((_Types[j].Hash == hash) && Utils::StringEquals(_Types[j].Name, filter->TypeFilter.Text)))
+			j++;
+
+		if (j == _TypeCount)
+		{
+			_Types[j].Hash = hash;
+			_Types[j].Name = filter->TypeFilter.Text;
+			_Types[j].Routes = 0;
+			_TypeCount++;
+		}
+
+		_Types[j].Routes |= bit;
+	}
+
+	if (Globals::Verbosity > 5)
+	{
+		Log::LogInfoF(PRM("RouteTable::Compile: %d Routes, %d types, %d generic"), count, _TypeCount, genericCount);
+	}
+
+	return true;
+}
+
+
+bool RouteTable::IsGeneric(int index)
+{
+	return (_Generic & ((RouteMask)1 << index)) != 0;
+}
+
+
+bool RouteTable::IsPass(MessageFilterItem* item)
+{
+	// Does 'item' pass every value? (Inactive filter items are ignored by 'MessageFilter::EvaluateMessage'.)
+	return !item->Active() || (item->Operation == ARDJACK_STRING_COMPARE_TRUE);
+}
+
+
+RouteMask RouteTable::Lookup(IoTMessage* msg)
+{
+	// Get the candidate Routes for 'msg': the compiled Routes which match it, plus all the generic Routes.
+	RouteMask result;
+
+	switch (msg->Format)
+	{
+	case ARDJACK_MESSAGE_FORMAT_0:
+		result = (_TextPrefixes.Match(msg->Text(), false) | _NoTextFilter) & _Compiled;
+		break;
+
+	default:
+		{
+			RouteMask types = _NoTypeFilter;
+
+			if (_TypeCount > 0)
+			{
+				const char* type = msg->Type();
+				uint32_t hash = Utils::HashText(type);
+
+				for (int i = 0; i < _TypeCount; i++)
+				{
+					if ((_Types[i].Hash == hash) && Utils::StringEquals(_Types[i].Name, type))
+						types |= _Types[i].Routes;
+				}
+			}
+
+			result = types & (_ToSuffixes.Match(msg->ToPath(), true) | _NoToFilter) & _Compiled;
+		}
+		break;
+	}
+
+	return result | _Generic;
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+	RouteTable.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_ROUTE_TABLE
+
+class IoTMessage;
+class MessageFilterItem;
+class Route;
+
+typedef uint64_t RouteMask;												// bit 'i' is 'Routes[i]' (so at most 64 Routes)
+
+
+
+struct RouteTrieNode
+{
+	char Char;
+	uint16_t Child;														// first child, or 0
+	uint16_t Next;														// next sibling, or 0
+	RouteMask Routes;													// Routes whose key ends here
+};
+
+
+struct RouteTypeEntry
+{
+	uint32_t Hash;
+	const char* Name;													// the Route's Type filter text
+	RouteMask Routes;
+};
+
+
+
+class RouteTrie
+{
+protected:
+	uint16_t _Count;
+	RouteTrieNode* _Nodes;												// node 0 is the root
+	uint16_t _Size;
+
+public:
+	RouteTrie();
+	~RouteTrie();
+
+	virtual bool Add(const char* key, bool reverse, RouteMask routes);
+	virtual void Clear(int size);
+	virtual RouteMask Match(const char* text, bool reverse);
+};
+
+
+
+class RouteTable
+{
+protected:
+	RouteMask _Compiled;												// Routes matched by the lookups below
+	RouteMask _Generic;													// Routes whose filters must be evaluated
+	RouteMask _NoTextFilter;											// compiled Routes which pass any format 0 text
+	RouteMask _NoToFilter;												// compiled Routes which pass any 'To' path
+	RouteMask _NoTypeFilter;											// compiled Routes which pass any type
+	RouteTrie _TextPrefixes;											// format 0 'Text' filters ('starts with')
+	RouteTrie _ToSuffixes;												// 'To' filters ('ends with'), reversed
+	uint8_t _TypeCount;
+	RouteTypeEntry _Types[ARDJACK_MAX_INPUT_ROUTES];					// 'Type' filters ('equals')
+
+	static bool IsPass(MessageFilterItem* item);
+
+public:
+	RouteTable();
+
+	virtual bool Compile(Route* routes[], int count);
+	virtual bool IsGeneric(int index);
+	virtual RouteMask Lookup(IoTMessage* msg);
+};
+
+#endif
@@ -0,0 +1,266 @@
+/*
+	SimDevice.cpp
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#include "pch.h"
+
+#ifdef ARDUINO
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_SIM_DEVICE
+
+#include <math.h>
+
+#include "Configuration.h"
+#include "Dynamic.h"
+#include "Log.h"
+#include "Part.h"
+#include "SimDevice.h"
+#include "Utils.h"
+
+static const char* SimGeneratorNames[] = { "walk", "sine", "square", "step" };
+
+
+
+SimDevice::SimDevice(const char* name)
+	: Device(name)
+{
+	strcpy(DeviceClass, "Sim");
+
+	_AnalogGenerator = ARDJACK_SIM_GENERATOR_RANDOM_WALK;
+	_AnalogInputs = 1024;
+	_DigitalGenerator = ARDJACK_SIM_GENERATOR_RANDOM_WALK;
+	_DigitalInputs = 1024;
+	_DigitalOutputs = 64;
+	_PeriodMs = 1000;
+	_Random = 1;
+	_Step = 16;
+
+	CreateDefaultInventory();
+}
+
+
+SimDevice::~SimDevice()
+{
+}
+
+
+bool SimDevice::AddConfig()
+{
+	if (!Device::AddConfig())
+		return false;
+
+	if (Config->AddStringProp(PRM("AnalogGenerator"), PRM("Analog input values (walk | sine | square | step)."),
+		SimGeneratorNames[_AnalogGenerator]) == NULL) return false;
+	if (Config->AddIntegerProp(PRM("AnalogInputs"), PRM("No.of analog inputs."), _AnalogInputs) == NULL) return false;
+	if (Config->AddStringProp(PRM("DigitalGenerator"), PRM("Digital input values (walk | sine | square | step)."),
+		SimGeneratorNames[_DigitalGenerator]) == NULL) return false;
+	if (Config->AddIntegerProp(PRM("DigitalInputs"), PRM("No.of digital inputs."), _DigitalInputs) == NULL) return false;
+	if (Config->AddIntegerProp(PRM("DigitalOutputs"), PRM("No.of digital outputs."), _DigitalOutputs) == NULL) return false;
+	if (Config->AddIntegerProp(PRM("Period"), PRM("Sine, square and step period."), _PeriodMs, "ms") == NULL) return false;
+	if (Config->AddIntegerProp(PRM("Seed"), PRM("Random walk seed."), (int)_Random) == NULL) return false;
+	if (Config->AddIntegerProp(PRM("Step"), PRM("Random walk / step increment."), _Step) == NULL) return false;
+
+	return Config->SortItems();
+}
+
+
+bool SimDevice::ApplyConfig(bool quiet)
+{
+	if (Globals::Verbosity > 4)
+		Log::LogInfo(PRM("SimDevice::ApplyConfig: "), Name);
+
+	char analogGenerator[ARDJACK_MAX_CONFIG_VALUE_LENGTH];
+	char digitalGenerator[ARDJACK_MAX_CONFIG_VALUE_LENGTH];
+	int seed;
+
+	Config->GetAsString("AnalogGenerator", analogGenerator);
+	Config->GetAsInteger("AnalogInputs", &_AnalogInputs);
+	Config->GetAsString("DigitalGenerator", digitalGenerator);
+	Config->GetAsInteger("DigitalInputs", &_DigitalInputs);
+	Config->GetAsInteger("DigitalOutputs", &_DigitalOutputs);
+	Config->GetAsInteger("Period", &_PeriodMs);
+	Config->GetAsInteger("Seed", &seed);
+	Config->GetAsInteger("Step", &_Step);
+
+	_AnalogGenerator = LookupGenerator(analogGenerator);
+	_DigitalGenerator = LookupGenerator(digitalGenerator);
+
+	if ((_AnalogGenerator < 0) || (_DigitalGenerator < 0))
+	{
+		Log::LogErrorF(PRM("SimDevice '%s': Invalid generator '%s'"), Name,
+			(_AnalogGenerator < 0) ? analogGenerator : digitalGenerator);
+		return false;
+	}
+
+	if ((_AnalogInputs < 0) || (_DigitalInputs < 0) || (_DigitalOutputs < 0) ||
+		(_AnalogInputs + _DigitalInputs + _DigitalOutputs > ARDJACK_MAX_PARTS))
+	{
+		Log::LogErrorF(PRM("SimDevice '%s': Invalid Part counts (max.%d Parts)"), Name, ARDJACK_MAX_PARTS);
+		return false;
+	}
+
+	if ((_PeriodMs <= 0) || (_Step < 0))
+	{
+		Log::LogErrorF(PRM("SimDevice '%s': Invalid Period or Step"), Name);
+		return false;
+	}
+
+	// Restart the random walks, so that runs are repeatable.
+	_Random = (seed == 0) ? 1 : (uint32_t)seed;
+
+	// Recreate the inventory if the Part counts have changed.
+	if ((GetCount(ARDJACK_PART_TYPE_ANALOG_INPUT) != _AnalogInputs) ||
+		(GetCount(ARDJACK_PART_TYPE_DIGITAL_INPUT) != _DigitalInputs) ||
+		(GetCount(ARDJACK_PART_TYPE_DIGITAL_OUTPUT) != _DigitalOutputs))
+	{
+		if (!CreateDefaultInventory())
+			return false;
+	}
+
+	return Device::ApplyConfig(quiet);
+}
+
+
+bool SimDevice::CreateDefaultInventory()
+{
+	if (Globals::Verbosity > 3)
+	{
+		Log::LogInfoF(PRM("SimDevice::CreateDefaultInventory: '%s': %d analog inputs, %d digital inputs, %d digital outputs"),
+			Name, _AnalogInputs, _DigitalInputs, _DigitalOutputs);
+	}
+
+	PrepareForCreateInventory();
+
+	// Add Parts, reusing any existing ones (and their configuration).
+	bool result = AddParts("ai", _AnalogInputs, ARDJACK_PART_TYPE_ANALOG_INPUT, 0, 0, 0) &&
+		AddParts("di", _DigitalInputs, ARDJACK_PART_TYPE_DIGITAL_INPUT, 0, 0, 0) &&
+		AddParts("do", _DigitalOutputs, ARDJACK_PART_TYPE_DIGITAL_OUTPUT, 0, 0, 0);
+
+	RemoveOldParts();
+
+	for (int i = 0; i < PartCount; i++)
+	{
+		Part* part = Parts[i];
+
+		if (!part->Value.IsEmpty())
+			continue;
+
+		if (part->IsDigital())
+			part->Value.SetBool(false);
+		else
+			part->Value.SetInt(512);
+	}
+
+	return result;
+}
+
+
+int SimDevice::Generate(int generator, Part* part, int oldValue)
+{
+	// Returns the next value (0 - 1023) of input 'part'.
+	// Each Part's waveform is offset by a hash of its name, so that the Parts don't all change together.
+	long timeMs = Utils::NowMs() + (long)(Utils::HashText(part->Name) % _PeriodMs);
+	long phaseMs = timeMs % _PeriodMs;
+
+	switch (generator)
+	{
+	case ARDJACK_SIM_GENERATOR_SINE:
+		return 512 + (int)(511.0 * sin(2.0 * 3.14159265358979 * phaseMs / _PeriodMs));
+
+	case ARDJACK_SIM_GENERATOR_SQUARE:
+		return (phaseMs < _PeriodMs / 2) ? 1023 : 0;
+
+	case ARDJACK_SIM_GENERATOR_STEP:
+		// Rise by 'Step' each period, wrapping at 1024.
+		return (int)((timeMs / _PeriodMs * _Step) % 1024);
+
+	default:
+		{
+			// Move by up to 'Step' either way.
+			int value = oldValue + (int)(NextRandom() % (2 * _Step + 1)) - _Step;
+
+			return (value < 0) ? 0 : ((value > 1023) ? 1023 : value);
+		}
+	}
+}
+
+
+int SimDevice::LookupGenerator(const char* name)
+{
+	for (int i = 0; i < (int)(sizeof(SimGeneratorNames) / sizeof(SimGeneratorNames[0])); i++)
+	{
+		if (Utils::StringEquals(name, SimGeneratorNames[i]))
+			return i;
+	}
+
+	return -1;
+}
+
+
+uint32_t SimDevice::NextRandom()
+{
+	// Xorshift - cheap and repeatable.
+	_Random ^= _Random << 13;
+	_Random ^= _Random >> 17;
+	_Random ^= _Random << 5;
+
+	return _Random;
+}
+
+
+bool SimDevice::Read(Part* part, Dynamic* value)
+{
+	if (part->IsAnalogInput())
+		part->Value.SetInt(Generate(_AnalogGenerator, part, part->Value.AsInt()));
+	else if (part->IsDigitalInput())
+	{
+		if (_DigitalGenerator == ARDJACK_SIM_GENERATOR_RANDOM_WALK)
+		{
+			// Toggle with a probability of 'Step' in 1024.
+			if ((int)(NextRandom() % 1024) < _Step)
+				part->Value.SetBool(!part->Value.AsBool());
+		}
+		else
+			part->Value.SetBool(Generate(_DigitalGenerator, part, 0) >= 512);
+	}
+
+	ReadEvents++;
+
+	return value->Copy(&part->Value);
+}
+
+
+bool SimDevice::Write(Part* part, Dynamic* value)
+{
+	WriteEvents++;
+
+	return part->Value.Copy(value);
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+	SimDevice.h
+
+	By Jim Davies
+	Jacobus Systems, Brighton & Hove, UK
+	http://www.jacobus.co.uk
+
+	Provided under the MIT license: https://github.com/jacobussystems/ArdJack/blob/master/LICENSE
+	Copyright (c) 2019 James Davies, Jacobus Systems, Brighton & Hove, UK
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+	documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions
+	of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+	THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+	IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifdef ARDUINO
+	#include <arduino.h>
+#else
+	#include "stdafx.h"
+#endif
+
+#include "Device.h"
+#include "Globals.h"
+
+#ifdef ARDJACK_INCLUDE_SIM_DEVICE
+
+
+
+// A simulated Device, for load and scaling tests without hardware.
+// It has configurable numbers of analog inputs ('ai0' etc.), digital inputs ('di0' etc.) and digital outputs ('do0'
+// etc.). Input values follow a generator (random walk, sine, square or step wave), and output Parts hold the last
+// value written.
+
+class SimDevice : public Device
+{
+protected:
+	int _AnalogGenerator;												// ARDJACK_SIM_GENERATOR_...
+	int _AnalogInputs;
+	int _DigitalGenerator;												// ARDJACK_SIM_GENERATOR_...
+	int _DigitalInputs;
+	int _DigitalOutputs;
+	int _PeriodMs;														// sine, square and step period
+	uint32_t _Random;													// random walk state
+	int _Step;															// random walk / step increment
+
+	virtual bool ApplyConfig(bool quiet = false) override;
+	virtual int Generate(int generator, Part* part, int oldValue);
+	static int LookupGenerator(const char* name);
+	virtual uint32_t NextRandom();
+
+public:
+	SimDevice(const char* name);
+	~SimDevice();
+
+	virtual bool AddConfig() override;
+	virtual bool CreateDefaultInventory() override;
+	virtual bool Read(Part* part, Dynamic* value) override;
+	virtual bool Write(Part* part, Dynamic* value) override;
+};
+
+#endif
@@ -42,6 +42,8 @@ StringList::StringList(int size, bool autoExpand)
 
 	_Buffer = NULL;
 	_Length = 0;
+	_Offsets = NULL;
+	_OffsetsSize = 0;
 
 	AutoExpand = autoExpand;
 	Count = 0;
@@ -81,6 +83,10 @@ bool StringList::Add(const char* text)
 		}
 	}
 
+	if (!SetOffsets(Count + 1))
+		return false;
+
+	_Offsets[Count] = _Length;
 	strcpy(_Buffer + _Length, text);
 	_Length += Utils::StringLen(text) + 1;
 
@@ -118,7 +124,14 @@ void StringList::Clear(bool full)
 			_Buffer = NULL;
 		}
 
+		if (NULL != _Offsets)
+		{
+			Utils::MemFree(_Offsets);
+			_Offsets = NULL;
+		}
+
 		Size = 0;
+		_OffsetsSize = 0;
 	}
 
 	Count = 0;
@@ -135,10 +148,7 @@ const char* StringList::Get(int index, bool quiet)
 		return Globals::EmptyString;
 	}
 
-	char* ptr = _Buffer;
-
-	for (int i = 0; i < index; i++)
-		ptr += strlen(ptr) + 1;
+	char* ptr = _Buffer + _Offsets[index];
 
 	if (Globals::Verbosity > 9)
 		Log::LogInfoF(PRM("StringList::Get: %p, [%d] = '%s'"), this, index, ptr);
@@ -161,6 +171,14 @@ int StringList::IndexOf(const char* text, bool ignoreCase)
 }
 
 
+void StringList::MoveOffsets(int start, int increase)
+{
+	// Items 'start' onwards have moved by 'increase' bytes.
+	for (int i = start; i < Count; i++)
+		_Offsets[i] += increase;
+}
+
+
 void StringList::LogIt()
 {
 	Log::LogInfoF(PRM("StringList: %p, size %d, count %d, autoExpand %d"), this, Size, Count, AutoExpand);
@@ -225,28 +243,21 @@ bool StringList::Put(int index, const char* text)
 
 bool StringList::Put_ExistingBuffer(int index, const char* text, int itemIncrease)
 {
-	const char* ptr = Get(index);
+	char* ptr = _Buffer + _Offsets[index];
 
 	// Any items after 'index'?
-	if (index < Count - 1)
+	if ((index < Count - 1) && (itemIncrease != 0))
 	{
-		const char* ptrNext = Get(index + 1);
-		int nMove = _Length - (int)(ptrNext - _Buffer);
+		// Move the items after 'index' up or down, to fit the new item 'index'.
+		char* ptrNext = _Buffer + _Offsets[index + 1];
+		int nMove = _Length - _Offsets[index + 1];
 
-		if (itemIncrease > 0)
-		{
-			// Move up items after 'index' to make room for the new item 'index'.
-			memmove((void*)(ptrNext + itemIncrease), ptrNext, nMove);
-		}
-		else if (itemIncrease < 0)
-		{
-			// Move down items after 'index'.
-			memcpy((void*)(ptr + strlen(text) + 1), ptrNext, nMove);
-		}
+		memmove(ptrNext + itemIncrease, ptrNext, nMove);
+		MoveOffsets(index + 1, itemIncrease);
 	}
 
 	// Copy the new item 'index'.
-	strcpy((char*)ptr, text);
+	strcpy(ptr, text);
 
 	_Length += itemIncrease;
 
@@ -257,13 +268,12 @@ bool StringList::Put_ExistingBuffer(int index, const char* text, int itemIncreas
 bool StringList::Put_NewBuffer(int index, const char* text, int itemIncrease, char* newBuffer, int newSize)
 {
 	int newLength = 0;
-	const char* ptr = Get(index);
 
 	// Any items before 'index'?
 	if (index > 0)
 	{
 		// Copy items before 'index'.
-		int nCopy = (int)(ptr - _Buffer);
+		int nCopy = _Offsets[index];
 		memcpy(newBuffer, _Buffer, nCopy);
 		newLength += nCopy;
 	}
@@ -276,10 +286,11 @@ bool StringList::Put_NewBuffer(int index, const char* text, int itemIncrease, ch
 	if (index < Count - 1)
 	{
 		// Copy items after 'index'.
-		const char* ptrNext = Get(index + 1);
-		int nCopy = _Length - (int)(ptrNext - _Buffer);
-		memcpy(newBuffer + newLength, ptrNext, nCopy);
+		int nCopy = _Length - _Offsets[index + 1];
+		memcpy(newBuffer + newLength, _Buffer + _Offsets[index + 1], nCopy);
 		newLength += nCopy;
+
+		MoveOffsets(index + 1, itemIncrease);
 	}
 
 	Utils::MemFree(_Buffer);
@@ -299,16 +310,18 @@ bool StringList::Remove(int index)
 		return false;
 	}
 
-	char* ptr = (char*)Get(index);
+	char* ptr = _Buffer + _Offsets[index];
 	int oldItemLen = Utils::StringLen(ptr) + 1;
 
 	// Is it the last item?
 	if (index < Count - 1)
 	{
-		// No - move down the remaining item(s).
-		const char* ptr2 = Get(index + 1);
-		int nMove = (int)(_Length - (ptr2 - _Buffer));
-		memcpy(ptr, ptr2, nMove);
+		// No - move down the remaining item(s), and their offsets.
+		int nMove = _Length - _Offsets[index + 1];
+		memmove(ptr, ptr + oldItemLen, nMove);
+
+		for (int i = index; i < Count - 1; i++)
+			_Offsets[i] = _Offsets[i + 1] - oldItemLen;
 	}
 
 	_Length -= oldItemLen;
@@ -351,3 +364,32 @@ bool StringList::SetBuffer(int size)
 	return true;
 }
 
+
+bool StringList::SetOffsets(int count)
+{
+	// Make sure '_Offsets' can hold at least 'count' items.
+	if (count <= _OffsetsSize)
+		return true;
+
+	int useSize = Utils::MaxInt((int)(1.5 * count), 4);
+	int* newOffsets = (int*)Utils::MemMalloc(useSize * sizeof(int));
+
+	if (NULL == newOffsets)
+	{
+		Log::LogErrorF(PRM("StringList::SetOffsets: %p, Failed to resize from %d to %d items"), this, _OffsetsSize,
+			useSize);
+		return false;
+	}
+
+	if (NULL != _Offsets)
+	{
+		// Copy the existing offsets.
+		memcpy(newOffsets, _Offsets, Count * sizeof(int));
+		Utils::MemFree(_Offsets);
+	}
+
+	_Offsets = newOffsets;
+	_OffsetsSize = useSize;
+
+	return true;
+}
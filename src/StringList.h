@@ -43,13 +43,21 @@ class StringList
 protected:
 	char* _Buffer;
 	int _Length;																// total length of all items
+	int* _Offsets;																// offset of each item in '_Buffer'
+	int _OffsetsSize;															// allocated length of '_Offsets'
 
+	virtual void MoveOffsets(int start, int increase);
 	virtual bool Put_ExistingBuffer(int index, const char* text, int itemIncrease);
 	virtual bool Put_NewBuffer(int index, const char* text, int itemIncrease, char* newBuffer, int newSize);
+	virtual bool SetOffsets(int count);
 
 public:
 	bool AutoExpand;
+#ifdef ARDUINO
 	uint8_t Count;
+#else
+	int Count;
+#endif
 	int Size;																	// allocated length of '_Buffer'
 
 	StringList(int size = 20, bool autoExpand = true);
@@ -86,11 +86,15 @@ TcpConnection::~TcpConnection()
 
 bool TcpConnection::Activate()
 {
+	static ConfigHandle inPortHandle = { "InPort" };
+	static ConfigHandle outIpHandle = { "OutIp" };
+	static ConfigHandle outPortHandle = { "OutPort" };
+
 	if (!Connection::Activate()) return false;
 
-	Config->GetAsInteger("InPort", &_InputPort);
-	Config->GetAsString("OutIp", _OutputIp);
-	Config->GetAsInteger("OutPort", &_OutputPort);
+	Config->GetAsInteger(&inPortHandle, &_InputPort);
+	Config->GetAsString(&outIpHandle, _OutputIp);
+	Config->GetAsInteger(&outPortHandle, &_OutputPort);
 
 	if (_CanInput)
 	{
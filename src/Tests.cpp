@@ -26,6 +26,8 @@
 #include "pch.h"
 
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
+	#include "stdafx.h"
 #else
 	#include "stdafx.h"
 	#include "ClipboardConnection.h"
@@ -35,6 +35,10 @@
 		#include "WiFiLibrary.h"
 		#include <WiFiUdp.h>
 	#endif
+#elif defined(ARDJACK_LINUX)
+	#include "stdafx.h"
+
+	#include <fcntl.h>
 #else
 	#include "stdafx.h"
 
@@ -68,6 +72,12 @@ bool UdpConnection::AddConfig()
 	if (Config->AddIntegerProp(PRM("OutPort"), PRM("Output port number."), _OutputPort) == NULL) return false;
 	if (Config->AddBooleanProp(PRM("UseMulticast"), PRM("Use multicast?"), _UseMulticast) == NULL) return false;
 
+#ifdef ARDUINO
+#else
+	if (Config->AddIntegerProp(PRM("PackMTU"), PRM("Pack queued output into datagrams of up to this size (0 = off)."),
+		_PackMtu) == NULL) return false;
+#endif
+
 	return Config->SortItems();
 }
 
@@ -105,14 +115,20 @@ UdpConnection::~UdpConnection()
 
 bool UdpConnection::Activate()
 {
+	static ConfigHandle inIpHandle = { "InIp" };
+	static ConfigHandle inPortHandle = { "InPort" };
+	static ConfigHandle outIpHandle = { "OutIp" };
+	static ConfigHandle outPortHandle = { "OutPort" };
+	static ConfigHandle useMulticastHandle = { "UseMulticast" };
+
 	if (!Connection::Activate()) return false;
 
-	Config->GetAsString("InIp", _InputIp);
-	Config->GetAsInteger("InPort", &_InputPort);
+	Config->GetAsString(&inIpHandle, _InputIp);
+	Config->GetAsInteger(&inPortHandle, &_InputPort);
 
-	Config->GetAsString("OutIp", _OutputIp);
-	Config->GetAsInteger("OutPort", &_OutputPort);
-	Config->GetAsBoolean("UseMulticast", &_UseMulticast);
+	Config->GetAsString(&outIpHandle, _OutputIp);
+	Config->GetAsInteger(&outPortHandle, &_OutputPort);
+	Config->GetAsBoolean(&useMulticastHandle, &_UseMulticast);
 
 	if (NULL == _Udp)
 	{
@@ -248,6 +264,7 @@ bool UdpConnection::SendText(const char* text)
 	}
 
 	TxCount += strlen(text);
+	TxDatagrams++;
 	TxEvents++;
 
 	CheckAnnounce(true, text);
@@ -333,9 +350,41 @@ UdpConnection::UdpConnection(const char* name)
 	: Connection(name)
 {
 	_InputIp[0] = NULL;
+	_InputPort = 5001;
 	_Listener = NULL;
+	_MulticastIp[0] = NULL;
 	_OutputIp[0] = NULL;
+	_OutputPort = 5000;
+	_PackMtu = 0;
 	_Talker = NULL;
+	_TxCount = 0;
+	_TxMessages = 0;
+	_UseMulticast = false;
+
+#ifdef ARDJACK_LINUX
+	memset(_RxHeaders, 0, sizeof(_RxHeaders));
+	memset(_TxHeaders, 0, sizeof(_TxHeaders));
+
+	for (int i = 0; i < ARDJACK_MAX_UDP_RX_BATCH; i++)
+	{
+		_RxVectors[i].iov_base = _RxBuffers[i];
+		_RxVectors[i].iov_len = ARDJACK_MAX_UDP_DATAGRAM_LENGTH;
+
+		_RxHeaders[i].msg_hdr.msg_iov = &_RxVectors[i];
+		_RxHeaders[i].msg_hdr.msg_iovlen = 1;
+		_RxHeaders[i].msg_hdr.msg_name = &_RxAddresses[i];
+	}
+
+	for (int i = 0; i < ARDJACK_MAX_UDP_TX_BATCH; i++)
+	{
+		_TxVectors[i].iov_base = _TxBuffers[i];
+
+		_TxHeaders[i].msg_hdr.msg_iov = &_TxVectors[i];
+		_TxHeaders[i].msg_hdr.msg_iovlen = 1;
+		_TxHeaders[i].msg_hdr.msg_name = &_OutputAddress;
+		_TxHeaders[i].msg_hdr.msg_namelen = sizeof(_OutputAddress);
+	}
+#endif
 }
 
 
@@ -349,15 +398,27 @@ UdpConnection::~UdpConnection()
 
 bool UdpConnection::Activate()
 {
+	static ConfigHandle inIpHandle = { "InIP" };
+	static ConfigHandle inPortHandle = { "InPort" };
+	static ConfigHandle multicastIpHandle = { "MulticastIP" };
+	static ConfigHandle outIpHandle = { "OutIP" };
+	static ConfigHandle outPortHandle = { "OutPort" };
+	static ConfigHandle packMtuHandle = { "PackMTU" };
+	static ConfigHandle useMulticastHandle = { "UseMulticast" };
+
 	if (!Connection::Activate()) return false;
 
-	Config->GetAsString("InIP", _InputIp);
-	Config->GetAsInteger("InPort", &_InputPort);
+	Config->GetAsString(&inIpHandle, _InputIp);
+	Config->GetAsInteger(&inPortHandle, &_InputPort);
+
+	Config->GetAsString(&multicastIpHandle, _MulticastIp);
+	Config->GetAsString(&outIpHandle, _OutputIp);
+	Config->GetAsInteger(&outPortHandle, &_OutputPort);
+	Config->GetAsInteger(&packMtuHandle, &_PackMtu);
+	Config->GetAsBoolean(&useMulticastHandle, &_UseMulticast);
 
-	Config->GetAsString("MulticastIP", _MulticastIp);
-	Config->GetAsString("OutIP", _OutputIp);
-	Config->GetAsInteger("OutPort", &_OutputPort);
-	Config->GetAsBoolean("UseMulticast", &_UseMulticast);
+	if (_PackMtu > ARDJACK_MAX_UDP_DATAGRAM_LENGTH)
+		_PackMtu = ARDJACK_MAX_UDP_DATAGRAM_LENGTH;
 
 	char temp[120];
 
@@ -413,43 +474,246 @@ bool UdpConnection::Deactivate()
 }
 
 
+bool UdpConnection::FlushQueuedOutput()
+{
+	// Send the datagrams gathered by 'SendQueuedOutput'.
+	if (_TxCount == 0)
+		return true;
+
+	bool result = true;
+	int sent = 0;
+
+#ifdef ARDJACK_LINUX
+	// One system call for the whole batch.
+	for (int i = 0; i < _TxCount; i++)
+		_TxVectors[i].iov_len = _TxLengths[i];
+
+	while (sent < _TxCount)
+	{
+		int count = sendmmsg(_Talker, &_TxHeaders[sent], _TxCount - sent, 0);
+		if (count == SOCKET_ERROR)
+		{
+			Log::LogErrorF(PRM("%s: UDP FlushQueuedOutput failed, ERROR CODE: %d"), Name, WSAGetLastError());
+			result = false;
+			break;
+		}
+
+		sent += count;
+	}
+#else
+	for (; sent < _TxCount; sent++)
+	{
+		if (sendto(_Talker, _TxBuffers[sent], _TxLengths[sent], 0, (struct sockaddr *)&_OutputAddress,
+			sizeof(_OutputAddress)) == SOCKET_ERROR)
+		{
+			Log::LogErrorF(PRM("%s: UDP FlushQueuedOutput failed, ERROR CODE: %d"), Name, WSAGetLastError());
+			result = false;
+			break;
+		}
+	}
+#endif
+
+	if (Globals::Verbosity > 4)
+		Log::LogInfoF(PRM("%s: Sent %d messages in %d of %d datagrams"), Name, _TxMessages, sent, _TxCount);
+
+	TxDatagrams += sent;
+	TxFlushes++;
+
+	_TxCount = 0;
+	_TxMessages = 0;
+
+	return result;
+}
+
+
+#ifdef ARDJACK_LINUX
+
+int UdpConnection::InputHandle()
+{
+	// The listener socket, for the host's event loop to wait on.
+	if (!_Active || !_CanInput || (_Listener == INVALID_SOCKET))
+		return -1;
+
+	return _Listener;
+}
+
+#endif
+
+
+MessagePathTable* UdpConnection::OutputPaths(uint32_t* peer)
+{
+	// The peers are told apart by their IP addresses.
+	// Multicast or broadcast output has no single peer to acknowledge paths, so they're always sent in full.
+	*peer = _OutputAddress.sin_addr.s_addr;
+
+	if (_UseMulticast || (*peer == INADDR_BROADCAST))
+		return NULL;
+
+	return &_MessagePaths;
+}
+
+
 bool UdpConnection::PollInputs(int maxCount)
 {
+	// Receive up to 'maxCount' waiting datagrams (the listener socket is non-blocking).
 	if (!_Active || !_CanInput)
 		return false;
 
-	char line[200];
-	int addrlen = sizeof(_InputAddress);
+#ifdef ARDJACK_LINUX
+	// Fetch the whole batch with a single system call.
+	if (maxCount > ARDJACK_MAX_UDP_RX_BATCH)
+		maxCount = ARDJACK_MAX_UDP_RX_BATCH;
 
-	int msglen = recvfrom(_Listener, line, sizeof(line), 0, (struct sockaddr *)&_InputAddress, &addrlen);
-	if (msglen == SOCKET_ERROR)
+	for (int i = 0; i < maxCount; i++)
+		_RxHeaders[i].msg_hdr.msg_namelen = sizeof(_RxAddresses[i]);
+
+	int count = recvmmsg(_Listener, _RxHeaders, maxCount, MSG_DONTWAIT, NULL);
+	if (count == SOCKET_ERROR)
 	{
-		// No UDP message has been received (or some other error...).
+		// No UDP message is waiting, or some other error.
 		int err = WSAGetLastError();
 
-		if (err != 10060)
+		if ((err != EAGAIN) && (err != EWOULDBLOCK))
 			Log::LogInfoF(PRM("UDP message not received, ERROR CODE: %d"), err);
 
 		return false;
 	}
 
-	// A UDP message has been received.
-	line[msglen] = NULL;
+	for (int i = 0; i < count; i++)
+	{
+		// A datagram too big for the buffer is truncated - drop it, rather than process part of it.
+		if ((_RxHeaders[i].msg_hdr.msg_flags & MSG_TRUNC) != 0)
+		{
+			Log::LogWarningF(PRM("%s: UDP message longer than %d bytes dropped"), Name, ARDJACK_MAX_UDP_DATAGRAM_LENGTH);
+			continue;
+		}
+
+		ProcessDatagram(_RxBuffers[i], _RxHeaders[i].msg_len, &_RxAddresses[i]);
+	}
+#else
+	char line[ARDJACK_MAX_UDP_DATAGRAM_LENGTH + 1];
+	struct sockaddr_in from;
+	int count = 0;
+
+	while (count < maxCount)
+	{
+		int addrlen = sizeof(from);
+
+		int msglen = recvfrom(_Listener, line, sizeof(line) - 1, 0, (struct sockaddr *)&from, &addrlen);
+		if (msglen == SOCKET_ERROR)
+		{
+			// No UDP message is waiting, or some other error.
+			int err = WSAGetLastError();
+
+			if (err == WSAEMSGSIZE)
+			{
+				// The datagram was too big for the buffer, and has been truncated - drop it, but keep receiving.
+				Log::LogWarningF(PRM("%s: UDP message longer than %d bytes dropped"), Name, ARDJACK_MAX_UDP_DATAGRAM_LENGTH);
+				count++;
+				continue;
+			}
+
+			if (err != WSAEWOULDBLOCK)
+				Log::LogInfoF(PRM("UDP message not received, ERROR CODE: %d"), err);
+
+			break;
+		}
+
+		ProcessDatagram(line, msglen, &from);
+		count++;
+	}
+#endif
+
+	UpdateRxBatchStats(count);
 
-	RxCount += Utils::StringLen(line);
+	return (count > 0);
+}
+
+
+bool UdpConnection::ProcessDatagram(char* buffer, int length, struct sockaddr_in* from)
+{
+	// A UDP message has been received into 'buffer'.
+	buffer[length] = NULL;
+
+	RxCount += length;
 	RxEvents++;
 
-	CheckAnnounce(false, line);
+	CheckAnnounce(false, buffer);
 
 	if (Globals::Verbosity > 2)
 	{
 		char ip[32];
-		strcpy(ip, inet_ntoa(_InputAddress.sin_addr));
+		strcpy(ip, inet_ntoa(from->sin_addr));
+
+		Log::LogInfoF(PRM("%s: RX from %s port %d: '%s'"), Name, ip, from->sin_port, buffer);
+	}
+
+	// The datagram may hold several newline-separated messages (see 'PackMTU').
+	bool result = true;
+	char* line = buffer;
+
+	while (NULL != line)
+	{
+		char* next = strchr(line, '\n');
+
+		if (NULL != next)
+			*next++ = NULL;
+
+		if ((*line != NULL) && !ProcessInput(line, from->sin_addr.s_addr))
+			result = false;
+
+		line = next;
+	}
+
+	return result;
+}
+
+
+bool UdpConnection::SendQueuedOutput(const char* text)
+{
+	// Gather 'text' into the pending batch, which 'FlushQueuedOutput' sends.
+	if (!_Active || !_CanOutput)
+		return false;
+
+	int len = Utils::StringLen(text);
 
-		Log::LogInfoF(PRM("%s: RX from %s port %d: '%s'"), Name, ip, _InputAddress.sin_port, line);
+	if (len >= ARDJACK_MAX_UDP_DATAGRAM_LENGTH)
+	{
+		// Too long to gather - send it on its own, after whatever has already been gathered.
+		FlushQueuedOutput();
+
+		return SendText(text);
 	}
 
-	ProcessInput(line);
+	if ((_PackMtu > 0) && (_TxCount > 0) && (_TxLengths[_TxCount - 1] + 1 + len <= _PackMtu))
+	{
+		// Append 'text' to the latest datagram.
+		char* buffer = _TxBuffers[_TxCount - 1];
+		int* length = &_TxLengths[_TxCount - 1];
+
+		buffer[(*length)++] = '\n';
+		memcpy(buffer + *length, text, len);
+		*length += len;
+	}
+	else
+	{
+		// Start a new datagram.
+		if (_TxCount >= ARDJACK_MAX_UDP_TX_BATCH)
+			FlushQueuedOutput();
+
+		memcpy(_TxBuffers[_TxCount], text, len);
+		_TxLengths[_TxCount++] = len;
+	}
+
+	_TxMessages++;
+
+	TxCount += len;
+	TxEvents++;
+
+	CheckAnnounce(true, text);
+
+	if (Globals::Verbosity > 2)
+		Log::LogInfo(Name, PRM(": TX '"), text, "'");
 
 	return true;
 }
@@ -474,6 +738,7 @@ bool UdpConnection::SendText(const char* text)
 	}
 
 	TxCount += Utils::StringLen(text);
+	TxDatagrams++;
 	TxEvents++;
 
 	CheckAnnounce(true, text);
@@ -539,12 +804,22 @@ bool UdpConnection::StartListening()
 	//read_timeout.tv_usec = 10;
 	//int status = setsockopt(_Listener, SOL_SOCKET, SO_RCVTIMEO, (char *)&read_timeout, sizeof read_timeout);
 
-	DWORD recv_timeout = 10;		// 10 ms
-	int status = setsockopt(_Listener, SOL_SOCKET, SO_RCVTIMEO, (char *)&recv_timeout, sizeof recv_timeout);
+#ifdef ARDJACK_LINUX
+	// Non-blocking: the host's event loop waits for the socket to become readable, then 'PollInputs' drains it.
+	int status = fcntl(_Listener, F_SETFL, fcntl(_Listener, F_GETFL, 0) | O_NONBLOCK);
 
 	if (status != 0)
 	{
-		sprintf(temp, PRM("setsockopt(SO_RCVTIMEO) - ERROR CODE: %d"), WSAGetLastError());
+		sprintf(temp, PRM("fcntl(O_NONBLOCK) - ERROR CODE: %d"), WSAGetLastError());
+#else
+	// Non-blocking: 'PollInputs' takes whatever is waiting, without a receive timeout.
+	u_long nonBlocking = 1;
+	int status = ioctlsocket(_Listener, FIONBIO, &nonBlocking);
+
+	if (status != 0)
+	{
+		sprintf(temp, PRM("ioctlsocket(FIONBIO) - ERROR CODE: %d"), WSAGetLastError());
+#endif
 		Log::LogError(temp);
 		closesocket(_Listener);
 		Utils::TerminateWinsock();
@@ -650,6 +925,10 @@ bool UdpConnection::StopListening()
 
 bool UdpConnection::StopTalking()
 {
+	// Discard any gathered output.
+	_TxCount = 0;
+	_TxMessages = 0;
+
 	if (NULL != _Talker)
 	{
 		closesocket(_Talker);
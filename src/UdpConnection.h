@@ -39,6 +39,8 @@
 		#include "WiFiLibrary.h"
 		#include <WiFiUdp.h>
 	#endif
+#elif defined(ARDJACK_LINUX)
+	#include "stdafx.h"
 #else
 	#include "stdafx.h"
 	#include <winsock.h>
@@ -75,7 +77,26 @@ protected:
 	struct sockaddr_in _InputAddress;
 	SOCKET _Listener;
 	struct sockaddr_in _OutputAddress;
+	int _PackMtu;												// pack queued output into datagrams of up to this size (0 = off)
 	SOCKET _Talker;
+
+	// Queued output gathered by 'SendQueuedOutput', sent by 'FlushQueuedOutput'.
+	char _TxBuffers[ARDJACK_MAX_UDP_TX_BATCH][ARDJACK_MAX_UDP_DATAGRAM_LENGTH];
+	int _TxCount;												// no.of datagrams in use
+	int _TxLengths[ARDJACK_MAX_UDP_TX_BATCH];
+	int _TxMessages;											// no.of messages in those datagrams
+
+	virtual bool ProcessDatagram(char* buffer, int length, struct sockaddr_in* from);
+#endif
+
+#ifdef ARDJACK_LINUX
+	// Pre-allocated receive buffers, filled by a single 'recvmmsg' call - room for a packed datagram (see 'PackMTU').
+	struct sockaddr_in _RxAddresses[ARDJACK_MAX_UDP_RX_BATCH];
+	char _RxBuffers[ARDJACK_MAX_UDP_RX_BATCH][ARDJACK_MAX_UDP_DATAGRAM_LENGTH + 1];
+	struct mmsghdr _RxHeaders[ARDJACK_MAX_UDP_RX_BATCH];
+	struct iovec _RxVectors[ARDJACK_MAX_UDP_RX_BATCH];
+	struct mmsghdr _TxHeaders[ARDJACK_MAX_UDP_TX_BATCH];
+	struct iovec _TxVectors[ARDJACK_MAX_UDP_TX_BATCH];
 #endif
 
 	char _InputIp[20];
@@ -102,12 +123,29 @@ public:
 
 	virtual bool AddConfig() override;
 
+#ifdef ARDUINO
+#else
+	virtual bool FlushQueuedOutput() override;
+#endif
+
+#ifdef ARDJACK_LINUX
+	virtual int InputHandle() override;
+#endif
+
 #ifdef ARDUINO
 	virtual bool OutputMessage(IoTMessage* msg) override;
 	virtual bool OutputText(const char* text) override;
+#else
+	virtual MessagePathTable* OutputPaths(uint32_t* peer) override;
 #endif
 
 	virtual bool PollInputs(int maxCount = 5) override;
+
+#ifdef ARDUINO
+#else
+	virtual bool SendQueuedOutput(const char* text) override;
+#endif
+
 	virtual bool SendText(const char* text) override;
 	virtual bool SendTextQuiet(const char* text) override;
 };
@@ -30,6 +30,11 @@
 #ifdef ARDUINO
 	extern uint32_t __get_MSP(void);
 	#include "MemoryFreeExt.h"
+#elif defined(ARDJACK_LINUX)
+	#include "stdafx.h"
+
+	#include <math.h>
+	#include <sys/stat.h>
 #else
 	#include "stdafx.h"
 
@@ -56,6 +61,8 @@
 	#else
 		#include "ArduinoClock.h"
 	#endif
+#elif defined(ARDJACK_LINUX)
+	#include "LinuxClock.h"
 #else
 	#include "WinClock.h"
 #endif
@@ -310,6 +317,36 @@ char Utils::Buffer_Int2String[];
 
 
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
+	bool Utils::CreateFolder(const char* folder)
+	{
+		// Create 'folder' and any missing parents.
+		char path[MAX_PATH];
+		strcpy(path, folder);
+
+		for (char* ptr = path + 1; *ptr; ptr++)
+		{
+			if (*ptr == '/')
+			{
+				*ptr = NULL;
+				mkdir(path, 0755);
+				*ptr = '/';
+			}
+		}
+
+		if ((mkdir(path, 0755) != 0) && (errno != EEXIST))
+		{
+			char temp[202];
+			sprintf(temp, PRM("Failed to create folder: %s - code %d"), folder, errno);
+			Log::LogError(temp);
+			return false;
+		}
+
+		if (Globals::Verbosity > 3)
+			Log::LogInfo(PRM("Folder exists: "), folder);
+
+		return true;
+	}
 #else
 	bool Utils::CreateFolder(const char* folder)
 	{
@@ -454,6 +491,7 @@ char Utils::Buffer_Int2String[];
 		if (Globals::EnableSound)
 		{
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
 #else
 			Beep(freq_hz, dur_ms);
 #endif
@@ -531,6 +569,13 @@ char Utils::Buffer_Int2String[];
 
 
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
+	bool Utils::FolderExists(const char* folder)
+	{
+		struct stat info;
+
+		return (stat(folder, &info) == 0) && S_ISDIR(info.st_mode);
+	}
 #else
 	bool Utils::FolderExists(const char* folder)
 	{
@@ -633,7 +678,11 @@ char Utils::Buffer_Int2String[];
 		Utils::GetUserDocsFolder(folder, MAX_PATH);
 		if (NULL == folder) return NULL;
 
+#ifdef ARDJACK_LINUX
+		strcat(folder, "/Jacobus Systems/");
+#else
 		strcat(folder, "\\Jacobus Systems\\");
+#endif
 		strcat(folder, Globals::AppName);
 
 		if (Globals::Verbosity > 3)
@@ -942,6 +991,28 @@ char* Utils::GetTimeString(char* result, const char* format, bool utc)
 
 
 #ifdef ARDUINO
+#elif defined(ARDJACK_LINUX)
+	char* Utils::GetUserDocsFolder(char* folder, int size)
+	{
+		folder[0] = NULL;
+
+		const char* home = getenv("HOME");
+		if (Utils::StringIsNullOrEmpty(home))
+		{
+			Log::LogError(PRM("Failed to get User's home folder"));
+			return NULL;
+		}
+
+		snprintf(folder, size, "%s/Documents", home);
+
+		if (Globals::Verbosity > 3)
+			Log::LogInfo(PRM("User Documents folder: "), folder);
+
+		if (!CreateFolder(folder))
+			return NULL;
+
+		return folder;
+	}
 #else
 	char* Utils::GetUserDocsFolder(char* folder, int size)
 	{
@@ -965,6 +1036,36 @@ char* Utils::GetTimeString(char* result, const char* format, bool utc)
 #endif
 
 
+uint32_t Utils::HashText(const char* text)
+{
+	// Case-insensitive 32-bit FNV-1a.
+	uint32_t hash = 2166136261u;
+
+	while (*text != NULL)
+	{
+		hash ^= (uint8_t)tolower(*text++);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
+uint32_t Utils::HashText(const char* text, int length)
+{
+	// Case-insensitive 32-bit FNV-1a of 'length' chars of 'text' (not necessarily NULL-terminated).
+	uint32_t hash = 2166136261u;
+
+	for (int i = 0; i < length; i++)
+	{
+		hash ^= (uint8_t)tolower(text[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
 unsigned long Utils::HostID_To_Address(const char* s)
 {
 #ifdef ARDUINO
@@ -988,6 +1089,14 @@ unsigned long Utils::HostID_To_Address(const char* s)
 
 #ifdef ARDUINO
 
+#elif defined(ARDJACK_LINUX)
+	bool Utils::InitializeWinsock()
+	{
+		// BSD sockets need no initialization.
+		Globals::WinsockStarted = true;
+
+		return true;
+	}
 #else
 	bool Utils::InitializeWinsock()
 	{
@@ -1201,6 +1310,12 @@ const char* Utils::Int2String(long value, int radix)
 	}
 
 
+	unsigned long Utils::NowUs()
+	{
+		return Globals::Clock->NowUs();
+	}
+
+
 #ifdef ARDUINO
 #else
 
@@ -1676,6 +1791,24 @@ const char* Utils::Int2String(long value, int radix)
 	}
 
 
+	bool Utils::StringEqualsN(const char* value1, const char* value2, int length, bool ignoreCase)
+	{
+		// Does 'value1' ('length' chars, not necessarily NULL-terminated) equal 'value2'?
+		if ((NULL == value1) || (NULL == value2)) return false;
+
+		for (int i = 0; i < length; i++)
+		{
+			if (value2[i] == NULL)
+				return false;
+
+			if (ignoreCase ? (tolower(value1[i]) != tolower(value2[i])) : (value1[i] != value2[i]))
+				return false;
+		}
+
+		return (value2[length] == NULL);
+	}
+
+
 	bool Utils::StringIsNullOrEmpty(const char* text)
 	{
 		return (NULL == text) || (strlen(text) == 0);
@@ -1810,7 +1943,10 @@ const char* Utils::Int2String(long value, int radix)
 			if (Globals::Verbosity > 4)
 				Log::LogInfo("Utils::TerminateWinsock");
 
+#ifdef ARDJACK_LINUX
+#else
 			WSACleanup();
+#endif
 			Globals::WinsockStarted = false;
 		}
 
@@ -1861,8 +1997,8 @@ const char* Utils::Int2String(long value, int radix)
 
 		if (ptr > first)
 		{
-			// Remove the leading white space.
-			strcpy(text, ptr);
+			// Remove the leading white space (the buffers overlap, so use 'memmove').
+			memmove(text, ptr, strlen(ptr) + 1);
 		}
 
 		// Remove any trailing white space.
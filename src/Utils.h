@@ -101,6 +101,14 @@ public:
 	static bool GetFirstField(char* pSrc, char separator, char* result, int maxSize, bool trim = true);
 	static char* GetNow(char* datetime, const char* format = NULL, bool utc = false);
 	static char* GetTimeString(char* time, const char* format = NULL, bool utc = false);
+	static constexpr uint32_t HashLiteral(const char* text, uint32_t hash = 2166136261u)
+	{
+		// 'HashText' at compile time, e.g. for case labels.
+		return (*text == NULL) ? hash :
+			HashLiteral(text + 1, (hash ^ (uint8_t)(((*text >= 'A') && (*text <= 'Z')) ? *text + 32 : *text)) * 16777619u);
+	}
+	static uint32_t HashText(const char* text);
+	static uint32_t HashText(const char* text, int length);
 	static unsigned long HostID_To_Address(const char* s);
 	static const char* Int2String(long value, int radix = 10);
 	//static bool IsLeapYear(int year);
@@ -116,6 +124,7 @@ public:
 	static int Nint(double value);
 	static bool Now(DateTime* now, bool utc = false);
 	static long NowMs();
+	static unsigned long NowUs();
 	static char* RepeatChar(char *text, char ch, int count);
 	static DateTime* SecondsToTime(long seconds, DateTime* dt);
 	static bool SetDate(const char* text);
@@ -135,6 +144,7 @@ public:
 	static bool StringContains(const char* value1, const char* value2, bool ignoreCase = true);
 	static bool StringEndsWith(const char* value1, const char* value2, bool ignoreCase = true);
 	static bool StringEquals(const char* value1, const char* value2, bool ignoreCase = true);
+	static bool StringEqualsN(const char* value1, const char* value2, int length, bool ignoreCase = true);
 	static bool StringIsNullOrEmpty(const char* text);
 	static int StringLen(const char* text);
 	static char* StringReplace(const char* source, const char* str1, const char* str2,
@@ -1,6 +1,6 @@
 #include "pch.h"
 
-#ifdef ARDUINO
+#if defined(ARDUINO) || defined(ARDJACK_LINUX)
 
 /*!\file cppQueue.cpp
 ** \author SMFSW
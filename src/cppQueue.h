@@ -1,6 +1,6 @@
 #pragma once
 
-#ifdef ARDUINO
+#if defined(ARDUINO) || defined(ARDJACK_LINUX)
 
 /*!\file cppQueue.h
 ** \author SMFSW
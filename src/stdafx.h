@@ -7,6 +7,78 @@
 
 #ifdef ARDUINO
 
+#elif defined(__linux__)
+	// Linux host build (see 'ArdJackL').
+	#define ARDJACK_LINUX
+
+	#include <arpa/inet.h>
+	#include <ctype.h>
+	#include <errno.h>
+	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <stdarg.h>
+	#include <stdint.h>
+	#include <stdio.h>
+	#include <stdlib.h>
+	#include <string.h>
+	#include <strings.h>
+	#include <sys/socket.h>
+	#include <sys/time.h>
+	#include <sys/types.h>
+	#include <unistd.h>
+
+	#ifndef MAX_PATH
+	#define MAX_PATH 260
+	#endif
+
+	// Winsock equivalents.
+	typedef int SOCKET;
+
+	#define closesocket close
+	#define INVALID_SOCKET (-1)
+	#define SOCKET_ERROR (-1)
+	#define WSAGetLastError() (errno)
+
+	// MSVC CRT functions used by the shared code.
+	#define stricmp strcasecmp
+	#define _stricmp strcasecmp
+
+	inline char* ltoa(long value, char* buffer, int radix)
+	{
+		// Only base 10 and 16 are used by the shared code.
+		sprintf(buffer, (radix == 16) ? "%lx" : "%ld", value);
+		return buffer;
+	}
+
+	inline char* itoa(int value, char* buffer, int radix)
+	{
+		return ltoa(value, buffer, radix);
+	}
+
+	inline char* _strlwr(char* text)
+	{
+		for (char* ptr = text; *ptr; ptr++)
+			*ptr = (char)tolower((unsigned char)*ptr);
+
+		return text;
+	}
+
+	inline char* _strupr(char* text)
+	{
+		for (char* ptr = text; *ptr; ptr++)
+			*ptr = (char)toupper((unsigned char)*ptr);
+
+		return text;
+	}
+
+	#define strlwr _strlwr
+	#define strupr _strupr
+
+	inline void Sleep(unsigned int delay_ms)
+	{
+		usleep(delay_ms * 1000);
+	}
+
 #else
 	#ifndef STRICT
 	#define STRICT